@@ -87,6 +87,12 @@
 /* Define to 1 if you have the `fchmod' function. */
 #define HAVE_FCHMOD 1
 
+/* Define to 1 if you have the `fdatasync' function. */
+#define HAVE_FDATASYNC 1
+
+/* Define to 1 if you have the `fdopendir' function. */
+#define HAVE_FDOPENDIR 1
+
 /* Define to 1 if you have the <fcntl.h> header file. */
 #define HAVE_FCNTL_H 1
 
@@ -96,6 +102,12 @@
 /* Define to 1 if fseeko (and presumably ftello) exists and is declared. */
 #define HAVE_FSEEKO 1
 
+/* Define to 1 if you have the `fstatat' function. */
+#define HAVE_FSTATAT 1
+
+/* Define to 1 if you have the `fsync' function. */
+#define HAVE_FSYNC 1
+
 /* Define to 1 if you have the `ftime' function. */
 #define HAVE_FTIME 1
 
@@ -220,6 +232,9 @@
 /* Define to 1 if you have the `newloacle' function. */
 /* #undef HAVE_NEWLOACLE */
 
+/* Define to 1 if you have the `openat' function. */
+#define HAVE_OPENAT 1
+
 /* Define to 1 if you have the `pclose' function. */
 #define HAVE_PCLOSE 1
 
@@ -498,6 +513,9 @@
 /* Define to the sub-directory where libtool stores uninstalled libraries. */
 #define LT_OBJDIR ".libs/"
 
+/* Define if you have LZ4 library */
+/* #undef LZ4_DELEGATE */
+
 /* Define if you have LZMA library */
 #define LZMA_DELEGATE 1
 
@@ -648,6 +666,9 @@
 /* Define if you have ZLIB library */
 #define ZLIB_DELEGATE 1
 
+/* Define if you have ZSTD library */
+/* #undef ZSTD_DELEGATE */
+
 /* Enable large inode numbers on Mac OS X 10.5.  */
 #ifndef _DARWIN_USE_64_BIT_INODE
 # define _DARWIN_USE_64_BIT_INODE 1
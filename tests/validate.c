@@ -41,6 +41,7 @@
   Include declarations.
 */
 #include <stdio.h>
+#include <stdlib.h>
 #include <string.h>
 #include "wizard/WizardsToolkit.h"
 #include "validate.h"
@@ -220,6 +221,51 @@ static WizardBooleanType TestAES(void)
   results=DestroyStringInfo(results);
   plaintext=DestroyStringInfo(plaintext);
   cipher_info=DestroyCipherInfo(cipher_info);
+  /*
+    Validate chunk nonces:  identical chunks encipher differently and each
+    deciphers independently.
+  */
+  (void) PrintValidateString(stdout,
+    "testing AES chunk nonce encipher/decipher:\n");
+  for (i=0; i < 2; i++)
+  {
+    const StringInfo
+      *nonce;
+
+    StringInfo
+      *chunk;
+
+    (void) PrintValidateString(stdout,"  test %.20g ",(double) i);
+    cipher_info=AcquireCipherInfo(AESCipher,i == 0 ? CTRMode : CBCMode);
+    key=StringToStringInfo(CipherKey);
+    SetCipherKey(cipher_info,key);
+    key=DestroyStringInfo(key);
+    nonce=CloneStringInfo(GetCipherNonce(cipher_info));
+    plaintext=StringToStringInfo(CipherPlaintext);
+    SetCipherChunkNonce(cipher_info,nonce,0,GetStringInfoLength(plaintext));
+    ciphertext=EncipherCipher(cipher_info,plaintext);
+    chunk=StringToStringInfo(CipherPlaintext);
+    SetCipherChunkNonce(cipher_info,nonce,1,GetStringInfoLength(chunk));
+    (void) EncipherCipher(cipher_info,chunk);
+    clone=CompareStringInfo(ciphertext,chunk) != 0 ? WizardTrue : WizardFalse;
+    SetCipherChunkNonce(cipher_info,nonce,1,GetStringInfoLength(chunk));
+    (void) DecipherCipher(cipher_info,chunk);
+    SetCipherChunkNonce(cipher_info,nonce,0,GetStringInfoLength(ciphertext));
+    (void) DecipherCipher(cipher_info,ciphertext);
+    results=StringToStringInfo(CipherPlaintext);
+    if ((CompareStringInfo(chunk,results) != 0) ||
+        (CompareStringInfo(ciphertext,results) != 0))
+      clone=WizardFalse;
+    (void) PrintValidateString(stdout,"%s.\n",clone != WizardFalse ? "pass" :
+      "fail");
+    if (clone == WizardFalse)
+      pass=WizardFalse;
+    results=DestroyStringInfo(results);
+    chunk=DestroyStringInfo(chunk);
+    plaintext=DestroyStringInfo(plaintext);
+    nonce=DestroyStringInfo((StringInfo *) nonce);
+    cipher_info=DestroyCipherInfo(cipher_info);
+  }
   return(pass);
 }
 
@@ -467,6 +513,69 @@ static WizardBooleanType TestChacha(void)
   return(pass);
 }
 
+static WizardBooleanType TestConcurrentHashmap(void)
+{
+  HashmapInfo
+    *hashmap_info;
+
+  register ssize_t
+    i;
+
+  size_t
+    failures;
+
+  WizardBooleanType
+    pass;
+
+  (void) PrintValidateString(stdout,"testing concurrent hashmap:\n");
+  hashmap_info=NewConcurrentHashmap(SmallHashmapSize,0,HashStringType,
+    CompareHashmapString,RelinquishWizardMemory,(void *(*)(void *)) NULL);
+  (void) PrintValidateString(stdout,"  test 0 ");
+  failures=0;
+#if defined(WIZARDSTOOLKIT_HAVE_OPENMP)
+  #pragma omp parallel for schedule(static,1) num_threads(8) \
+    reduction(+:failures)
+#endif
+  for (i=0; i < 8; i++)
+  {
+    char
+      key[WizardPathExtent];
+
+    register ssize_t
+      j;
+
+    for (j=0; j < 4096; j++)
+    {
+      (void) FormatLocaleString(key,WizardPathExtent,"key-%.20g-%.20g",
+        (double) i,(double) j);
+      if (PutEntryInHashmap(hashmap_info,ConstantString(key),(void *)
+          (j+1)) == WizardFalse)
+        failures++;
+    }
+    for (j=0; j < 4096; j++)
+    {
+      (void) FormatLocaleString(key,WizardPathExtent,"key-%.20g-%.20g",
+        (double) i,(double) j);
+      if (GetValueFromHashmap(hashmap_info,key) != (void *) (j+1))
+        failures++;
+    }
+    for (j=0; j < 4096; j+=2)
+    {
+      (void) FormatLocaleString(key,WizardPathExtent,"key-%.20g-%.20g",
+        (double) i,(double) j);
+      (void) RemoveEntryFromHashmap(hashmap_info,key);
+      if (GetValueFromHashmap(hashmap_info,key) != (void *) NULL)
+        failures++;
+    }
+  }
+  pass=(failures == 0) && (GetNumberOfEntriesInHashmap(hashmap_info) ==
+    (8*4096/2)) ? WizardTrue : WizardFalse;
+  (void) PrintValidateString(stdout,"%s.\n",pass != WizardFalse ? "pass" :
+    "fail");
+  hashmap_info=DestroyHashmap(hashmap_info);
+  return(pass);
+}
+
 static WizardBooleanType TestCRC64(void)
 {
   HashInfo
@@ -544,6 +653,329 @@ static WizardBooleanType TestCRC64(void)
   return(pass);
 }
 
+static WizardBooleanType TestEntropyIncreasable(void)
+{
+  EntropyInfo
+    *entropy_info;
+
+  RandomInfo
+    *random_info;
+
+  register ssize_t
+    i;
+
+  StringInfo
+    *noise,
+    *text;
+
+  WizardBooleanType
+    pass,
+    status;
+
+  (void) PrintValidateString(stdout,"testing entropy increasable:\n");
+  pass=WizardTrue;
+  random_info=AcquireRandomInfo(SHA2256Hash);
+  noise=GetRandomKey(random_info,262144);
+  text=AcquireStringInfo(262144);
+  for (i=0; i < 262144; i++)
+    GetStringInfoDatum(text)[i]=(unsigned char) zip_test_vector[6].plaintext[
+      i % strlen((char *) zip_test_vector[6].plaintext)];
+  entropy_info=AcquireEntropyInfo(ZIPEntropy,6);
+  (void) PrintValidateString(stdout,"  test 0 ");
+  status=IsEntropyIncreasable(entropy_info,text);
+  (void) PrintValidateString(stdout,"%s.\n",status != WizardFalse ? "pass" :
+    "fail");
+  if (status == WizardFalse)
+    pass=WizardFalse;
+  (void) PrintValidateString(stdout,"  test 1 ");
+  status=WizardFalse;
+  for (i=0; i < 4; i++)
+    if (IsEntropyIncreasable(entropy_info,noise) != WizardFalse)
+      status=WizardTrue;
+  (void) PrintValidateString(stdout,"%s.\n",status == WizardFalse ? "pass" :
+    "fail");
+  if (status != WizardFalse)
+    pass=WizardFalse;
+  /*
+    Back off after consecutive incompressible messages.
+  */
+  (void) PrintValidateString(stdout,"  test 2 ");
+  status=IsEntropyIncreasable(entropy_info,text) == WizardFalse &&
+    IsEntropyIncreasable(entropy_info,text) != WizardFalse ? WizardTrue :
+    WizardFalse;
+  (void) PrintValidateString(stdout,"%s.\n",status != WizardFalse ? "pass" :
+    "fail");
+  if (status == WizardFalse)
+    pass=WizardFalse;
+  entropy_info=DestroyEntropyInfo(entropy_info);
+  text=DestroyStringInfo(text);
+  noise=DestroyStringInfo(noise);
+  random_info=DestroyRandomInfo(random_info);
+  return(pass);
+}
+
+#if defined(WIZARDSTOOLKIT_LZ4_DELEGATE) || \
+    defined(WIZARDSTOOLKIT_ZSTD_DELEGATE)
+static WizardBooleanType TestEntropyRoundTrip(const EntropyType entropy)
+{
+  char
+    name[WizardPathExtent];
+
+  EntropyInfo
+    *entropy_info;
+
+  ExceptionInfo
+    *exception;
+
+  register ssize_t
+    i;
+
+  StringInfo
+    *chaos,
+    *plaintext;
+
+  WizardBooleanType
+    clone,
+    pass,
+    status;
+
+  /*
+    The chaos is library version dependent, test the round trip.
+  */
+  (void) CopyWizardString(name,WizardOptionToMnemonic(WizardEntropyOptions,
+    entropy),WizardPathExtent);
+  LocaleLower(name);
+  (void) PrintValidateString(stdout,"testing %s entropy:\n",name);
+  pass=WizardTrue;
+  exception=AcquireExceptionInfo();
+  entropy_info=AcquireEntropyInfo(entropy,6);
+  for (i=0; i < ZipTestVectors; i++)
+  {
+    (void) PrintValidateString(stdout,"  test %.20g ",(double) i);
+    plaintext=StringToStringInfo((char *) zip_test_vector[i].plaintext);
+    status=IncreaseEntropy(entropy_info,plaintext,exception);
+    if (status == WizardFalse)
+      pass=WizardFalse;
+    /*
+      Restore entropy must ignore any padding that follows the chaos.
+    */
+    chaos=CloneStringInfo(GetEntropyChaos(entropy_info));
+    ConcatenateStringInfo(chaos,plaintext);
+    status=RestoreEntropy(entropy_info,GetStringInfoLength(plaintext),chaos,
+      exception);
+    if (status == WizardFalse)
+      pass=WizardFalse;
+    clone=CompareStringInfo(GetEntropyChaos(entropy_info),plaintext) == 0 ?
+      WizardTrue : WizardFalse;
+    (void) PrintValidateString(stdout,"%s.\n",clone != WizardFalse ? "pass" :
+      "fail");
+    if (clone == WizardFalse)
+      pass=WizardFalse;
+    plaintext=DestroyStringInfo(plaintext);
+    chaos=DestroyStringInfo(chaos);
+  }
+  entropy_info=DestroyEntropyInfo(entropy_info);
+  exception=DestroyExceptionInfo(exception);
+  return(pass);
+}
+#endif
+
+static WizardBooleanType TestHashmap(void)
+{
+#define HashmapTestEntries  10000
+
+  char
+    key[WizardPathExtent],
+    *seen;
+
+  HashmapInfo
+    *hashmap_info;
+
+  register ssize_t
+    i;
+
+  size_t
+    entries;
+
+  ssize_t
+    j;
+
+  WizardBooleanType
+    clone,
+    pass;
+
+  (void) PrintValidateString(stdout,"testing hashmap:\n");
+  hashmap_info=NewHashmap(SmallHashmapSize,HashStringType,CompareHashmapString,
+    RelinquishWizardMemory,(void *(*)(void *)) NULL);
+  seen=(char *) AcquireQuantumMemory(HashmapTestEntries,sizeof(*seen));
+  if (seen == (char *) NULL)
+    {
+      hashmap_info=DestroyHashmap(hashmap_info);
+      return(WizardFalse);
+    }
+  /*
+    Insert across many resizes, sampling lookups as the table grows.
+  */
+  (void) PrintValidateString(stdout,"  test 0 ");
+  pass=WizardTrue;
+  for (i=0; i < HashmapTestEntries; i++)
+  {
+    (void) FormatLocaleString(key,WizardPathExtent,"key-%.20g",(double) i);
+    if (PutEntryInHashmap(hashmap_info,ConstantString(key),(void *) (i+1)) ==
+        WizardFalse)
+      pass=WizardFalse;
+    if ((i % 97) != 0)
+      continue;
+    for (j=0; j <= i; j+=7)
+    {
+      (void) FormatLocaleString(key,WizardPathExtent,"key-%.20g",(double) j);
+      if (GetValueFromHashmap(hashmap_info,key) != (void *) (j+1))
+        pass=WizardFalse;
+    }
+  }
+  if (GetNumberOfEntriesInHashmap(hashmap_info) != HashmapTestEntries)
+    pass=WizardFalse;
+  (void) PrintValidateString(stdout,"%s.\n",pass != WizardFalse ? "pass" :
+    "fail");
+  /*
+    Remove every other entry and look up both halves.
+  */
+  (void) PrintValidateString(stdout,"  test 1 ");
+  clone=WizardTrue;
+  for (i=0; i < HashmapTestEntries; i+=2)
+  {
+    (void) FormatLocaleString(key,WizardPathExtent,"key-%.20g",(double) i);
+    if (RemoveEntryFromHashmap(hashmap_info,key) != (void *) (i+1))
+      clone=WizardFalse;
+  }
+  for (i=0; i < HashmapTestEntries; i++)
+  {
+    (void) FormatLocaleString(key,WizardPathExtent,"key-%.20g",(double) i);
+    if (GetValueFromHashmap(hashmap_info,key) !=
+        ((i & 0x01) != 0 ? (void *) (i+1) : (void *) NULL))
+      clone=WizardFalse;
+  }
+  if (GetNumberOfEntriesInHashmap(hashmap_info) != (HashmapTestEntries/2))
+    clone=WizardFalse;
+  (void) PrintValidateString(stdout,"%s.\n",clone != WizardFalse ? "pass" :
+    "fail");
+  if (clone == WizardFalse)
+    pass=WizardFalse;
+  /*
+    Reinsert into the deleted slots, then churn one key so each insert lands
+    on the tombstone of the previous remove.
+  */
+  (void) PrintValidateString(stdout,"  test 2 ");
+  clone=WizardTrue;
+  for (i=0; i < HashmapTestEntries; i+=2)
+  {
+    (void) FormatLocaleString(key,WizardPathExtent,"key-%.20g",(double) i);
+    if (PutEntryInHashmap(hashmap_info,ConstantString(key),(void *) (i+1)) ==
+        WizardFalse)
+      clone=WizardFalse;
+  }
+  for (i=0; i < (8*HashmapTestEntries); i++)
+  {
+    (void) FormatLocaleString(key,WizardPathExtent,"churn-%.20g",(double)
+      (i % 3));
+    (void) PutEntryInHashmap(hashmap_info,ConstantString(key),(void *) 1);
+    (void) RemoveEntryFromHashmap(hashmap_info,key);
+  }
+  for (i=0; i < HashmapTestEntries; i++)
+  {
+    (void) FormatLocaleString(key,WizardPathExtent,"key-%.20g",(double) i);
+    if (GetValueFromHashmap(hashmap_info,key) != (void *) (i+1))
+      clone=WizardFalse;
+  }
+  if (GetNumberOfEntriesInHashmap(hashmap_info) != HashmapTestEntries)
+    clone=WizardFalse;
+  (void) PrintValidateString(stdout,"%s.\n",clone != WizardFalse ? "pass" :
+    "fail");
+  if (clone == WizardFalse)
+    pass=WizardFalse;
+  /*
+    Iterate as the table grows: each key exactly once.
+  */
+  (void) PrintValidateString(stdout,"  test 3 ");
+  hashmap_info=DestroyHashmap(hashmap_info);
+  hashmap_info=NewHashmap(SmallHashmapSize,HashStringType,CompareHashmapString,
+    RelinquishWizardMemory,(void *(*)(void *)) NULL);
+  clone=WizardTrue;
+  for (i=0; i < HashmapTestEntries; i++)
+  {
+    const char
+      *next;
+
+    (void) FormatLocaleString(key,WizardPathExtent,"key-%.20g",(double) i);
+    (void) PutEntryInHashmap(hashmap_info,ConstantString(key),(void *) (i+1));
+    if ((i % 61) != 0)
+      continue;
+    (void) ResetWizardMemory(seen,0,HashmapTestEntries*sizeof(*seen));
+    entries=0;
+    ResetHashmapIterator(hashmap_info);
+    next=(const char *) GetNextKeyInHashmap(hashmap_info);
+    while (next != (const char *) NULL)
+    {
+      j=(ssize_t) strtol(next+4,(char **) NULL,10);
+      if ((j < 0) || (j > i) || (seen[j] != 0))
+        clone=WizardFalse;
+      else
+        seen[j]=1;
+      entries++;
+      next=(const char *) GetNextKeyInHashmap(hashmap_info);
+    }
+    if (entries != (size_t) (i+1))
+      clone=WizardFalse;
+  }
+  (void) PrintValidateString(stdout,"%s.\n",clone != WizardFalse ? "pass" :
+    "fail");
+  if (clone == WizardFalse)
+    pass=WizardFalse;
+  /*
+    Reserve ahead of the inserts, on an empty and on a populated hashmap.
+  */
+  (void) PrintValidateString(stdout,"  test 4 ");
+  clone=ReserveHashmapCapacity(hashmap_info,4*HashmapTestEntries);
+  for (i=HashmapTestEntries; i < (4*HashmapTestEntries); i++)
+  {
+    (void) FormatLocaleString(key,WizardPathExtent,"key-%.20g",(double) i);
+    if (PutEntryInHashmap(hashmap_info,ConstantString(key),(void *) (i+1)) ==
+        WizardFalse)
+      clone=WizardFalse;
+  }
+  for (i=0; i < (4*HashmapTestEntries); i++)
+  {
+    (void) FormatLocaleString(key,WizardPathExtent,"key-%.20g",(double) i);
+    if (GetValueFromHashmap(hashmap_info,key) != (void *) (i+1))
+      clone=WizardFalse;
+  }
+  if (GetNumberOfEntriesInHashmap(hashmap_info) != (4*HashmapTestEntries))
+    clone=WizardFalse;
+  hashmap_info=DestroyHashmap(hashmap_info);
+  hashmap_info=NewHashmap(SmallHashmapSize,HashStringType,CompareHashmapString,
+    RelinquishWizardMemory,(void *(*)(void *)) NULL);
+  if (ReserveHashmapCapacity(hashmap_info,HashmapTestEntries) == WizardFalse)
+    clone=WizardFalse;
+  for (i=0; i < HashmapTestEntries; i++)
+  {
+    (void) FormatLocaleString(key,WizardPathExtent,"key-%.20g",(double) i);
+    (void) PutEntryInHashmap(hashmap_info,ConstantString(key),(void *) (i+1));
+  }
+  for (i=0; i < HashmapTestEntries; i++)
+  {
+    (void) FormatLocaleString(key,WizardPathExtent,"key-%.20g",(double) i);
+    if (GetValueFromHashmap(hashmap_info,key) != (void *) (i+1))
+      clone=WizardFalse;
+  }
+  (void) PrintValidateString(stdout,"%s.\n",clone != WizardFalse ? "pass" :
+    "fail");
+  if (clone == WizardFalse)
+    pass=WizardFalse;
+  hashmap_info=DestroyHashmap(hashmap_info);
+  seen=(char *) RelinquishWizardMemory(seen);
+  return(pass);
+}
+
 static WizardBooleanType TestHMACMD5(void)
 {
   register ssize_t
@@ -709,6 +1141,364 @@ static WizardBooleanType TestKeymap(void)
   return(pass);
 }
 
+static size_t CountValidateKeyring(const char *path)
+{
+  ExceptionInfo
+    *exception;
+
+  KeyringInfo
+    **keyring_info;
+
+  register ssize_t
+    i;
+
+  size_t
+    number_keys;
+
+  /*
+    Export every live key of the keyring and count them.
+  */
+  exception=AcquireExceptionInfo();
+  number_keys=0;
+  keyring_info=ExportKeyringKeys(path,&number_keys,exception);
+  exception=DestroyExceptionInfo(exception);
+  if (keyring_info == (KeyringInfo **) NULL)
+    return(0);
+  for (i=0; i < (ssize_t) number_keys; i++)
+    keyring_info[i]=DestroyKeyringInfo(keyring_info[i]);
+  keyring_info=(KeyringInfo **) RelinquishWizardMemory(keyring_info);
+  return(number_keys);
+}
+
+static void SetValidateKeyring(KeyringInfo *keyring_info,const ssize_t i,
+  const char *prefix)
+{
+  char
+    text[WizardPathExtent];
+
+  StringInfo
+    *datum;
+
+  (void) FormatLocaleString(text,WizardPathExtent,"validate-id-%.20g",
+    (double) i);
+  datum=StringToStringInfo(text);
+  SetKeyringId(keyring_info,datum);
+  datum=DestroyStringInfo(datum);
+  (void) FormatLocaleString(text,WizardPathExtent,"%s-key-%.20g",prefix,
+    (double) i);
+  datum=StringToStringInfo(text);
+  SetKeyringKey(keyring_info,datum);
+  datum=DestroyStringInfo(datum);
+  datum=StringToStringInfo("validate-nonce");
+  SetKeyringNonce(keyring_info,datum);
+  datum=DestroyStringInfo(datum);
+}
+
+static WizardBooleanType ValidateKeyring(const char *path,const ssize_t i,
+  const char *prefix)
+{
+  char
+    text[WizardPathExtent];
+
+  ExceptionInfo
+    *exception;
+
+  KeyringInfo
+    *keyring_info;
+
+  StringInfo
+    *key;
+
+  WizardBooleanType
+    status;
+
+  /*
+    A null prefix expects the key to be absent.
+  */
+  keyring_info=AcquireKeyringInfo(path);
+  SetValidateKeyring(keyring_info,i,"");
+  exception=AcquireExceptionInfo();
+  status=ExportKeyringKey(keyring_info,exception);
+  exception=DestroyExceptionInfo(exception);
+  if (prefix == (const char *) NULL)
+    {
+      keyring_info=DestroyKeyringInfo(keyring_info);
+      return(status == WizardFalse ? WizardTrue : WizardFalse);
+    }
+  if (status != WizardFalse)
+    {
+      (void) FormatLocaleString(text,WizardPathExtent,"%s-key-%.20g",prefix,
+        (double) i);
+      key=StringToStringInfo(text);
+      status=CompareStringInfo(key,GetKeyringKey(keyring_info)) == 0 ?
+        WizardTrue : WizardFalse;
+      key=DestroyStringInfo(key);
+    }
+  keyring_info=DestroyKeyringInfo(keyring_info);
+  return(status);
+}
+
+static WizardBooleanType WriteValidateFile(const char *path,
+  const StringInfo *content)
+{
+  FILE
+    *file;
+
+  size_t
+    count;
+
+  /*
+    An existing file is truncated and rewritten, so it keeps its inode.
+  */
+  file=fopen(path,"wb");
+  if (file == (FILE *) NULL)
+    return(WizardFalse);
+  count=fwrite(GetStringInfoDatum(content),1,GetStringInfoLength(content),
+    file);
+  if (fclose(file) != 0)
+    return(WizardFalse);
+  return(count == GetStringInfoLength(content) ? WizardTrue : WizardFalse);
+}
+
+static WizardBooleanType TestKeyring(void)
+{
+#define KeyringTestBulkKeys  512
+#define KeyringTestCopy  "validate-copy.xdm"
+#define KeyringTestForward  "validate-forward.xdm"
+#define KeyringTestForwardIndex  "validate-forward.idx"
+#define KeyringTestIndex  "validate.idx"
+#define KeyringTestKeyring  "validate.xdm"
+#define KeyringTestKeys  64
+#define KeyringTestLiveKeys  \
+  (KeyringTestTotalKeys-(KeyringTestTotalKeys+2)/3+1)
+#define KeyringTestPrefix(i)  ((i) == 3 ? "replace" : ((i) % 3) == 0 ? \
+  (const char *) NULL : "validate")
+#define KeyringTestReverse  "validate-reverse.xdm"
+#define KeyringTestReverseIndex  "validate-reverse.idx"
+#define KeyringTestTotalKeys  (KeyringTestKeys+KeyringTestBulkKeys)
+
+  ExceptionInfo
+    *exception;
+
+  KeyringInfo
+    *key_info,
+    **keyring_info;
+
+  register ssize_t
+    i;
+
+  StringInfo
+    *index,
+    *keyring;
+
+  WizardBooleanType
+    clone,
+    pass;
+
+  (void) PrintValidateString(stdout,"testing key ring:\n");
+  (void) remove(KeyringTestKeyring);
+  (void) remove(KeyringTestIndex);
+  exception=AcquireExceptionInfo();
+  /*
+    Import keys one at a time, then look each up through the sidecar index.
+  */
+  (void) PrintValidateString(stdout,"  test 0 ");
+  pass=WizardTrue;
+  for (i=0; i < KeyringTestKeys; i++)
+  {
+    key_info=AcquireKeyringInfo(KeyringTestKeyring);
+    SetValidateKeyring(key_info,i,"validate");
+    if (ImportKeyringKey(key_info,exception) == WizardFalse)
+      pass=WizardFalse;
+    key_info=DestroyKeyringInfo(key_info);
+  }
+  for (i=0; i < KeyringTestKeys; i++)
+    if (ValidateKeyring(KeyringTestKeyring,i,"validate") == WizardFalse)
+      pass=WizardFalse;
+  if (ValidateKeyring(KeyringTestKeyring,KeyringTestKeys,(const char *)
+      NULL) == WizardFalse)
+    pass=WizardFalse;
+  if (IsPathAcessible(KeyringTestIndex) == WizardFalse)
+    pass=WizardFalse;
+  (void) PrintValidateString(stdout,"%s.\n",pass != WizardFalse ? "pass" :
+    "fail");
+  /*
+    Rebuild a missing index.
+  */
+  (void) PrintValidateString(stdout,"  test 1 ");
+  clone=WizardTrue;
+  (void) remove(KeyringTestIndex);
+  for (i=0; i < KeyringTestKeys; i++)
+    if (ValidateKeyring(KeyringTestKeyring,i,"validate") == WizardFalse)
+      clone=WizardFalse;
+  if (IsPathAcessible(KeyringTestIndex) == WizardFalse)
+    clone=WizardFalse;
+  (void) PrintValidateString(stdout,"%s.\n",clone != WizardFalse ? "pass" :
+    "fail");
+  if (clone == WizardFalse)
+    pass=WizardFalse;
+  /*
+    Rebuild an index that belongs to another inode of the keyring.
+  */
+  (void) PrintValidateString(stdout,"  test 2 ");
+  clone=WizardTrue;
+  index=FileToStringInfo(KeyringTestIndex,~0UL,exception);
+  keyring=FileToStringInfo(KeyringTestKeyring,~0UL,exception);
+  if ((index == (StringInfo *) NULL) || (keyring == (StringInfo *) NULL))
+    clone=WizardFalse;
+  else
+    {
+      if ((WriteValidateFile(KeyringTestCopy,keyring) == WizardFalse) ||
+          (rename(KeyringTestCopy,KeyringTestKeyring) != 0) ||
+          (WriteValidateFile(KeyringTestIndex,index) == WizardFalse))
+        clone=WizardFalse;
+      for (i=0; i < KeyringTestKeys; i++)
+        if (ValidateKeyring(KeyringTestKeyring,i,"validate") == WizardFalse)
+          clone=WizardFalse;
+    }
+  if (index != (StringInfo *) NULL)
+    index=DestroyStringInfo(index);
+  if (keyring != (StringInfo *) NULL)
+    keyring=DestroyStringInfo(keyring);
+  (void) PrintValidateString(stdout,"%s.\n",clone != WizardFalse ? "pass" :
+    "fail");
+  if (clone == WizardFalse)
+    pass=WizardFalse;
+  /*
+    Rewrite a keyring in place with the same keys in reverse order, so its
+    index still matches the inode and extent but not the record offsets.
+  */
+  (void) PrintValidateString(stdout,"  test 3 ");
+  clone=WizardTrue;
+  (void) remove(KeyringTestForward);
+  (void) remove(KeyringTestForwardIndex);
+  (void) remove(KeyringTestReverse);
+  (void) remove(KeyringTestReverseIndex);
+  for (i=0; i < KeyringTestKeys; i++)
+  {
+    key_info=AcquireKeyringInfo(KeyringTestForward);
+    SetValidateKeyring(key_info,i,"validate");
+    if (ImportKeyringKey(key_info,exception) == WizardFalse)
+      clone=WizardFalse;
+    key_info=DestroyKeyringInfo(key_info);
+    key_info=AcquireKeyringInfo(KeyringTestReverse);
+    SetValidateKeyring(key_info,KeyringTestKeys-i-1,"validate");
+    if (ImportKeyringKey(key_info,exception) == WizardFalse)
+      clone=WizardFalse;
+    key_info=DestroyKeyringInfo(key_info);
+  }
+  if (ValidateKeyring(KeyringTestForward,0,"validate") == WizardFalse)
+    clone=WizardFalse;
+  index=FileToStringInfo(KeyringTestForwardIndex,~0UL,exception);
+  keyring=FileToStringInfo(KeyringTestReverse,~0UL,exception);
+  if ((index == (StringInfo *) NULL) || (keyring == (StringInfo *) NULL))
+    clone=WizardFalse;
+  else
+    if ((WriteValidateFile(KeyringTestForward,keyring) == WizardFalse) ||
+        (WriteValidateFile(KeyringTestForwardIndex,index) == WizardFalse))
+      clone=WizardFalse;
+  if (index != (StringInfo *) NULL)
+    index=DestroyStringInfo(index);
+  if (keyring != (StringInfo *) NULL)
+    keyring=DestroyStringInfo(keyring);
+  for (i=0; i < KeyringTestKeys; i++)
+    if (ValidateKeyring(KeyringTestForward,i,"validate") == WizardFalse)
+      clone=WizardFalse;
+  (void) PrintValidateString(stdout,"%s.\n",clone != WizardFalse ? "pass" :
+    "fail");
+  if (clone == WizardFalse)
+    pass=WizardFalse;
+  /*
+    Import keys in bulk, one of them a duplicate that is skipped, then export
+    them all.
+  */
+  (void) PrintValidateString(stdout,"  test 4 ");
+  clone=WizardTrue;
+  keyring_info=(KeyringInfo **) AcquireQuantumMemory(KeyringTestBulkKeys+1,
+    sizeof(*keyring_info));
+  if (keyring_info == (KeyringInfo **) NULL)
+    clone=WizardFalse;
+  else
+    {
+      for (i=0; i <= KeyringTestBulkKeys; i++)
+      {
+        keyring_info[i]=AcquireKeyringInfo(KeyringTestKeyring);
+        SetValidateKeyring(keyring_info[i],i < KeyringTestBulkKeys ?
+          KeyringTestKeys+i : 0,"validate");
+      }
+      (void) ImportKeyringKeys(KeyringTestKeyring,keyring_info,
+        KeyringTestBulkKeys+1,exception);
+      for (i=0; i <= KeyringTestBulkKeys; i++)
+        keyring_info[i]=DestroyKeyringInfo(keyring_info[i]);
+      keyring_info=(KeyringInfo **) RelinquishWizardMemory(keyring_info);
+    }
+  for (i=0; i < KeyringTestTotalKeys; i++)
+    if (ValidateKeyring(KeyringTestKeyring,i,"validate") == WizardFalse)
+      clone=WizardFalse;
+  if (CountValidateKeyring(KeyringTestKeyring) != KeyringTestTotalKeys)
+    clone=WizardFalse;
+  (void) PrintValidateString(stdout,"%s.\n",clone != WizardFalse ? "pass" :
+    "fail");
+  if (clone == WizardFalse)
+    pass=WizardFalse;
+  /*
+    Delete every third key, then import a replacement for one of them.
+  */
+  (void) PrintValidateString(stdout,"  test 5 ");
+  clone=WizardTrue;
+  for (i=0; i < KeyringTestTotalKeys; i+=3)
+  {
+    key_info=AcquireKeyringInfo(KeyringTestKeyring);
+    SetValidateKeyring(key_info,i,"validate");
+    if (DeleteKeyringKey(key_info,exception) == WizardFalse)
+      clone=WizardFalse;
+    key_info=DestroyKeyringInfo(key_info);
+  }
+  key_info=AcquireKeyringInfo(KeyringTestKeyring);
+  SetValidateKeyring(key_info,3,"replace");
+  if (ImportKeyringKey(key_info,exception) == WizardFalse)
+    clone=WizardFalse;
+  key_info=DestroyKeyringInfo(key_info);
+  for (i=0; i < KeyringTestTotalKeys; i++)
+    if (ValidateKeyring(KeyringTestKeyring,i,KeyringTestPrefix(i)) ==
+        WizardFalse)
+      clone=WizardFalse;
+  if (CountValidateKeyring(KeyringTestKeyring) != KeyringTestLiveKeys)
+    clone=WizardFalse;
+  (void) PrintValidateString(stdout,"%s.\n",clone != WizardFalse ? "pass" :
+    "fail");
+  if (clone == WizardFalse)
+    pass=WizardFalse;
+  /*
+    Compact the keyring, then reopen it and look up every key.
+  */
+  (void) PrintValidateString(stdout,"  test 6 ");
+  clone=CompactKeyring(KeyringTestKeyring,exception);
+  for (i=0; i < KeyringTestTotalKeys; i++)
+    if (ValidateKeyring(KeyringTestKeyring,i,KeyringTestPrefix(i)) ==
+        WizardFalse)
+      clone=WizardFalse;
+  if (CountValidateKeyring(KeyringTestKeyring) != KeyringTestLiveKeys)
+    clone=WizardFalse;
+  (void) remove(KeyringTestIndex);
+  for (i=0; i < KeyringTestTotalKeys; i++)
+    if (ValidateKeyring(KeyringTestKeyring,i,KeyringTestPrefix(i)) ==
+        WizardFalse)
+      clone=WizardFalse;
+  (void) PrintValidateString(stdout,"%s.\n",clone != WizardFalse ? "pass" :
+    "fail");
+  if (clone == WizardFalse)
+    pass=WizardFalse;
+  (void) remove(KeyringTestKeyring);
+  (void) remove(KeyringTestIndex);
+  (void) remove(KeyringTestForward);
+  (void) remove(KeyringTestForwardIndex);
+  (void) remove(KeyringTestReverse);
+  (void) remove(KeyringTestReverseIndex);
+  exception=DestroyExceptionInfo(exception);
+  return(pass);
+}
+
 static WizardBooleanType TestLogEvent(void)
 {
   WizardBooleanType
@@ -1766,18 +2556,34 @@ int main(int argc,char **argv)
     pass=WizardFalse;
   if (TestTwofish() == WizardFalse)
     pass=WizardFalse;
+  if (TestEntropyIncreasable() == WizardFalse)
+    pass=WizardFalse;
   if (TestBZIPEntropy() == WizardFalse)
     pass=WizardFalse;
+#if defined(WIZARDSTOOLKIT_LZ4_DELEGATE)
+  if (TestEntropyRoundTrip(LZ4Entropy) == WizardFalse)
+    pass=WizardFalse;
+#endif
 #if defined(WIZARDSTOOLKIT_LZMA_DELEGATE)
   if (TestLZMAEntropy() == WizardFalse)
     pass=WizardFalse;
 #endif
   if (TestZIPEntropy() == WizardFalse)
     pass=WizardFalse;
+#if defined(WIZARDSTOOLKIT_ZSTD_DELEGATE)
+  if (TestEntropyRoundTrip(ZSTDEntropy) == WizardFalse)
+    pass=WizardFalse;
+#endif
   if (TestRandomKey() == WizardFalse)
     pass=WizardFalse;
+  if (TestHashmap() == WizardFalse)
+    pass=WizardFalse;
+  if (TestConcurrentHashmap() == WizardFalse)
+    pass=WizardFalse;
   if (TestKeymap() == WizardFalse)
     pass=WizardFalse;
+  if (TestKeyring() == WizardFalse)
+    pass=WizardFalse;
   if (TestAuthenticate(passphrase) == WizardFalse)
     pass=WizardFalse;
   if (pass != WizardFalse)
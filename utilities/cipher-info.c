@@ -55,11 +55,34 @@
 #include "wizard/blob-private.h"
 #include "wizard/exception-private.h"
 #include "wizard/string-private.h"
+#include "wizard/utility-private.h"
 #if defined(WIZARDSTOOLKIT_WINDOWS_SUPPORT)
 #include <windows.h>
 #endif
 #include "content.h"
 #include "utility_.h"
+
+/*
+  Typedef declarations.
+*/
+typedef enum
+{
+  TextFormat,
+  CSVFormat,
+  JSONFormat
+} PropertiesFormat;
+
+/*
+  Forward declaraction.
+*/
+static void
+  PrintCipherRecord(const ContentInfo *,const PropertiesFormat,FILE *);
+
+static WizardBooleanType
+  ConvertCipherHeader(ContentInfo *,const HeaderType,ExceptionInfo *),
+  IdentifyCiphertexts(char **,const size_t,const PropertiesFormat,
+    const size_t,ExceptionInfo *),
+  ReadCipherHeader(ContentInfo *,ExceptionInfo *);
 
 /*
 %%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%
@@ -95,9 +118,12 @@ static void CipherInfoUsage(void)
   static const char
     *options[]=
     {
+      "-convert type        convert the cipher header to XML or Binary",
       "-debug events        display copious debugging information",
+      "-format type         print cipher properties as Text, CSV, or JSON",
       "-help                print program options",
       "-list type           print a list of supported option arguments",
+      "-threads value       number of threads to read cipher headers",
       "-version             print version information",
       (char *) NULL
     };
@@ -121,6 +147,7 @@ WizardExport WizardBooleanType CipherInfoCommand(int argc,char **argv,
 {
 #define DestroyCipherInfo() \
 { \
+  filenames=(char **) RelinquishWizardMemory(filenames); \
   content_info=DestroyContentInfo(content_info); \
   for (i=0; i < (ssize_t) argc; i++) \
     argv[i]=DestroyString(argv[i]); \
@@ -142,14 +169,25 @@ WizardExport WizardBooleanType CipherInfoCommand(int argc,char **argv,
 }
 
   char
+    **filenames,
     *option;
 
   ContentInfo
     *content_info;
 
+  HeaderType
+    header;
+
+  PropertiesFormat
+    format;
+
   register ssize_t
     i;
 
+  size_t
+    number_filenames,
+    threads;
+
   WizardBooleanType
     status;
 
@@ -160,9 +198,16 @@ WizardExport WizardBooleanType CipherInfoCommand(int argc,char **argv,
     CipherInfoUsage();
   status=ExpandFilenames(&argc,&argv);
   content_info=AcquireContentInfo();
+  filenames=(char **) AcquireQuantumMemory((size_t) argc,sizeof(*filenames));
+  if (filenames == (char **) NULL)
+    status=WizardFalse;
   if (status == WizardFalse)
     ThrowCipherException(ResourceError,"memory allocation failed: `%s'",
       strerror(errno));
+  header=UndefinedHeader;
+  format=TextFormat;
+  number_filenames=0;
+  threads=1;
   for (i=1; i < argc; i++)
   {
     option=argv[i];
@@ -170,6 +215,28 @@ WizardExport WizardBooleanType CipherInfoCommand(int argc,char **argv,
       {
         switch(*(option+1))
         {
+          case 'c':
+          {
+            if (LocaleCompare(option,"-convert") == 0)
+              {
+                i++;
+                if (i == argc)
+                  ThrowCipherException(OptionError,"missing header type: "
+                    "`%s'",option);
+                if (LocaleCompare(argv[i],"Binary") == 0)
+                  header=BinaryHeader;
+                else
+                  if (LocaleCompare(argv[i],"XML") == 0)
+                    header=XMLHeader;
+                  else
+                    ThrowCipherException(OptionFatalError,"unrecognized "
+                      "header type: `%s'",argv[i]);
+                break;
+              }
+            ThrowCipherException(OptionFatalError,"unrecognized option: "
+              "`%s'",option);
+            break;
+          }
           case 'd':
           {
             if (strcasecmp(option,"-debug") == 0)
@@ -191,6 +258,31 @@ WizardExport WizardBooleanType CipherInfoCommand(int argc,char **argv,
               "`%s'",option);
             break;
           }
+          case 'f':
+          {
+            if (LocaleCompare(option,"-format") == 0)
+              {
+                i++;
+                if (i == argc)
+                  ThrowCipherException(OptionError,"missing format type: "
+                    "`%s'",option);
+                if (LocaleCompare(argv[i],"CSV") == 0)
+                  format=CSVFormat;
+                else
+                  if (LocaleCompare(argv[i],"JSON") == 0)
+                    format=JSONFormat;
+                  else
+                    if (LocaleCompare(argv[i],"Text") == 0)
+                      format=TextFormat;
+                    else
+                      ThrowCipherException(OptionFatalError,"unrecognized "
+                        "format type: `%s'",argv[i]);
+                break;
+              }
+            ThrowCipherException(OptionFatalError,"unrecognized option: `%s'",
+              option);
+            break;
+          }
           case 'h':
           {
             if ((LocaleCompare("help",option+1) == 0) ||
@@ -241,6 +333,30 @@ WizardExport WizardBooleanType CipherInfoCommand(int argc,char **argv,
               option);
             break;
           }
+          case 't':
+          {
+            if (LocaleCompare(option,"-threads") == 0)
+              {
+                char
+                  *p;
+
+                double
+                  value;
+
+                i++;
+                if (i == argc)
+                  ThrowCipherException(OptionError,"missing threads: `%s'",
+                    option);
+                value=StringToDouble(argv[i],&p);
+                if ((p == argv[i]) || (value < 1.0))
+                  ThrowInvalidArgumentException(option,argv[i]);
+                threads=(size_t) value;
+                break;
+              }
+            ThrowCipherException(OptionFatalError,"unrecognized option: `%s'",
+              option);
+            break;
+          }
           case 'v':
           {
             if (strcasecmp(option,"-version") == 0)
@@ -263,17 +379,31 @@ WizardExport WizardBooleanType CipherInfoCommand(int argc,char **argv,
         }
         continue;
       }
+    filenames[number_filenames++]=argv[i];
+  }
+  if (header == UndefinedHeader)
+    {
+      /*
+        Identify cipher properties.
+      */
+      status=IdentifyCiphertexts(filenames,number_filenames,format,threads,
+        exception);
+      DestroyCipherInfo();
+      return(status);
+    }
+  for (i=0; i < (ssize_t) number_filenames; i++)
+  {
     /*
-      Identify cipher properties.
+      Convert cipher header.
     */
-    content_info->content=ConstantString(argv[i]);
+    content_info->content=ConstantString(filenames[i]);
     content_info->cipherblob=OpenBlob(content_info->content,ReadBinaryBlobMode,
       WizardTrue,exception);
     if (content_info->cipherblob != (BlobInfo *) NULL)
       {
         status=GetContentInfo(content_info,content_info->cipherblob,exception);
         if (status != WizardFalse)
-          (void) PrintCipherProperties(content_info,stdout);
+          status=ConvertCipherHeader(content_info,header,exception);
         if (CloseBlob(content_info->cipherblob) != WizardFalse)
           ThrowFileException(exception,FileError,content_info->content);
       }
@@ -290,6 +420,429 @@ WizardExport WizardBooleanType CipherInfoCommand(int argc,char **argv,
 %                                                                             %
 %                                                                             %
 %                                                                             %
+%   C o n v e r t C i p h e r H e a d e r                                     %
+%                                                                             %
+%                                                                             %
+%                                                                             %
+%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%
+%
+%  ConvertCipherHeader() rewrites the cipher header of a ciphertext in the
+%  specified format.  The chunks that follow the header are copied unchanged
+%  to a sibling file which then replaces the ciphertext.
+%
+%  The format of the ConvertCipherHeader method is:
+%
+%      WizardBooleanType ConvertCipherHeader(ContentInfo *content_info,
+%        const HeaderType header,ExceptionInfo *exception)
+%
+%  A description of each parameter follows:
+%
+%    o content_info: the content info, with the cipher blob positioned after
+%      the cipher header.
+%
+%    o header: the cipher header format.
+%
+%    o exception: return any errors or warnings in this structure.
+%
+*/
+static WizardBooleanType ConvertCipherHeader(ContentInfo *content_info,
+  const HeaderType header,ExceptionInfo *exception)
+{
+  BlobInfo
+    *convert_blob;
+
+  char
+    filename[WizardPathExtent];
+
+  ssize_t
+    count;
+
+  unsigned char
+    *buffer;
+
+  WizardBooleanType
+    status;
+
+  if (content_info->header == header)
+    return(WizardTrue);
+  content_info->header=header;
+  (void) FormatLocaleString(filename,WizardPathExtent,"%s.convert",
+    content_info->content);
+  convert_blob=OpenBlob(filename,WriteBinaryBlobMode,WizardFalse,exception);
+  if (convert_blob == (BlobInfo *) NULL)
+    return(WizardFalse);
+  status=PutContentInfo(content_info,convert_blob,exception);
+  buffer=(unsigned char *) AcquireQuantumMemory(WizardMaxBufferExtent,
+    sizeof(*buffer));
+  if (buffer == (unsigned char *) NULL)
+    ThrowWizardFatalError(CipherDomain,MemoryError);
+  while (status != WizardFalse)
+  {
+    count=ReadBlob(content_info->cipherblob,WizardMaxBufferExtent,buffer);
+    if (count <= 0)
+      break;
+    if (WriteBlob(convert_blob,(size_t) count,buffer) != count)
+      {
+        ThrowFileException(exception,FileError,filename);
+        status=WizardFalse;
+      }
+  }
+  buffer=(unsigned char *) RelinquishWizardMemory(buffer);
+  if (CloseBlob(convert_blob) != WizardFalse)
+    {
+      ThrowFileException(exception,FileError,filename);
+      status=WizardFalse;
+    }
+  convert_blob=DestroyBlob(convert_blob);
+  if ((status != WizardFalse) &&
+      (rename_utf8(filename,content_info->content) != 0))
+    {
+      ThrowFileException(exception,FileError,content_info->content);
+      status=WizardFalse;
+    }
+  if (status == WizardFalse)
+    (void) remove_utf8(filename);
+  return(status);
+}
+
+/*
+%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%
+%                                                                             %
+%                                                                             %
+%                                                                             %
+%   I d e n t i f y C i p h e r t e x t s                                     %
+%                                                                             %
+%                                                                             %
+%                                                                             %
+%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%
+%
+%  IdentifyCiphertexts() reads the cipher header of each ciphertext and prints
+%  its cipher properties.  The headers are read and parsed in parallel, a
+%  block of ciphertexts at a time, and the properties are printed in the order
+%  the ciphertexts are listed.
+%
+%  The format of the IdentifyCiphertexts method is:
+%
+%      WizardBooleanType IdentifyCiphertexts(char **filenames,
+%        const size_t number_filenames,const PropertiesFormat format,
+%        const size_t threads,ExceptionInfo *exception)
+%
+%  A description of each parameter follows:
+%
+%    o filenames: the ciphertext filenames.
+%
+%    o number_filenames: the number of ciphertext filenames.
+%
+%    o format: print the cipher properties as text, CSV, or JSON lines.
+%
+%    o threads: the number of threads to read cipher headers.
+%
+%    o exception: return any errors or warnings in this structure.
+%
+*/
+static WizardBooleanType IdentifyCiphertexts(char **filenames,
+  const size_t number_filenames,const PropertiesFormat format,
+  const size_t threads,ExceptionInfo *exception)
+{
+  ContentInfo
+    **content_info;
+
+  ExceptionInfo
+    **content_exception;
+
+  register ssize_t
+    i;
+
+  size_t
+    extent,
+    failures,
+    offset;
+
+  WizardBooleanType
+    *status;
+
+  extent=256*threads;
+  content_info=(ContentInfo **) AcquireQuantumMemory(extent,
+    sizeof(*content_info));
+  content_exception=(ExceptionInfo **) AcquireQuantumMemory(extent,
+    sizeof(*content_exception));
+  status=(WizardBooleanType *) AcquireQuantumMemory(extent,sizeof(*status));
+  if ((content_info == (ContentInfo **) NULL) ||
+      (content_exception == (ExceptionInfo **) NULL) ||
+      (status == (WizardBooleanType *) NULL))
+    ThrowWizardFatalError(CipherDomain,MemoryError);
+  if (format == CSVFormat)
+    (void) fprintf(stdout,"filename,header,cipher,mode,nonce,chunk-nonce,"
+      "authenticate,id,key-hash,key-length,entropy,level,hmac,chunksize,"
+      "modify-date,create-date,timestamp,protocol,version\n");
+  failures=0;
+  for (offset=0; offset < number_filenames; offset+=extent)
+  {
+    size_t
+      count;
+
+    count=number_filenames-offset;
+    if (count > extent)
+      count=extent;
+#if defined(WIZARDSTOOLKIT_HAVE_OPENMP)
+    #pragma omp parallel for schedule(dynamic,8) num_threads(threads)
+#endif
+    for (i=0; i < (ssize_t) count; i++)
+    {
+      content_info[i]=AcquireContentInfo();
+      content_info[i]->content=ConstantString(filenames[offset+i]);
+      content_exception[i]=AcquireExceptionInfo();
+      status[i]=ReadCipherHeader(content_info[i],content_exception[i]);
+    }
+    for (i=0; i < (ssize_t) count; i++)
+    {
+      if (status[i] != WizardFalse)
+        PrintCipherRecord(content_info[i],format,stdout);
+      else
+        failures++;
+      CatchException(content_exception[i]);
+      content_exception[i]=DestroyExceptionInfo(content_exception[i]);
+      content_info[i]=DestroyContentInfo(content_info[i]);
+    }
+  }
+  status=(WizardBooleanType *) RelinquishWizardMemory(status);
+  content_exception=(ExceptionInfo **) RelinquishWizardMemory(
+    content_exception);
+  content_info=(ContentInfo **) RelinquishWizardMemory(content_info);
+  if (failures != 0)
+    {
+      (void) ThrowWizardException(exception,GetWizardModule(),FileError,
+        "unable to identify %.20g of %.20g ciphertexts",(double) failures,
+        (double) number_filenames);
+      return(WizardFalse);
+    }
+  return(WizardTrue);
+}
+
+/*
+%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%
+%                                                                             %
+%                                                                             %
+%                                                                             %
+%   P r i n t C i p h e r R e c o r d                                         %
+%                                                                             %
+%                                                                             %
+%                                                                             %
+%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%
+%
+%  PrintCipherRecord() prints the cipher properties of a ciphertext as text,
+%  as a CSV row, or as a JSON line.
+%
+%  The format of the PrintCipherRecord method is:
+%
+%      void PrintCipherRecord(const ContentInfo *content_info,
+%        const PropertiesFormat format,FILE *file)
+%
+%  A description of each parameter follows:
+%
+%    o content_info: the content info.
+%
+%    o format: print the cipher properties as text, CSV, or JSON lines.
+%
+%    o file: the file, typically stdout.
+%
+*/
+
+static void PrintCipherValue(const char *value,const PropertiesFormat format,
+  FILE *file)
+{
+  register const char
+    *p;
+
+  if (value == (const char *) NULL)
+    value="";
+  if (format == CSVFormat)
+    {
+      if (strpbrk(value,",\"\r\n") == (char *) NULL)
+        {
+          (void) fputs(value,file);
+          return;
+        }
+      (void) fputc('"',file);
+      for (p=value; *p != '\0'; p++)
+      {
+        if (*p == '"')
+          (void) fputc('"',file);
+        (void) fputc(*p,file);
+      }
+      (void) fputc('"',file);
+      return;
+    }
+  (void) fputc('"',file);
+  for (p=value; *p != '\0'; p++)
+  {
+    if ((*p == '"') || (*p == '\\'))
+      (void) fprintf(file,"\\%c",*p);
+    else
+      if ((unsigned char) *p < 0x20)
+        (void) fprintf(file,"\\u%04x",(unsigned int) ((unsigned char) *p));
+      else
+        (void) fputc(*p,file);
+  }
+  (void) fputc('"',file);
+}
+
+static void PrintCipherField(const char *name,const char *value,
+  const PropertiesFormat format,FILE *file)
+{
+  if (format == CSVFormat)
+    {
+      if (strcmp(name,"filename") != 0)
+        (void) fputc(',',file);
+      PrintCipherValue(value,format,file);
+      return;
+    }
+  (void) fprintf(file,"%s\"%s\":",strcmp(name,"filename") != 0 ? "," : "{",
+    name);
+  PrintCipherValue(value,format,file);
+}
+
+static void PrintCipherRecord(const ContentInfo *content_info,
+  const PropertiesFormat format,FILE *file)
+{
+  char
+    value[WizardPathExtent];
+
+  if (format == TextFormat)
+    {
+      (void) PrintCipherProperties(content_info,file);
+      return;
+    }
+  PrintCipherField("filename",content_info->content,format,file);
+  PrintCipherField("header",content_info->header == BinaryHeader ? "Binary" :
+    "XML",format,file);
+  PrintCipherField("cipher",WizardOptionToMnemonic(WizardCipherOptions,
+    content_info->cipher),format,file);
+  PrintCipherField("mode",WizardOptionToMnemonic(WizardModeOptions,
+    content_info->mode),format,file);
+  PrintCipherField("nonce",content_info->nonce,format,file);
+  PrintCipherField("chunk-nonce",content_info->chunk_nonce != WizardFalse ?
+    "true" : "false",format,file);
+  PrintCipherField("authenticate",WizardOptionToMnemonic(
+    WizardAuthenticateOptions,content_info->authenticate_method),format,file);
+  PrintCipherField("id",content_info->id,format,file);
+  PrintCipherField("key-hash",WizardOptionToMnemonic(WizardHashOptions,
+    content_info->key_hash),format,file);
+  (void) FormatLocaleString(value,WizardPathExtent,"%u",
+    content_info->key_length);
+  PrintCipherField("key-length",value,format,file);
+  PrintCipherField("entropy",WizardOptionToMnemonic(WizardEntropyOptions,
+    content_info->entropy),format,file);
+  (void) FormatLocaleString(value,WizardPathExtent,"%u",content_info->level);
+  PrintCipherField("level",value,format,file);
+  PrintCipherField("hmac",WizardOptionToMnemonic(WizardHashOptions,
+    content_info->hmac),format,file);
+  (void) FormatLocaleString(value,WizardPathExtent,"%.20g",(double)
+    content_info->chunksize);
+  PrintCipherField("chunksize",value,format,file);
+  (void) FormatWizardTime(content_info->modify_date,WizardPathExtent,value);
+  PrintCipherField("modify-date",value,format,file);
+  (void) FormatWizardTime(content_info->create_date,WizardPathExtent,value);
+  PrintCipherField("create-date",value,format,file);
+  (void) FormatWizardTime(content_info->timestamp,WizardPathExtent,value);
+  PrintCipherField("timestamp",value,format,file);
+  (void) FormatLocaleString(value,WizardPathExtent,"%u.%u",
+    content_info->protocol_major,content_info->protocol_minor);
+  PrintCipherField("protocol",value,format,file);
+  PrintCipherField("version",content_info->version,format,file);
+  (void) fputs(format == JSONFormat ? "}\n" : "\n",file);
+}
+
+/*
+%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%
+%                                                                             %
+%                                                                             %
+%                                                                             %
+%   R e a d C i p h e r H e a d e r                                           %
+%                                                                             %
+%                                                                             %
+%                                                                             %
+%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%
+%
+%  ReadCipherHeader() initializes the content info from the cipher header of
+%  a ciphertext.  Only the leading bytes of the ciphertext, which hold the
+%  header, are read with a single system call.  If the header cannot be
+%  parsed from these bytes, e.g. the ciphertext is compressed, the whole
+%  ciphertext is opened as a blob instead.
+%
+%  The format of the ReadCipherHeader method is:
+%
+%      WizardBooleanType ReadCipherHeader(ContentInfo *content_info,
+%        ExceptionInfo *exception)
+%
+%  A description of each parameter follows:
+%
+%    o content_info: the content info.
+%
+%    o exception: return any errors or warnings in this structure.
+%
+*/
+static WizardBooleanType ReadCipherHeader(ContentInfo *content_info,
+  ExceptionInfo *exception)
+{
+  BlobInfo
+    *blob_info;
+
+  ExceptionInfo
+    *sans_exception;
+
+  int
+    file;
+
+  ssize_t
+    count;
+
+  unsigned char
+    header[WizardMaxBufferExtent];
+
+  WizardBooleanType
+    status;
+
+  status=WizardFalse;
+  file=open_utf8(content_info->content,O_RDONLY | O_BINARY,0);
+  if (file != -1)
+    {
+#if defined(WIZARDSTOOLKIT_HAVE_PREAD)
+      count=(ssize_t) pread(file,header,sizeof(header),0);
+#else
+      count=(ssize_t) read(file,header,sizeof(header));
+#endif
+      (void) close(file);
+      if (count > 0)
+        {
+          blob_info=OpenMemoryBlob(content_info->content,header,(size_t)
+            count);
+          sans_exception=AcquireExceptionInfo();
+          status=GetContentInfo(content_info,blob_info,sans_exception);
+          if (status != WizardFalse)
+            InheritException(exception,sans_exception);
+          sans_exception=DestroyExceptionInfo(sans_exception);
+          blob_info=DestroyBlob(blob_info);
+        }
+    }
+  if (status != WizardFalse)
+    return(WizardTrue);
+  blob_info=OpenBlob(content_info->content,ReadBinaryBlobMode,WizardTrue,
+    exception);
+  if (blob_info == (BlobInfo *) NULL)
+    return(WizardFalse);
+  status=GetContentInfo(content_info,blob_info,exception);
+  if (CloseBlob(blob_info) != WizardFalse)
+    ThrowFileException(exception,FileError,content_info->content);
+  blob_info=DestroyBlob(blob_info);
+  return(status);
+}
+
+/*
+%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%
+%                                                                             %
+%                                                                             %
+%                                                                             %
 %  M a i n                                                                    %
 %                                                                             %
 %                                                                             %
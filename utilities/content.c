@@ -47,6 +47,137 @@
 #include "wizard/exception-private.h"
 #include "wizard/string-private.h"
 #include "content.h"
+
+/*
+  Define declarations.
+*/
+#define CipherHeaderExtent  24
+#define CipherHeaderMagic  "\211WTC\r\n\032\n"
+#define CipherHeaderMajor  1
+#define CipherHeaderMaxExtent  (1024*1024)
+#define CipherHeaderMinor  0
+
+/*
+  Typedef declarations.
+*/
+typedef enum
+{
+  UndefinedHeaderTag,
+  CipherHeaderTag,
+  ModeHeaderTag,
+  NonceHeaderTag,
+  ChunkNonceHeaderTag,
+  AuthenticateHeaderTag,
+  IdHeaderTag,
+  KeyHashHeaderTag,
+  KeyLengthHeaderTag,
+  EntropyHeaderTag,
+  LevelHeaderTag,
+  HMACHeaderTag,
+  ChunksizeHeaderTag,
+  ModifyDateHeaderTag,
+  CreateDateHeaderTag,
+  TimestampHeaderTag,
+  ProtocolHeaderTag,
+  VersionHeaderTag,
+  AboutHeaderTag
+} HeaderTag;
+
+static inline WizardSizeType GetHeaderValue(const unsigned char *p,
+  const size_t length)
+{
+  register ssize_t
+    i;
+
+  WizardSizeType
+    value;
+
+  value=0;
+  for (i=0; i < (ssize_t) length; i++)
+    value=(value << 8) | p[i];
+  return(value);
+}
+
+static inline void SetHeaderValue(const WizardSizeType value,
+  const size_t length,unsigned char *q)
+{
+  register ssize_t
+    i;
+
+  for (i=0; i < (ssize_t) length; i++)
+    q[i]=(unsigned char) (value >> (8*(length-i-1)));
+}
+
+/*
+%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%
+%                                                                             %
+%                                                                             %
+%                                                                             %
+%   A c q u i r e C h u n k I n f o T h r e a d S e t                         %
+%                                                                             %
+%                                                                             %
+%                                                                             %
+%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%
+%
+%  AcquireChunkInfoThreadSet() allocates one ChunkInfo structure for each of
+%  the content threads.  Each has its own chunk buffer and cipher, HMAC, and
+%  entropy state so chunks can be processed concurrently.  The cipher key must
+%  be authenticated first.  The set is terminated by a null pointer.
+%
+%  The format of the AcquireChunkInfoThreadSet method is:
+%
+%      ChunkInfo **AcquireChunkInfoThreadSet(const ContentInfo *content_info)
+%
+%  A description of each parameter follows:
+%
+%    o content_info: the cipher options.
+%
+*/
+WizardExport ChunkInfo **AcquireChunkInfoThreadSet(
+  const ContentInfo *content_info)
+{
+  ChunkInfo
+    **chunk_info;
+
+  register ssize_t
+    i;
+
+  size_t
+    threads;
+
+  WizardAssert(CipherDomain,content_info != (const ContentInfo *) NULL);
+  WizardAssert(CipherDomain,content_info->signature == WizardSignature);
+  threads=content_info->threads == 0 ? 1 : content_info->threads;
+  chunk_info=(ChunkInfo **) AcquireQuantumMemory(threads+1,
+    sizeof(*chunk_info));
+  if (chunk_info == (ChunkInfo **) NULL)
+    ThrowWizardFatalError(CipherDomain,MemoryError);
+  (void) ResetWizardMemory(chunk_info,0,(threads+1)*sizeof(*chunk_info));
+  for (i=0; i < (ssize_t) threads; i++)
+  {
+    chunk_info[i]=(ChunkInfo *) AcquireWizardMemory(sizeof(**chunk_info));
+    if (chunk_info[i] == (ChunkInfo *) NULL)
+      ThrowWizardFatalError(CipherDomain,MemoryError);
+    (void) ResetWizardMemory(chunk_info[i],0,sizeof(**chunk_info));
+    chunk_info[i]->chunk=AcquireStringInfo(content_info->chunksize);
+    chunk_info[i]->cipher_info=AcquireCipherInfo(content_info->cipher,
+      content_info->mode);
+    SetCipherKey(chunk_info[i]->cipher_info,GetAuthenticateKey(
+      content_info->authenticate_info));
+    if (content_info->hmac != NoHash)
+      {
+        chunk_info[i]->hmac_info=AcquireHMACInfo(content_info->hmac);
+        chunk_info[i]->hmac=AcquireStringInfo(GetHMACDigestsize(
+          chunk_info[i]->hmac_info));
+      }
+    if (content_info->entropy != NoEntropy)
+      chunk_info[i]->entropy_info=AcquireEntropyInfo(content_info->entropy,
+        content_info->level);
+    chunk_info[i]->entropy=NoEntropy;
+    chunk_info[i]->status=WizardTrue;
+  }
+  return(chunk_info);
+}
 
 /*
 %%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%
@@ -78,6 +209,7 @@ WizardExport ContentInfo *AcquireContentInfo(void)
   if (content_info == (ContentInfo *) NULL)
     ThrowWizardFatalError(CipherDomain,MemoryError);
   (void) ResetWizardMemory(content_info,0,sizeof(*content_info));
+  content_info->header=XMLHeader;
   content_info->cipher=AESCipher;
   content_info->mode=CTRMode;
   content_info->authenticate_method=SecretAuthenticateMethod;
@@ -88,6 +220,8 @@ WizardExport ContentInfo *AcquireContentInfo(void)
   content_info->hmac=SHA2256Hash;
   content_info->random_hash=SHA2256Hash;
   content_info->chunksize=262144;
+  content_info->threads=1;
+  content_info->sync=EndSync;
   content_info->timestamp=time((time_t *) NULL);
   content_info->version=ConstantString(GetWizardVersion(&version));
   content_info->protocol_major=CipherProtocolMajor;
@@ -101,6 +235,164 @@ WizardExport ContentInfo *AcquireContentInfo(void)
 %                                                                             %
 %                                                                             %
 %                                                                             %
+%   C l o n e C o n t e n t I n f o                                           %
+%                                                                             %
+%                                                                             %
+%                                                                             %
+%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%
+%
+%  CloneContentInfo() allocates a ContentInfo structure with the cipher
+%  options of another.  Per-content state such as the blobs, the cipher, the
+%  nonce, and the properties filename is not cloned.
+%
+%  The format of the CloneContentInfo method is:
+%
+%      ContentInfo *CloneContentInfo(const ContentInfo *content_info)
+%
+%  A description of each parameter follows:
+%
+%    o content_info: the content info.
+%
+*/
+WizardExport ContentInfo *CloneContentInfo(const ContentInfo *content_info)
+{
+  ContentInfo
+    *clone_info;
+
+  WizardAssert(CipherDomain,content_info != (const ContentInfo *) NULL);
+  WizardAssert(CipherDomain,content_info->signature == WizardSignature);
+  clone_info=AcquireContentInfo();
+  clone_info->header=content_info->header;
+  clone_info->cipher=content_info->cipher;
+  clone_info->mode=content_info->mode;
+  clone_info->chunk_nonce=content_info->chunk_nonce;
+  clone_info->authenticate_method=content_info->authenticate_method;
+  clone_info->key_hash=content_info->key_hash;
+  if (content_info->keyring != (char *) NULL)
+    clone_info->keyring=ConstantString(content_info->keyring);
+  if (content_info->id != (char *) NULL)
+    clone_info->id=ConstantString(content_info->id);
+  if (content_info->passphrase != (char *) NULL)
+    clone_info->passphrase=ConstantString(content_info->passphrase);
+  clone_info->key_length=content_info->key_length;
+  clone_info->entropy=content_info->entropy;
+  clone_info->level=content_info->level;
+  clone_info->hmac=content_info->hmac;
+  clone_info->random_hash=content_info->random_hash;
+  clone_info->chunksize=content_info->chunksize;
+  clone_info->threads=content_info->threads;
+  clone_info->sync=content_info->sync;
+  clone_info->extract_offset=content_info->extract_offset;
+  clone_info->extract_length=content_info->extract_length;
+  clone_info->timestamp=content_info->timestamp;
+  return(clone_info);
+}
+
+/*
+%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%
+%                                                                             %
+%                                                                             %
+%                                                                             %
+%   C o n c a t e n a t e H e a d e r R e c o r d                             %
+%                                                                             %
+%                                                                             %
+%                                                                             %
+%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%
+%
+%  ConcatenateHeaderRecord() appends a tag, length, value record to a binary
+%  cipher header.  It returns WizardFalse, and appends nothing, if the value
+%  does not fit the 16-bit record length.
+%
+%  The format of the ConcatenateHeaderRecord method is:
+%
+%      WizardBooleanType ConcatenateHeaderRecord(StringInfo *header,
+%        const HeaderTag tag,const size_t length,const unsigned char *value)
+%
+%  A description of each parameter follows:
+%
+%    o header: the binary cipher header.
+%
+%    o tag: the record tag.
+%
+%    o length: the length of the record value, at most 65535 bytes.
+%
+%    o value: the record value.
+%
+*/
+static WizardBooleanType ConcatenateHeaderRecord(StringInfo *header,
+  const HeaderTag tag,const size_t length,const unsigned char *value)
+{
+  StringInfo
+    *record;
+
+  unsigned char
+    *datum;
+
+  if (length > 65535)
+    return(WizardFalse);
+  record=AcquireStringInfo(length+3);
+  datum=GetStringInfoDatum(record);
+  datum[0]=(unsigned char) tag;
+  SetHeaderValue((WizardSizeType) length,2,datum+1);
+  (void) memcpy(datum+3,value,length);
+  ConcatenateStringInfo(header,record);
+  record=DestroyStringInfo(record);
+  return(WizardTrue);
+}
+
+/*
+%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%
+%                                                                             %
+%                                                                             %
+%                                                                             %
+%   D e s t r o y C h u n k I n f o T h r e a d S e t                         %
+%                                                                             %
+%                                                                             %
+%                                                                             %
+%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%
+%
+%  DestroyChunkInfoThreadSet() deallocates memory associated with the
+%  ChunkInfo thread set.
+%
+%  The format of the DestroyChunkInfoThreadSet method is:
+%
+%      ChunkInfo **DestroyChunkInfoThreadSet(ChunkInfo **chunk_info)
+%
+%  A description of each parameter follows:
+%
+%    o chunk_info: the chunk info thread set.
+%
+*/
+WizardExport ChunkInfo **DestroyChunkInfoThreadSet(ChunkInfo **chunk_info)
+{
+  register ssize_t
+    i;
+
+  WizardAssert(CipherDomain,chunk_info != (ChunkInfo **) NULL);
+  for (i=0; chunk_info[i] != (ChunkInfo *) NULL; i++)
+  {
+    if (chunk_info[i]->entropy_info != (EntropyInfo *) NULL)
+      chunk_info[i]->entropy_info=DestroyEntropyInfo(
+        chunk_info[i]->entropy_info);
+    if (chunk_info[i]->hmac_info != (HMACInfo *) NULL)
+      chunk_info[i]->hmac_info=DestroyHMACInfo(chunk_info[i]->hmac_info);
+    if (chunk_info[i]->hmac != (StringInfo *) NULL)
+      chunk_info[i]->hmac=DestroyStringInfo(chunk_info[i]->hmac);
+    if (chunk_info[i]->cipher_info != (CipherInfo *) NULL)
+      chunk_info[i]->cipher_info=DestroyCipherInfo(chunk_info[i]->cipher_info);
+    if (chunk_info[i]->chunk != (StringInfo *) NULL)
+      chunk_info[i]->chunk=DestroyStringInfo(chunk_info[i]->chunk);
+    chunk_info[i]=(ChunkInfo *) RelinquishWizardMemory(chunk_info[i]);
+  }
+  chunk_info=(ChunkInfo **) RelinquishWizardMemory(chunk_info);
+  return(chunk_info);
+}
+
+/*
+%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%
+%                                                                             %
+%                                                                             %
+%                                                                             %
 %   D e s t r o y C o n t e n t I n f o                                       %
 %                                                                             %
 %                                                                             %
@@ -148,6 +440,8 @@ WizardExport ContentInfo *DestroyContentInfo(ContentInfo *content_info)
     content_info->properties=DestroyString(content_info->properties);
   if (content_info->content != (char *) NULL)
     content_info->content=DestroyString(content_info->content);
+  if (content_info->about != (char *) NULL)
+    content_info->about=DestroyString(content_info->about);
   if (content_info->version != (char *) NULL)
     content_info->version=DestroyString(content_info->version);
   if (content_info->plainblob != (BlobInfo *) NULL)
@@ -164,6 +458,261 @@ WizardExport ContentInfo *DestroyContentInfo(ContentInfo *content_info)
 %                                                                             %
 %                                                                             %
 %                                                                             %
+%   G e t B i n a r y C o n t e n t I n f o                                   %
+%                                                                             %
+%                                                                             %
+%                                                                             %
+%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%
+%
+%  GetBinaryContentInfo() initializes the content info structure from a
+%  binary cipher header.  The header has a fixed size prefix: an 8 byte
+%  magic, the major and minor header version, two reserved bytes, the 32-bit
+%  length and the CRC-64 of the records that follow, all big-endian.  Each
+%  record is a 1 byte tag, a 16-bit length, and the value.  Records with an
+%  unknown tag are skipped.  A record length beyond CipherHeaderMaxExtent or
+%  the end of the blob is an authentication error.
+%
+%  The format of the GetBinaryContentInfo method is:
+%
+%      WizardBooleanType GetBinaryContentInfo(ContentInfo *content_info,
+%        BLobInfo *cipher_blob,ExceptionInfo *exception)
+%
+%  A description of each parameter follows:
+%
+%    o content_info: the content info.
+%
+%    o cipher_blob: the cipher blob, positioned after the first magic byte.
+%
+%    o exception: return any errors or warnings in this structure.
+%
+*/
+static WizardBooleanType GetBinaryContentInfo(ContentInfo *content_info,
+  BlobInfo *cipher_blob,ExceptionInfo *exception)
+{
+  char
+    content[WizardPathExtent];
+
+  const unsigned char
+    *p;
+
+  size_t
+    extent,
+    length;
+
+  ssize_t
+    count,
+    type;
+
+  StringInfo
+    *datum,
+    *header;
+
+  unsigned char
+    prefix[CipherHeaderExtent];
+
+  WizardOffsetType
+    offset;
+
+  WizardSizeType
+    crc,
+    size;
+
+  prefix[0]=(unsigned char) *CipherHeaderMagic;
+  count=ReadBlob(cipher_blob,CipherHeaderExtent-1,prefix+1);
+  if ((count != (ssize_t) (CipherHeaderExtent-1)) ||
+      (memcmp(prefix,CipherHeaderMagic,8) != 0) ||
+      (prefix[8] != CipherHeaderMajor))
+    {
+      (void) ThrowWizardException(exception,GetWizardModule(),AuthenticateError,
+        "authentication error: `%s'",GetBlobFilename(cipher_blob));
+      return(WizardFalse);
+    }
+  length=(size_t) GetHeaderValue(prefix+12,4);
+  crc=GetHeaderValue(prefix+16,8);
+  size=GetBlobSize(cipher_blob);
+  offset=TellBlob(cipher_blob);
+  if ((length > CipherHeaderMaxExtent) || ((size != 0) && (offset >= 0) &&
+      ((WizardSizeType) length > (size-(WizardSizeType) offset))))
+    {
+      (void) ThrowWizardException(exception,GetWizardModule(),AuthenticateError,
+        "authentication error: `%s'",GetBlobFilename(cipher_blob));
+      return(WizardFalse);
+    }
+  header=AcquireStringInfo(length);
+  count=ReadBlob(cipher_blob,length,GetStringInfoDatum(header));
+  if ((count != (ssize_t) length) || (GetStringInfoCRC(header) != crc))
+    {
+      header=DestroyStringInfo(header);
+      (void) ThrowWizardException(exception,GetWizardModule(),AuthenticateError,
+        "authentication error: `%s'",GetBlobFilename(cipher_blob));
+      return(WizardFalse);
+    }
+  content_info->header=BinaryHeader;
+  p=GetStringInfoDatum(header);
+  while (length >= 3)
+  {
+    extent=(size_t) GetHeaderValue(p+1,2);
+    if (extent > (length-3))
+      break;
+    (void) memcpy(content,p+3,extent < WizardPathExtent ? extent :
+      WizardPathExtent-1);
+    content[extent < WizardPathExtent ? extent : WizardPathExtent-1]='\0';
+    switch ((HeaderTag) *p)
+    {
+      case AboutHeaderTag:
+      {
+        if (content_info->about != (char *) NULL)
+          content_info->about=DestroyString(content_info->about);
+        content_info->about=ConstantString(content);
+        break;
+      }
+      case AuthenticateHeaderTag:
+      {
+        type=ParseWizardOption(WizardAuthenticateOptions,WizardFalse,content);
+        if (type < 0)
+          (void) ThrowWizardException(exception,GetWizardModule(),OptionError,
+            "unrecognized authentication method: `%s'",content);
+        content_info->authenticate_method=(AuthenticateMethod) type;
+        break;
+      }
+      case ChunkNonceHeaderTag:
+      {
+        content_info->chunk_nonce=GetHeaderValue(p+3,extent) != 0 ?
+          WizardTrue : WizardFalse;
+        break;
+      }
+      case ChunksizeHeaderTag:
+      {
+        content_info->chunksize=(size_t) GetHeaderValue(p+3,extent);
+        break;
+      }
+      case CipherHeaderTag:
+      {
+        type=ParseWizardOption(WizardCipherOptions,WizardFalse,content);
+        if (type < 0)
+          (void) ThrowWizardException(exception,GetWizardModule(),OptionError,
+            "unrecognized cipher type: `%s'",content);
+        content_info->cipher=(CipherType) type;
+        break;
+      }
+      case CreateDateHeaderTag:
+      {
+        content_info->create_date=(time_t) GetHeaderValue(p+3,extent);
+        break;
+      }
+      case EntropyHeaderTag:
+      {
+        type=ParseWizardOption(WizardEntropyOptions,WizardFalse,content);
+        if (type < 0)
+          (void) ThrowWizardException(exception,GetWizardModule(),OptionError,
+            "unrecognized entropy type: `%s'",content);
+        content_info->entropy=(EntropyType) type;
+        break;
+      }
+      case HMACHeaderTag:
+      {
+        type=ParseWizardOption(WizardHashOptions,WizardFalse,content);
+        if (type < 0)
+          (void) ThrowWizardException(exception,GetWizardModule(),OptionError,
+            "unrecognized HMAC hash: `%s'",content);
+        content_info->hmac=(HashType) type;
+        break;
+      }
+      case IdHeaderTag:
+      {
+        datum=AcquireStringInfo(extent);
+        SetStringInfoDatum(datum,p+3);
+        if (content_info->id != (char *) NULL)
+          content_info->id=DestroyString(content_info->id);
+        content_info->id=StringInfoToHexString(datum);
+        datum=DestroyStringInfo(datum);
+        break;
+      }
+      case KeyHashHeaderTag:
+      {
+        type=ParseWizardOption(WizardHashOptions,WizardFalse,content);
+        if (type < 0)
+          (void) ThrowWizardException(exception,GetWizardModule(),OptionError,
+            "unrecognized key hash: `%s'",content);
+        content_info->key_hash=(HashType) type;
+        break;
+      }
+      case KeyLengthHeaderTag:
+      {
+        content_info->key_length=(unsigned int) GetHeaderValue(p+3,extent);
+        break;
+      }
+      case LevelHeaderTag:
+      {
+        content_info->level=(unsigned int) GetHeaderValue(p+3,extent);
+        break;
+      }
+      case ModeHeaderTag:
+      {
+        type=ParseWizardOption(WizardModeOptions,WizardFalse,content);
+        if (type < 0)
+          (void) ThrowWizardException(exception,GetWizardModule(),OptionError,
+            "unrecognized cipher mode: `%s'",content);
+        content_info->mode=(CipherMode) type;
+        break;
+      }
+      case ModifyDateHeaderTag:
+      {
+        content_info->modify_date=(time_t) GetHeaderValue(p+3,extent);
+        break;
+      }
+      case NonceHeaderTag:
+      {
+        datum=AcquireStringInfo(extent);
+        SetStringInfoDatum(datum,p+3);
+        if (content_info->nonce != (char *) NULL)
+          content_info->nonce=DestroyString(content_info->nonce);
+        content_info->nonce=StringInfoToHexString(datum);
+        datum=DestroyStringInfo(datum);
+        break;
+      }
+      case ProtocolHeaderTag:
+      {
+        if (extent == 2)
+          {
+            content_info->protocol_major=(unsigned int) p[3];
+            content_info->protocol_minor=(unsigned int) p[4];
+          }
+        break;
+      }
+      case TimestampHeaderTag:
+      {
+        content_info->timestamp=(time_t) GetHeaderValue(p+3,extent);
+        break;
+      }
+      case VersionHeaderTag:
+      {
+        if (content_info->version != (char *) NULL)
+          content_info->version=DestroyString(content_info->version);
+        content_info->version=ConstantString(content);
+        break;
+      }
+      default:
+        break;
+    }
+    p+=extent+3;
+    length-=extent+3;
+  }
+  header=DestroyStringInfo(header);
+  if (length != 0)
+    {
+      (void) ThrowWizardException(exception,GetWizardModule(),AuthenticateError,
+        "authentication error: `%s'",GetBlobFilename(cipher_blob));
+      return(WizardFalse);
+    }
+  return(WizardTrue);
+}
+
+/*
+%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%
+%                                                                             %
+%                                                                             %
+%                                                                             %
 %   G e t C o n t e n t I n f o                                               %
 %                                                                             %
 %                                                                             %
@@ -171,7 +720,7 @@ WizardExport ContentInfo *DestroyContentInfo(ContentInfo *content_info)
 %%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%
 %
 %  GetContentInfo() initializes the content info structure from the specified
-%  blob.
+%  blob.  The cipher header may be in either the XML or the binary format.
 %
 %  The format of the GetContentInfo method is:
 %
@@ -233,7 +782,11 @@ WizardExport WizardBooleanType GetContentInfo(ContentInfo *content_info,
   (void) ResetWizardMemory(key,0,sizeof(key));
   bytes=0;
   digest=(char *) NULL;
-  for (c=ReadBlobByte(cipher_blob); (c != '>') && (c != EOF); )
+  c=ReadBlobByte(cipher_blob);
+  if (c == (int) ((unsigned char) *CipherHeaderMagic))
+    return(GetBinaryContentInfo(content_info,cipher_blob,exception));
+  content_info->header=XMLHeader;
+  while ((c != '>') && (c != EOF))
   {
     length=WizardPathExtent;
     options=AcquireString((char *) NULL);
@@ -331,6 +884,8 @@ WizardExport WizardBooleanType GetContentInfo(ContentInfo *content_info,
       while (isspace((int) ((unsigned char) c)) != 0)
         c=ReadBlobByte(cipher_blob);
     }
+    if ((c != '>') && (c != EOF) && (isgraph(c) == WizardFalse))
+      c=ReadBlobByte(cipher_blob);  /* skip unprintable */
     options=DestroyString(options);
   }
   if ((bytes == 0) || (digest == (char *) NULL))
@@ -383,6 +938,13 @@ WizardExport WizardBooleanType GetContentInfo(ContentInfo *content_info,
         "authentication error: `%s'",GetBlobFilename(cipher_blob));
       return(WizardFalse);
     }
+  content=GetXMLTreeAttribute(child,"rdf:about");
+  if ((content != (const char *) NULL) && (*content != '\0'))
+    {
+      if (content_info->about != (char *) NULL)
+        content_info->about=DestroyString(content_info->about);
+      content_info->about=ConstantString(content);
+    }
   node=GetXMLTreeChild(child,(const char *) NULL);
   while (node != (XMLTreeInfo *) NULL)
   {
@@ -412,6 +974,11 @@ WizardExport WizardBooleanType GetContentInfo(ContentInfo *content_info,
       }
       case 'c':
       {
+        if (strcmp(tag,"chunk-nonce") == 0)
+          {
+            content_info->chunk_nonce=IsWizardTrue(content);
+            break;
+          }
         if (strcmp(tag,"chunksize") == 0)
           {
             content_info->chunksize=(unsigned int) StringToUnsignedLong(content);
@@ -639,6 +1206,8 @@ WizardExport WizardBooleanType PrintCipherProperties(
   (void) fprintf(file,"    mode: %s\n",WizardOptionToMnemonic(WizardModeOptions,
     content_info->mode));
   (void) fprintf(file,"    nonce: %s\n",content_info->nonce);
+  (void) fprintf(file,"    chunk-nonce: %s\n",content_info->chunk_nonce !=
+    WizardFalse ? "true" : "false");
   (void) fprintf(file,"  Authenticate:\n");
   (void) fprintf(file,"    method: %s\n",WizardOptionToMnemonic(
     WizardAuthenticateOptions,content_info->authenticate_method));
@@ -668,7 +1237,302 @@ WizardExport WizardBooleanType PrintCipherProperties(
   (void) fprintf(file,"    timestamp: %s\n",timestamp);
   (void) fprintf(file,"  Protocol: %u.%u\n",(unsigned int)
     content_info->protocol_major,(unsigned int) content_info->protocol_minor);
+  (void) fprintf(file,"  Header: %s\n",content_info->header == BinaryHeader ?
+    "Binary" : "XML");
   if (content_info->version != (char *) NULL)
     (void) fprintf(file,"  Version: %s\n",content_info->version);
   return(ferror(file) != 0 ? WizardFalse : WizardTrue);
 }
+
+/*
+%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%
+%                                                                             %
+%                                                                             %
+%                                                                             %
+%   P u t C o n t e n t I n f o                                               %
+%                                                                             %
+%                                                                             %
+%                                                                             %
+%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%
+%
+%  PutContentInfo() writes the cipher header of the content to the specified
+%  blob in the XML or binary format, as defined by the header member of the
+%  content info.
+%
+%  The format of the PutContentInfo method is:
+%
+%      WizardBooleanType PutContentInfo(const ContentInfo *content_info,
+%        BLobInfo *cipher_blob,ExceptionInfo *exception)
+%
+%  A description of each parameter follows:
+%
+%    o content_info: the content info.
+%
+%    o cipher_blob: the cipher blob.
+%
+%    o exception: return any errors or warnings in this structure.
+%
+*/
+
+static StringInfo *AcquireBinaryContentHeader(const ContentInfo *content_info,
+  ExceptionInfo *exception)
+{
+  const char
+    *value;
+
+  StringInfo
+    *datum,
+    *header,
+    *records;
+
+  unsigned char
+    *q,
+    number[8];
+
+  WizardBooleanType
+    status;
+
+  records=AcquireStringInfo(0);
+  status=WizardTrue;
+  value=WizardOptionToMnemonic(WizardCipherOptions,content_info->cipher);
+  status&=ConcatenateHeaderRecord(records,CipherHeaderTag,strlen(value),
+    (const unsigned char *) value);
+  value=WizardOptionToMnemonic(WizardModeOptions,content_info->mode);
+  status&=ConcatenateHeaderRecord(records,ModeHeaderTag,strlen(value),
+    (const unsigned char *) value);
+  if (content_info->nonce != (char *) NULL)
+    {
+      datum=HexStringToStringInfo(content_info->nonce);
+      status&=ConcatenateHeaderRecord(records,NonceHeaderTag,
+        GetStringInfoLength(datum),GetStringInfoDatum(datum));
+      datum=DestroyStringInfo(datum);
+    }
+  if (content_info->chunk_nonce != WizardFalse)
+    {
+      number[0]=1;
+      status&=ConcatenateHeaderRecord(records,ChunkNonceHeaderTag,1,number);
+    }
+  value=WizardOptionToMnemonic(WizardAuthenticateOptions,
+    content_info->authenticate_method);
+  status&=ConcatenateHeaderRecord(records,AuthenticateHeaderTag,strlen(value),
+    (const unsigned char *) value);
+  if (content_info->id != (char *) NULL)
+    {
+      datum=HexStringToStringInfo(content_info->id);
+      status&=ConcatenateHeaderRecord(records,IdHeaderTag,
+        GetStringInfoLength(datum),GetStringInfoDatum(datum));
+      datum=DestroyStringInfo(datum);
+    }
+  value=WizardOptionToMnemonic(WizardHashOptions,content_info->key_hash);
+  status&=ConcatenateHeaderRecord(records,KeyHashHeaderTag,strlen(value),
+    (const unsigned char *) value);
+  SetHeaderValue((WizardSizeType) content_info->key_length,4,number);
+  status&=ConcatenateHeaderRecord(records,KeyLengthHeaderTag,4,number);
+  value=WizardOptionToMnemonic(WizardEntropyOptions,content_info->entropy);
+  status&=ConcatenateHeaderRecord(records,EntropyHeaderTag,strlen(value),
+    (const unsigned char *) value);
+  number[0]=(unsigned char) content_info->level;
+  status&=ConcatenateHeaderRecord(records,LevelHeaderTag,1,number);
+  value=WizardOptionToMnemonic(WizardHashOptions,content_info->hmac);
+  status&=ConcatenateHeaderRecord(records,HMACHeaderTag,strlen(value),
+    (const unsigned char *) value);
+  SetHeaderValue((WizardSizeType) content_info->chunksize,8,number);
+  status&=ConcatenateHeaderRecord(records,ChunksizeHeaderTag,8,number);
+  SetHeaderValue((WizardSizeType) content_info->modify_date,8,number);
+  status&=ConcatenateHeaderRecord(records,ModifyDateHeaderTag,8,number);
+  SetHeaderValue((WizardSizeType) content_info->create_date,8,number);
+  status&=ConcatenateHeaderRecord(records,CreateDateHeaderTag,8,number);
+  SetHeaderValue((WizardSizeType) content_info->timestamp,8,number);
+  status&=ConcatenateHeaderRecord(records,TimestampHeaderTag,8,number);
+  number[0]=(unsigned char) content_info->protocol_major;
+  number[1]=(unsigned char) content_info->protocol_minor;
+  status&=ConcatenateHeaderRecord(records,ProtocolHeaderTag,2,number);
+  if (content_info->version != (char *) NULL)
+    status&=ConcatenateHeaderRecord(records,VersionHeaderTag,strlen(
+      content_info->version),(const unsigned char *) content_info->version);
+  value=content_info->about;
+  if (value == (const char *) NULL)
+    value=content_info->content;
+  if (value != (const char *) NULL)
+    status&=ConcatenateHeaderRecord(records,AboutHeaderTag,strlen(value),
+      (const unsigned char *) value);
+  if (status == WizardFalse)
+    {
+      records=DestroyStringInfo(records);
+      (void) ThrowWizardException(exception,GetWizardModule(),OptionError,
+        "cipher property exceeds 65535 bytes: `%s'",content_info->content);
+      return((StringInfo *) NULL);
+    }
+  /*
+    Prefix the records with the magic, header version, length, and CRC.
+  */
+  header=AcquireStringInfo(CipherHeaderExtent);
+  q=GetStringInfoDatum(header);
+  (void) memcpy(q,CipherHeaderMagic,8);
+  q[8]=CipherHeaderMajor;
+  q[9]=CipherHeaderMinor;
+  q[10]=0;
+  q[11]=0;
+  SetHeaderValue((WizardSizeType) GetStringInfoLength(records),4,q+12);
+  SetHeaderValue(GetStringInfoCRC(records),8,q+16);
+  ConcatenateStringInfo(header,records);
+  records=DestroyStringInfo(records);
+  return(header);
+}
+
+static StringInfo *AcquireXMLContentHeader(const ContentInfo *content_info)
+{
+  char
+    *cipher_packet,
+    *cipher_rdf,
+    *digest,
+    message[WizardPathExtent],
+    timestamp[WizardPathExtent];
+
+  HashInfo
+    *hash_info;
+
+  size_t
+    length;
+
+  StringInfo
+    *header;
+
+  /*
+    Generate cipher RDF blob.
+  */
+  cipher_rdf=AcquireString("<rdf:RDF xmlns:rdf=\""
+    "http://www.w3.org/1999/02/22-rdf-syntax-ns#\"\n");
+  (void) ConcatenateString(&cipher_rdf,"         xmlns:cipher=\""
+     "http://www.wizards-toolkit.org/cipher/1.0/\">\n");
+  (void) ConcatenateString(&cipher_rdf,"  <cipher:Content rdf:about=\"");
+  if (content_info->about != (char *) NULL)
+    (void) ConcatenateString(&cipher_rdf,content_info->about);
+  else
+    if (content_info->content != (char *) NULL)
+      (void) ConcatenateString(&cipher_rdf,content_info->content);
+  (void) ConcatenateString(&cipher_rdf,"\">\n");
+  (void) FormatLocaleString(message,WizardPathExtent,
+    "    <cipher:type>%s</cipher:type>\n",WizardOptionToMnemonic(
+    WizardCipherOptions,content_info->cipher));
+  (void) ConcatenateString(&cipher_rdf,message);
+  (void) FormatLocaleString(message,WizardPathExtent,
+    "    <cipher:mode>%s</cipher:mode>\n",WizardOptionToMnemonic(
+    WizardModeOptions,content_info->mode));
+  (void) ConcatenateString(&cipher_rdf,message);
+  (void) FormatLocaleString(message,WizardPathExtent,
+    "    <cipher:nonce>%s</cipher:nonce>\n",content_info->nonce);
+  (void) ConcatenateString(&cipher_rdf,message);
+  if (content_info->chunk_nonce != WizardFalse)
+    (void) ConcatenateString(&cipher_rdf,
+      "    <cipher:chunk-nonce>true</cipher:chunk-nonce>\n");
+  (void) FormatLocaleString(message,WizardPathExtent,
+    "    <cipher:authenticate>%s</cipher:authenticate>\n",
+    WizardOptionToMnemonic(WizardAuthenticateOptions,
+    content_info->authenticate_method));
+  (void) ConcatenateString(&cipher_rdf,message);
+  (void) FormatLocaleString(message,WizardPathExtent,
+    "    <cipher:id>%s</cipher:id>\n",content_info->id);
+  (void) ConcatenateString(&cipher_rdf,message);
+  (void) FormatLocaleString(message,WizardPathExtent,
+    "    <cipher:key-hash>%s</cipher:key-hash>\n",WizardOptionToMnemonic(
+    WizardHashOptions,content_info->key_hash));
+  (void) ConcatenateString(&cipher_rdf,message);
+  (void) FormatLocaleString(message,WizardPathExtent,
+    "    <cipher:key-length>%u</cipher:key-length>\n",content_info->key_length);
+  (void) ConcatenateString(&cipher_rdf,message);
+  (void) FormatLocaleString(message,WizardPathExtent,
+    "    <cipher:entropy>%s</cipher:entropy>\n",WizardOptionToMnemonic(
+    WizardEntropyOptions,content_info->entropy));
+  (void) ConcatenateString(&cipher_rdf,message);
+  (void) FormatLocaleString(message,WizardPathExtent,
+    "    <cipher:level>%u</cipher:level>\n",content_info->level);
+  (void) ConcatenateString(&cipher_rdf,message);
+  (void) FormatLocaleString(message,WizardPathExtent,
+    "    <cipher:hmac>%s</cipher:hmac>\n",WizardOptionToMnemonic(
+    WizardHashOptions,content_info->hmac));
+  (void) ConcatenateString(&cipher_rdf,message);
+  (void) FormatLocaleString(message,WizardPathExtent,
+    "    <cipher:chunksize>%.20g</cipher:chunksize>\n",(double)
+    content_info->chunksize);
+  (void) ConcatenateString(&cipher_rdf,message);
+  (void) FormatWizardTime(content_info->modify_date,WizardPathExtent,timestamp);
+  (void) FormatLocaleString(message,WizardPathExtent,
+    "    <cipher:modify-date>%s</cipher:modify-date>\n",timestamp);
+  (void) ConcatenateString(&cipher_rdf,message);
+  (void) FormatWizardTime(content_info->create_date,WizardPathExtent,timestamp);
+  (void) FormatLocaleString(message,WizardPathExtent,
+    "    <cipher:create-date>%s</cipher:create-date>\n",timestamp);
+  (void) ConcatenateString(&cipher_rdf,message);
+  (void) FormatWizardTime(content_info->timestamp,WizardPathExtent,timestamp);
+  (void) FormatLocaleString(message,WizardPathExtent,
+    "    <cipher:timestamp>%s</cipher:timestamp>\n",timestamp);
+  (void) ConcatenateString(&cipher_rdf,message);
+  (void) FormatLocaleString(message,WizardPathExtent,
+    "    <cipher:protocol>%u.%u</cipher:protocol>\n",
+    content_info->protocol_major,content_info->protocol_minor);
+  (void) ConcatenateString(&cipher_rdf,message);
+  (void) FormatLocaleString(message,WizardPathExtent,
+    "    <cipher:version>%s</cipher:version>\n",content_info->version);
+  (void) ConcatenateString(&cipher_rdf,message);
+  (void) ConcatenateString(&cipher_rdf,"  </cipher:Content>\n");
+  (void) ConcatenateString(&cipher_rdf,"</rdf:RDF>\n");
+  /*
+    Wrap cipher RDF in a cipher-packet.
+  */
+  length=strlen(cipher_rdf);
+  hash_info=AcquireHashInfo(SHA2256Hash);
+  InitializeHash(hash_info);
+  header=StringToStringInfo(cipher_rdf);
+  UpdateHash(hash_info,header);
+  header=DestroyStringInfo(header);
+  FinalizeHash(hash_info);
+  digest=GetHashHexDigest(hash_info);
+  (void) FormatLocaleString(message,WizardPathExtent,
+    "<?cipherpacket digest=\"%s\" bytes=\"%u\"?>\n",digest,(unsigned int)
+    length);
+  digest=DestroyString(digest);
+  hash_info=DestroyHashInfo(hash_info);
+  cipher_packet=AcquireString(message);
+  (void) ConcatenateString(&cipher_packet,cipher_rdf);
+  cipher_rdf=DestroyString(cipher_rdf);
+  (void) ConcatenateString(&cipher_packet,"<?cipherpacket?>\f\n");
+  header=StringToStringInfo(cipher_packet);
+  cipher_packet=DestroyString(cipher_packet);
+  return(header);
+}
+
+WizardExport WizardBooleanType PutContentInfo(const ContentInfo *content_info,
+  BlobInfo *cipher_blob,ExceptionInfo *exception)
+{
+  ssize_t
+    count;
+
+  StringInfo
+    *header;
+
+  WizardAssert(CipherDomain,content_info != (const ContentInfo *) NULL);
+  WizardAssert(CipherDomain,content_info->signature == WizardSignature);
+  WizardAssert(CipherDomain,cipher_blob != (BlobInfo *) NULL);
+  WizardAssert(CipherDomain,exception != (ExceptionInfo *) NULL);
+  (void) LogWizardEvent(TraceEvent,GetWizardModule(),"%s",
+    GetBlobFilename(cipher_blob));
+  if (content_info->header == BinaryHeader)
+    header=AcquireBinaryContentHeader(content_info,exception);
+  else
+    header=AcquireXMLContentHeader(content_info);
+  if (header == (StringInfo *) NULL)
+    return(WizardFalse);
+  count=WriteBlob(cipher_blob,GetStringInfoLength(header),
+    GetStringInfoDatum(header));
+  if (count != (ssize_t) GetStringInfoLength(header))
+    {
+      header=DestroyStringInfo(header);
+      (void) ThrowWizardException(exception,GetWizardModule(),FileError,
+        "unable to write cipher properties `%s': `%s'",
+        GetBlobFilename(cipher_blob),strerror(errno));
+      return(WizardFalse);
+    }
+  header=DestroyStringInfo(header);
+  return(WizardTrue);
+}
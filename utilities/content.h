@@ -25,6 +25,13 @@ extern "C" {
 #define CipherProtocolMajor  1
 #define CipherProtocolMinor  0 
 
+typedef enum
+{
+  UndefinedHeader,
+  XMLHeader,
+  BinaryHeader
+} HeaderType;
+
 typedef struct _ContentInfo
 {
   BlobInfo
@@ -33,8 +40,12 @@ typedef struct _ContentInfo
 
   char
     *content,
+    *about,
     *properties;
 
+  HeaderType
+    header;
+
   CipherInfo
     *cipher_info;
 
@@ -47,6 +58,9 @@ typedef struct _ContentInfo
   char
     *nonce;
 
+  WizardBooleanType
+    chunk_nonce;
+
   AuthenticateInfo
     *authenticate_info;
 
@@ -86,7 +100,15 @@ typedef struct _ContentInfo
     random_hash;
 
   size_t
-    chunksize;
+    chunksize,
+    threads;
+
+  SyncType
+    sync;
+
+  WizardSizeType
+    extract_offset,
+    extract_length;
 
   time_t
     access_date,
@@ -105,13 +127,42 @@ typedef struct _ContentInfo
     signature;
 } ContentInfo;
 
+typedef struct _ChunkInfo
+{
+  StringInfo
+    *chunk,
+    *hmac;
+
+  CipherInfo
+    *cipher_info;
+
+  HMACInfo
+    *hmac_info;
+
+  EntropyInfo
+    *entropy_info;
+
+  EntropyType
+    entropy;
+
+  WizardBooleanType
+    padded,
+    status;
+} ChunkInfo;
+
+extern WizardExport ChunkInfo
+  **AcquireChunkInfoThreadSet(const ContentInfo *),
+  **DestroyChunkInfoThreadSet(ChunkInfo **);
+
 extern WizardExport ContentInfo
   *AcquireContentInfo(void),
+  *CloneContentInfo(const ContentInfo *),
   *DestroyContentInfo(ContentInfo *);
 
 extern WizardExport WizardBooleanType
   GetContentInfo(ContentInfo *,BlobInfo *,ExceptionInfo *),
-  PrintCipherProperties(const ContentInfo *,FILE *);
+  PrintCipherProperties(const ContentInfo *,FILE *),
+  PutContentInfo(const ContentInfo *,BlobInfo *,ExceptionInfo *);
 
 #if defined(__cplusplus) || defined(c_plusplus)
 }
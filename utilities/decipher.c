@@ -65,6 +65,8 @@
   Forward declaraction.
 */
 static WizardBooleanType
+  DecipherBatch(ContentInfo *,const char *,const WizardBooleanType,
+    const WizardBooleanType,ExceptionInfo *),
   DecipherContent(ContentInfo *,const char *,const char *,
     const WizardBooleanType,ExceptionInfo *);
 
@@ -73,6 +75,151 @@ static WizardBooleanType
 %                                                                             %
 %                                                                             %
 %                                                                             %
+%   D e c i p h e r B a t c h                                                 %
+%                                                                             %
+%                                                                             %
+%                                                                             %
+%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%
+%
+%  DecipherBatch() deciphers each ciphertext plaintext pair listed in a batch
+%  manifest.  The contents are deciphered in parallel, one per thread, and
+%  the status of each is reported as it completes.  The first key that
+%  authenticates is kept and reused by every content with the same key id,
+%  so a batch enciphered with a shared key is authenticated only once per
+%  thread rather than once per content.
+%
+%  The format of the DecipherBatch method is:
+%
+%      WizardBooleanType DecipherBatch(ContentInfo *content_info,
+%        const char *batch_filename,const WizardBooleanType compress,
+%        const WizardBooleanType verbose,ExceptionInfo *exception)
+%
+%  A description of each parameter follows:
+%
+%    o content_info: the cipher options.
+%
+%    o batch_filename: the batch manifest filename.
+%
+%    o compress: automagically (de)compress BZIP and ZIP files.
+%
+%    o verbose: print detailed information about each content.
+%
+%    o exception: return any exceptions in this structure.
+%
+*/
+static WizardBooleanType DecipherBatch(ContentInfo *content_info,
+  const char *batch_filename,const WizardBooleanType compress,
+  const WizardBooleanType verbose,ExceptionInfo *exception)
+{
+  char
+    **filenames,
+    *manifest;
+
+  int
+    number_filenames;
+
+  register ssize_t
+    i;
+
+  size_t
+    failures;
+
+  WizardBooleanType
+    status;
+
+  /*
+    The batch manifest lists whitespace separated ciphertext plaintext pairs.
+  */
+  if (content_info->properties != (char *) NULL)
+    {
+      (void) ThrowWizardException(exception,GetWizardModule(),OptionError,
+        "cipher properties are not supported in batch mode: `%s'",
+        content_info->properties);
+      return(WizardFalse);
+    }
+  manifest=FileToString(batch_filename,~0UL,exception);
+  if (manifest == (char *) NULL)
+    return(WizardFalse);
+  filenames=StringToArgv(manifest,&number_filenames);
+  manifest=DestroyString(manifest);
+  if (filenames == (char **) NULL)
+    return(WizardFalse);
+  failures=0;
+  status=WizardTrue;
+  if ((number_filenames % 2) != 0)
+    {
+      (void) ThrowWizardException(exception,GetWizardModule(),OptionError,
+        "ciphertext without a plaintext in batch manifest: `%s'",
+        filenames[number_filenames-1]);
+      status=WizardFalse;
+    }
+  if (status != WizardFalse)
+    {
+#if defined(WIZARDSTOOLKIT_HAVE_OPENMP)
+      #pragma omp parallel for schedule(dynamic,1) \
+        num_threads(content_info->threads)
+#endif
+      for (i=0; i < (ssize_t) number_filenames; i+=2)
+      {
+        ContentInfo
+          *batch_info;
+
+        ExceptionInfo
+          *batch_exception;
+
+        WizardBooleanType
+          batch_status;
+
+        batch_info=CloneContentInfo(content_info);
+        batch_info->threads=1;
+        batch_info->content=ConstantString(filenames[i]);
+#if defined(WIZARDSTOOLKIT_HAVE_OPENMP)
+        #pragma omp critical (WizardsToolkit_DecipherBatch)
+#endif
+        batch_info->authenticate_info=content_info->authenticate_info;
+        batch_exception=AcquireExceptionInfo();
+        batch_status=DecipherContent(batch_info,filenames[i],filenames[i+1],
+          compress,batch_exception);
+#if defined(WIZARDSTOOLKIT_HAVE_OPENMP)
+        #pragma omp critical (WizardsToolkit_DecipherBatch)
+#endif
+        {
+          if ((batch_status != WizardFalse) &&
+              (content_info->authenticate_info == (AuthenticateInfo *) NULL))
+            content_info->authenticate_info=batch_info->authenticate_info;
+          if (batch_info->authenticate_info == content_info->authenticate_info)
+            batch_info->authenticate_info=(AuthenticateInfo *) NULL;
+          if (batch_status == WizardFalse)
+            failures++;
+          (void) fprintf(stdout,"%s: %s\n",filenames[i],batch_status !=
+            WizardFalse ? "ok" : "failed");
+          if ((batch_status != WizardFalse) && (verbose != WizardFalse))
+            (void) PrintCipherProperties(batch_info,stdout);
+          (void) fflush(stdout);
+          CatchException(batch_exception);
+        }
+        batch_exception=DestroyExceptionInfo(batch_exception);
+        batch_info=DestroyContentInfo(batch_info);
+      }
+      if (failures != 0)
+        {
+          (void) ThrowWizardException(exception,GetWizardModule(),FileError,
+            "unable to decipher %.20g of %.20g batch contents: `%s'",(double)
+            failures,(double) (number_filenames/2),batch_filename);
+          status=WizardFalse;
+        }
+    }
+  for (i=0; i < (ssize_t) number_filenames; i++)
+    filenames[i]=DestroyString(filenames[i]);
+  filenames=(char **) RelinquishWizardMemory(filenames);
+  return(status);
+}
+
+/*
+%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%
+%                                                                             %
+%                                                                             %
+%                                                                             %
 +   D e c i p h e r C o m m a n d                                             %
 %                                                                             %
 %                                                                             %
@@ -102,11 +249,14 @@ static void DecipherUsage(void)
     *options[]=
     {
       "-authenticate method authenticate with this method: Secret or Public",
+      "-batch filename      decipher each ciphertext plaintext pair in this file",
+      "-chunk-nonce         derive an independent nonce for each chunk",
       "-chunksize bytes     number of bytes in a chunk",
       "-cipher type         cipher to decipher content",
       "-(de)compress        automagically (de)compress BZIP and ZIP files",
       "-debug events        display copious debugging information",
       "-entropy type        increase content entropy",
+      "-extract offset,len  decipher only this range of the plaintext",
       "-help                print program options",
       "-hmac hash           ensure message integrity with this hash",
       "-key hash            strengthen the key with this hash",
@@ -119,6 +269,8 @@ static void DecipherUsage(void)
       "-passphrase filename get the passphrase from this file",
       "-properties filename get cipher properties from this file",
       "-random hash         strengthen random data with this hash",
+      "-sync policy         sync output: Never, Chunk, or End (the default)",
+      "-threads value       number of threads to process chunks in parallel",
       "-true-random         strengthen deciphering with true random numbers",
       "-verbose             print detailed information about the secure content",
       "-version             print version information",
@@ -133,6 +285,8 @@ static void DecipherUsage(void)
   (void) fprintf(stdout,"Copyright: %s\n\n",GetWizardCopyright());
   (void) fprintf(stdout,"Usage: %s [options ...] ciphertext "
     "plaintext\n",GetClientName());
+  (void) fprintf(stdout,"       %s [options ...] -batch filename\n",
+    GetClientName());
   (void) fprintf(stdout,"\nWhere options include:\n");
   for (p=options; *p != (char *) NULL; p++)
     (void) fprintf(stdout,"  %s\n",*p);
@@ -165,6 +319,7 @@ WizardExport WizardBooleanType DecipherCommand(int argc,char **argv,
 }
 
   const char
+    *batch_filename,
     *cipher_filename,
     *option,
     *plain_filename;
@@ -205,6 +360,7 @@ WizardExport WizardBooleanType DecipherCommand(int argc,char **argv,
   if (status == WizardFalse)
     ThrowCipherException(ResourceError,"memory allocation failed: `%s'",
       strerror(errno));
+  batch_filename=(const char *) NULL;
   plain_filename=(const char *) NULL;
   cipher_filename=(const char *) NULL;
   verbose=WizardFalse;
@@ -264,8 +420,34 @@ WizardExport WizardBooleanType DecipherCommand(int argc,char **argv,
           option);
         break;
       }
+      case 'b':
+      {
+        if (LocaleCompare("batch",option+1) == 0)
+          {
+            if (*option == '+')
+              {
+                batch_filename=(const char *) NULL;
+                break;
+              }
+            i++;
+            if (i == (ssize_t) argc)
+              ThrowCipherException(OptionError,"missing batch filename: `%s'",
+                option);
+            batch_filename=argv[i];
+            break;
+          }
+        ThrowCipherException(OptionFatalError,"unrecognized option: `%s'",
+          option);
+        break;
+      }
       case 'c':
       {
+        if (LocaleCompare("chunk-nonce",option+1) == 0)
+          {
+            content_info->chunk_nonce=(*option == '-') ? WizardTrue :
+              WizardFalse;
+            break;
+          }
         if (LocaleCompare("cipher",option+1) == 0)
           {
             if (*option == '+')
@@ -345,6 +527,36 @@ WizardExport WizardBooleanType DecipherCommand(int argc,char **argv,
             content_info->entropy=(EntropyType) type;
             break;
           }
+        if (LocaleCompare(option,"-extract") == 0)
+          {
+            char
+              *p,
+              *q;
+
+            double
+              extent,
+              offset;
+
+            if (*option == '+')
+              {
+                content_info->extract_offset=0;
+                content_info->extract_length=0;
+                break;
+              }
+            i++;
+            if (i == (ssize_t) argc)
+              ThrowCipherException(OptionError,"missing offset,length: `%s'",
+                option);
+            offset=InterpretSiPrefixValue(argv[i],&p);
+            if ((p == argv[i]) || (*p != ',') || (offset < 0.0))
+              ThrowInvalidArgumentException(option,argv[i]);
+            extent=InterpretSiPrefixValue(p+1,&q);
+            if ((q == (p+1)) || (extent < 1.0))
+              ThrowInvalidArgumentException(option,argv[i]);
+            content_info->extract_offset=(WizardSizeType) offset;
+            content_info->extract_length=(WizardSizeType) extent;
+            break;
+          }
         ThrowCipherException(OptionFatalError,"unrecognized option: `%s'",
           option);
         break;
@@ -532,8 +744,52 @@ WizardExport WizardBooleanType DecipherCommand(int argc,char **argv,
           option);
         break;
       }
+      case 's':
+      {
+        if (LocaleCompare("sync",option+1) == 0)
+          {
+            ssize_t
+              type;
+
+            if (*option == '+')
+              break;
+            i++;
+            if (i == (ssize_t) argc)
+              ThrowCipherException(OptionError,"missing sync policy: `%s'",
+                option);
+            type=ParseWizardOption(WizardSyncOptions,WizardFalse,argv[i]);
+            if (type < 0)
+              ThrowCipherException(OptionFatalError,"unrecognized sync "
+                "policy: `%s'",argv[i]);
+            content_info->sync=(SyncType) type;
+            break;
+          }
+        ThrowCipherException(OptionFatalError,"unrecognized option: `%s'",
+          option);
+        break;
+      }
       case 't':
       {
+        if (LocaleCompare(option,"-threads") == 0)
+          {
+            char
+              *p;
+
+            double
+              value;
+
+            if (*option == '+')
+              break;
+            i++;
+            if (i == (ssize_t) argc)
+              ThrowCipherException(OptionError,"missing threads: `%s'",
+                option);
+            value=StringToDouble(argv[i],&p);
+            if ((p == argv[i]) || (value < 1.0))
+              ThrowInvalidArgumentException(option,argv[i]);
+            content_info->threads=(size_t) value;
+            break;
+          }
         if (LocaleCompare(option+1,"true-random") == 0)
           {
             SetRandomTrueRandom(*option == '-' ? WizardTrue : WizardFalse);
@@ -572,6 +828,15 @@ WizardExport WizardBooleanType DecipherCommand(int argc,char **argv,
   /*
     Decipher content.
   */
+  if (batch_filename != (const char *) NULL)
+    {
+      if (plain_filename != (char *) NULL)
+        DecipherUsage();
+      status=DecipherBatch(content_info,batch_filename,compress,verbose,
+        exception);
+      DestroyCipher();
+      return(status);
+    }
   if ((plain_filename == (char *) NULL) ||
       (cipher_filename == (char *) NULL))
     DecipherUsage();
@@ -627,14 +892,22 @@ static WizardBooleanType DecipherContent(ContentInfo *content_info,
 { \
   (void) ThrowWizardException(exception,GetWizardModule(),asperity, \
     tag,context,strerror(errno)); \
+  if (chunk_info != (ChunkInfo **) NULL) \
+    chunk_info=DestroyChunkInfoThreadSet(chunk_info); \
   return(WizardFalse); \
 }
 
   char
     message[WizardPathExtent];
 
-  EntropyType
-    entropy;
+  ChunkInfo
+    **chunk_info;
+
+  const StringInfo
+    *nonce;
+
+  register ssize_t
+    i;
 
   size_t
     blocksize,
@@ -649,12 +922,19 @@ static WizardBooleanType DecipherContent(ContentInfo *content_info,
     *hmac,
     *plaintext;
 
+  unsigned char
+    *datum;
+
   size_t
-    chunk;
+    chunk,
+    chunks,
+    first,
+    last;
 
   WizardBooleanType
     status;
 
+  chunk_info=(ChunkInfo **) NULL;
   /*
     Open plaintext and ciphertext content files.
   */
@@ -666,6 +946,8 @@ static WizardBooleanType DecipherContent(ContentInfo *content_info,
     exception);
   if (content_info->plainblob == (BlobInfo *) NULL)
     return(WizardFalse);
+  SetBlobSynchronize(content_info->plainblob,content_info->sync == EndSync ?
+    WizardTrue : WizardFalse);
   /*
     Decipher plaintext.
   */
@@ -690,30 +972,48 @@ static WizardBooleanType DecipherContent(ContentInfo *content_info,
     }
   if (status == WizardFalse)
     return(WizardFalse);
-  content_info->authenticate_info=AcquireAuthenticateInfo(
-    content_info->authenticate_method,content_info->keyring,
-    content_info->key_hash);
-  SetAuthenticateKeyLength(content_info->authenticate_info,
-    content_info->key_length);
-  if (content_info->id != (char *) NULL)
+  if (content_info->authenticate_info != (AuthenticateInfo *) NULL)
     {
-      StringInfo
+      char
         *id;
 
       /*
-        Set key id.
+        A batch key is only shared by contents with the same key id.
       */
-      id=HexStringToStringInfo(content_info->id);
-      SetAuthenticateId(content_info->authenticate_info,id);
-      id=DestroyStringInfo(id);
+      id=StringInfoToHexString(GetAuthenticateId(
+        content_info->authenticate_info));
+      if ((content_info->id == (char *) NULL) ||
+          (LocaleCompare(id,content_info->id) != 0))
+        content_info->authenticate_info=(AuthenticateInfo *) NULL;
+      id=DestroyString(id);
+    }
+  if (content_info->authenticate_info == (AuthenticateInfo *) NULL)
+    {
+      content_info->authenticate_info=AcquireAuthenticateInfo(
+        content_info->authenticate_method,content_info->keyring,
+        content_info->key_hash);
+      SetAuthenticateKeyLength(content_info->authenticate_info,
+        content_info->key_length);
+      if (content_info->id != (char *) NULL)
+        {
+          StringInfo
+            *id;
+
+          /*
+            Set key id.
+          */
+          id=HexStringToStringInfo(content_info->id);
+          SetAuthenticateId(content_info->authenticate_info,id);
+          id=DestroyStringInfo(id);
+        }
+      if (content_info->passphrase != (char *) NULL)
+        SetAuthenticatePassphrase(content_info->authenticate_info,
+          content_info->passphrase);
+      status=AuthenticateKey(content_info->authenticate_info,exception);
+      if (status == WizardFalse)
+        ThrowDecipherContentException(ResourceError,"authentication failed: "
+          "`%s': `%s'",cipher_filename);
     }
-  if (content_info->passphrase != (char *) NULL)
-    SetAuthenticatePassphrase(content_info->authenticate_info,
-      content_info->passphrase);
-  status=AuthenticateKey(content_info->authenticate_info,exception);
-  if (status == WizardFalse)
-    ThrowDecipherContentException(ResourceError,"authentication failed: `%s': "
-      "`%s'",cipher_filename);
   content_info->cipher_info=AcquireCipherInfo(content_info->cipher,
     content_info->mode);
   SetCipherKey(content_info->cipher_info,GetAuthenticateKey(
@@ -721,82 +1021,175 @@ static WizardBooleanType DecipherContent(ContentInfo *content_info,
   if (content_info->nonce != (char *) NULL)
     {
       StringInfo
-        *nonce;
+        *value;
 
       /*
         Set cipher nonce.
       */
-      nonce=HexStringToStringInfo(content_info->nonce);
-      SetCipherNonce(content_info->cipher_info,nonce);
-      nonce=DestroyStringInfo(nonce);
-    }
-  hmac=(StringInfo *) NULL;
-  if (content_info->hmac != NoHash)
-    {
-      content_info->hmac_info=AcquireHMACInfo(content_info->hmac);
-      hmac=AcquireStringInfo(GetHMACDigestsize(content_info->hmac_info));
+      value=HexStringToStringInfo(content_info->nonce);
+      SetCipherNonce(content_info->cipher_info,value);
+      value=DestroyStringInfo(value);
     }
-  entropy=content_info->entropy;
-  if (content_info->entropy != NoEntropy)
-    content_info->entropy_info=AcquireEntropyInfo(content_info->entropy,
-      content_info->level);
+  nonce=GetCipherNonce(content_info->cipher_info);
+  chunk_info=AcquireChunkInfoThreadSet(content_info);
   blocksize=GetCipherBlocksize(content_info->cipher_info);
   pad=blocksize-content_info->chunksize % blocksize;
   if (pad == blocksize)
     pad=0;
-  ciphertext=AcquireStringInfo(content_info->chunksize);
-  for (chunk=0; ; chunk++)
+  first=0;
+  last=0;
+  if (content_info->extract_length != 0)
+    {
+      WizardOffsetType
+        offset;
+
+      /*
+        Every chunk record but the last is the same size, so seek directly to
+        the first chunk of the extract range.  If the ciphertext is not
+        seekable, decipher from the start and discard the chunks outside it.
+      */
+      length=content_info->chunksize;
+      if (content_info->mode != CFBMode)
+        length+=pad;
+      if (content_info->hmac != NoHash)
+        length+=GetStringInfoLength(chunk_info[0]->hmac);
+      if (content_info->entropy != NoEntropy)
+        length++;
+      first=(size_t) (content_info->extract_offset/content_info->chunksize);
+      last=(size_t) ((content_info->extract_offset+
+        content_info->extract_length-1)/content_info->chunksize);
+      offset=TellBlob(content_info->cipherblob);
+      if ((offset < 0) || (SeekBlob(content_info->cipherblob,offset+
+           (WizardOffsetType) first*length,SEEK_SET) < 0))
+        first=0;
+    }
+  for (chunk=first; ; chunk+=chunks)
   {
-    if (content_info->hmac != NoHash)
-      {
-        length=GetStringInfoLength(hmac);
-        count=ReadBlobChunk(content_info->cipherblob,length,GetStringInfoDatum(
-          hmac));
-        if (count <= 0)
-          break;
-      }
-    if (content_info->entropy != NoEntropy)
-      entropy=(EntropyType) ReadBlobByte(content_info->cipherblob);
-    length=content_info->chunksize;
-    if (content_info->mode != CFBMode)
-      length+=pad;
-    SetStringInfoLength(ciphertext,length);
-    count=ReadBlobChunk(content_info->cipherblob,length,GetStringInfoDatum(
-      ciphertext));
-    if (count <= 0)
+    /*
+      Read and decipher a chunk for each thread.
+    */
+    for (chunks=0; chunk_info[chunks] != (ChunkInfo *) NULL; chunks++)
+    {
+      if ((content_info->extract_length != 0) && ((chunk+chunks) > last))
+        break;
+      if (content_info->hmac != NoHash)
+        {
+          hmac=chunk_info[chunks]->hmac;
+          count=ReadBlobChunk(content_info->cipherblob,GetStringInfoLength(
+            hmac),GetStringInfoDatum(hmac));
+          if (count <= 0)
+            break;
+        }
+      chunk_info[chunks]->entropy=content_info->entropy;
+      if (content_info->entropy != NoEntropy)
+        chunk_info[chunks]->entropy=(EntropyType) ReadBlobByte(
+          content_info->cipherblob);
+      ciphertext=chunk_info[chunks]->chunk;
+      length=content_info->chunksize;
+      if (content_info->mode != CFBMode)
+        length+=pad;
+      SetStringInfoLength(ciphertext,length);
+      count=ReadBlobChunk(content_info->cipherblob,length,GetStringInfoDatum(
+        ciphertext));
+      if (count <= 0)
+        break;
+      SetStringInfoLength(ciphertext,(size_t) count);
+      chunk_info[chunks]->padded=(content_info->mode != CFBMode) &&
+        ((pad != 0) || (EOFBlob(content_info->cipherblob) != WizardFalse)) ?
+        WizardTrue : WizardFalse;
+    }
+    if (chunks == 0)
+      break;
+    /*
+      Decipher, restore the entropy of, and authenticate the chunks in
+      parallel.
+    */
+#if defined(WIZARDSTOOLKIT_HAVE_OPENMP)
+    #pragma omp parallel for schedule(static,1) num_threads(chunks)
+#endif
+    for (i=0; i < (ssize_t) chunks; i++)
+    {
+      ChunkInfo
+        *info;
+
+      size_t
+        extent;
+
+      info=chunk_info[i];
+      info->status=WizardTrue;
+      if (content_info->chunk_nonce != WizardFalse)
+        SetCipherChunkNonce(info->cipher_info,nonce,(WizardSizeType)
+          (chunk+i),content_info->chunksize);
+      else
+        SetCipherNonce(info->cipher_info,nonce);
+      (void) DecipherCipher(info->cipher_info,info->chunk);
+      extent=GetStringInfoLength(info->chunk);
+      if (info->padded != WizardFalse)
+        extent-=GetStringInfoDatum(info->chunk)[extent-1]+1;
+      SetStringInfoLength(info->chunk,extent);
+      if (info->entropy != NoEntropy)
+        {
+          info->status=RestoreEntropy(info->entropy_info,GetStringInfoLength(
+            info->chunk),info->chunk,exception);
+          if (info->status == WizardFalse)
+            continue;
+          SetStringInfo(info->chunk,GetEntropyChaos(info->entropy_info));
+        }
+      if (content_info->hmac != NoHash)
+        ConstructHMAC(info->hmac_info,GetAuthenticateKey(
+          content_info->authenticate_info),info->chunk);
+    }
+    /*
+      Write the chunks in order.
+    */
+    for (i=0; i < (ssize_t) chunks; i++)
+    {
+      if (chunk_info[i]->status == WizardFalse)
+        ThrowDecipherContentException(FileError,"unable to restore entropy "
+          "`%s': `%s'",cipher_filename);
+      if ((content_info->hmac != NoHash) &&
+          (CompareStringInfo(chunk_info[i]->hmac,GetHMACDigest(
+           chunk_info[i]->hmac_info)) != 0))
+        {
+          (void) FormatLocaleString(message,WizardPathExtent,"corrupt cipher "
+            "chunk #%.20g `%s'",(double) (chunk+i),cipher_filename);
+          ThrowDecipherContentException(FileError,"%s: `%s'",message);
+        }
+      plaintext=chunk_info[i]->chunk;
+      datum=GetStringInfoDatum(plaintext);
+      length=GetStringInfoLength(plaintext);
+      if (content_info->extract_length != 0)
+        {
+          WizardSizeType
+            extent,
+            offset;
+
+          /*
+            Write only the part of the chunk within the extract range.
+          */
+          offset=(WizardSizeType) (chunk+i)*content_info->chunksize;
+          extent=content_info->extract_offset+content_info->extract_length;
+          if (extent > (offset+length))
+            extent=offset+length;
+          if (offset < content_info->extract_offset)
+            {
+              datum+=content_info->extract_offset < (offset+length) ?
+                content_info->extract_offset-offset : length;
+              offset=content_info->extract_offset;
+            }
+          length=extent > offset ? (size_t) (extent-offset) : 0;
+        }
+      count=WriteBlobChunk(content_info->plainblob,length,datum);
+      if (count != (ssize_t) length)
+        ThrowDecipherContentException(FileError,"unable to write plaintext "
+          "`%s': `%s'",cipher_filename);
+      if ((content_info->sync == ChunkSync) &&
+          (SyncBlob(content_info->plainblob) != WizardFalse))
+        ThrowDecipherContentException(FileError,"unable to sync plaintext "
+          "`%s': `%s'",plain_filename);
+    }
+    if (chunk_info[chunks] != (ChunkInfo *) NULL)
       break;
-    length=(size_t) count;
-    SetStringInfoLength(ciphertext,length);
-    plaintext=DecipherCipher(content_info->cipher_info,ciphertext);
-    if ((content_info->mode != CFBMode) &&
-        ((pad != 0) || (EOFBlob(content_info->cipherblob) != WizardFalse)))
-      length-=GetStringInfoDatum(plaintext)[length-1]+1;
-    SetStringInfoLength(plaintext,length);
-    if (entropy != NoEntropy)
-      {
-        status=RestoreEntropy(content_info->entropy_info,length,plaintext,
-          exception);
-        if (status == WizardFalse)
-          ThrowDecipherContentException(FileError,"unable to restore entropy "
-            "`%s': `%s'",cipher_filename);
-        SetStringInfo(plaintext,GetEntropyChaos(content_info->entropy_info));
-      }
-    if (content_info->hmac != NoHash)
-      {
-        ConstructHMAC(content_info->hmac_info,GetAuthenticateKey(
-          content_info->authenticate_info),plaintext);
-        if (CompareStringInfo(hmac,GetHMACDigest(content_info->hmac_info)) != 0)
-          {
-            (void) FormatLocaleString(message,WizardPathExtent,"corrupt cipher "
-              "chunk #%.20g `%s'",(double) chunk,cipher_filename);
-            ThrowDecipherContentException(FileError,"%s: `%s'",message);
-          }
-      }
-    count=WriteBlobChunk(content_info->plainblob,length,GetStringInfoDatum(
-      plaintext));
-    if (count != (ssize_t) length)
-      ThrowDecipherContentException(FileError,"unable to write plaintext "
-        "`%s': `%s'",cipher_filename);
   }
   if (CloseBlob(content_info->cipherblob) != WizardFalse)
     ThrowFileException(exception,FileError,content_info->content);
@@ -813,9 +1206,7 @@ static WizardBooleanType DecipherContent(ContentInfo *content_info,
       ThrowFileException(exception,FileError,plain_filename);
   }
 #endif
-  ciphertext=DestroyStringInfo(ciphertext);
-  if (content_info->hmac != NoHash)
-    hmac=DestroyStringInfo(hmac);
+  chunk_info=DestroyChunkInfoThreadSet(chunk_info);
   return(WizardTrue);
 }
 
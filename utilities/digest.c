@@ -54,6 +54,96 @@
 #endif
 #include "content.h"
 #include "utility_.h"
+
+/*
+  Define declarations.
+*/
+#define DigestCacheMagick  "WizardsToolkitDigestCache"
+#define DigestCacheFilename  "digest.cache"
+#define NumberDigestHashes  ((size_t) SHA3512Hash+1)
+
+/*
+  Typedef declarations.
+*/
+typedef struct _DigestCache
+{
+  FileInfo
+    *file_info;
+
+  HashmapInfo
+    *entries;
+
+  WizardSizeType
+    expiry;
+} DigestCache;
+
+typedef struct _DigestEntry
+{
+  char
+    *path,
+    *create_date,
+    *modify_date,
+    *timestamp,
+    *digests[NumberDigestHashes],
+    *message;
+
+  ExceptionInfo
+    *exception;
+} DigestEntry;
+
+typedef struct _DigestQueue
+{
+  BlobInfo
+    *digest_blob;
+
+  char
+    **filenames,
+    **digest_rdf;
+
+  const char
+    *hash,
+    **hashes;
+
+  DigestCache
+    *cache;
+
+  ExceptionInfo
+    **exceptions,
+    *exception;
+
+  size_t
+    extent,
+    number_contents,
+    threads;
+} DigestQueue;
+
+typedef struct _DigestReader
+{
+  BlobInfo
+    *blob;
+
+  unsigned char
+    buffer[WizardMaxBufferExtent],
+    *next,
+    *end;
+} DigestReader;
+
+typedef struct _DigestCacheEntry
+{
+  WizardSizeType
+    device,
+    inode,
+    extent,
+    modify_time,
+    change_time,
+    timestamp;
+
+  HashType
+    hash;
+
+  char
+    *digest;
+} DigestCacheEntry;
 
 /*
 %%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%
@@ -90,10 +180,16 @@ static void DigestUsage()
     *options[]=
     {
       "-authenticate        read message digests from a file and authenticate them",
+      "-cache filename      reuse the message digests of unchanged content",
       "-debug events        display copious debugging information",
-      "-hash type           compute the message digest with this hash",
+      "-exclude pattern     skip files and directories that match this pattern",
+      "-hash type,...       compute the message digest with these hashes",
       "-help                print program options",
+      "-include pattern     only digest files that match this pattern",
       "-list type           print a list of supported option arguments",
+      "-recursive           digest the files below each directory",
+      "-rehash-older-than value  rehash cached digests older than value seconds",
+      "-threads value       number of threads to compute or verify message digests",
       "-version             print version information",
       (char *) NULL
     };
@@ -114,6 +210,456 @@ static void DigestUsage()
   Exit(0);
 }
 
+static char *GetDigestCacheKey(const DigestCacheEntry *entry)
+{
+  char
+    key[WizardPathExtent];
+
+  /*
+    One entry per file and hash, so a changed file replaces its entry.
+  */
+  (void) FormatLocaleString(key,WizardPathExtent,"%.20g:%.20g:%d",(double)
+    entry->device,(double) entry->inode,(int) entry->hash);
+  return(ConstantString(key));
+}
+
+static void GetDigestCacheProperties(const struct stat *properties,
+  DigestCacheEntry *entry)
+{
+  entry->device=(WizardSizeType) properties->st_dev;
+  entry->inode=(WizardSizeType) properties->st_ino;
+  entry->extent=(WizardSizeType) properties->st_size;
+  entry->modify_time=1000000000*(WizardSizeType) properties->st_mtime;
+  entry->change_time=1000000000*(WizardSizeType) properties->st_ctime;
+#if defined(st_mtime) && !defined(__APPLE__)
+  /*
+    Nanosecond timestamps (POSIX.1-2008).
+  */
+  entry->modify_time+=(WizardSizeType) properties->st_mtim.tv_nsec;
+  entry->change_time+=(WizardSizeType) properties->st_ctim.tv_nsec;
+#endif
+}
+
+static void *RelinquishDigestCacheEntry(void *cache_entry)
+{
+  DigestCacheEntry
+    *entry;
+
+  entry=(DigestCacheEntry *) cache_entry;
+  if (entry->digest != (char *) NULL)
+    entry->digest=DestroyString(entry->digest);
+  return(RelinquishWizardMemory(entry));
+}
+
+static WizardBooleanType PutDigestCacheEntry(DigestCache *cache,
+  const DigestCacheEntry *cache_entry)
+{
+  char
+    *key;
+
+  DigestCacheEntry
+    *entry;
+
+  entry=(DigestCacheEntry *) AcquireWizardMemory(sizeof(*entry));
+  if (entry == (DigestCacheEntry *) NULL)
+    return(WizardFalse);
+  *entry=(*cache_entry);
+  entry->digest=ConstantString(cache_entry->digest);
+  key=GetDigestCacheKey(entry);
+  return(PutEntryInHashmap(cache->entries,key,entry));
+}
+
+static DigestCache *AcquireDigestCache(const char *path,
+  const WizardSizeType expiry,ExceptionInfo *exception)
+{
+  char
+    magick[sizeof(DigestCacheMagick)-1];
+
+  DigestCache
+    *cache;
+
+  DigestCacheEntry
+    entry;
+
+  size_t
+    length,
+    signature;
+
+  unsigned short
+    hash;
+
+  WizardBooleanType
+    status;
+
+  /*
+    Lock the digest cache for the duration of the command and read it.
+  */
+  cache=(DigestCache *) AcquireWizardMemory(sizeof(*cache));
+  if (cache == (DigestCache *) NULL)
+    ThrowWizardFatalError(HashDomain,MemoryError);
+  (void) ResetWizardMemory(cache,0,sizeof(*cache));
+  cache->expiry=expiry;
+  cache->entries=NewHashmap(LargeHashmapSize,HashStringType,
+    CompareHashmapString,RelinquishWizardMemory,RelinquishDigestCacheEntry);
+  cache->file_info=AcquireFileInfo(path,DigestCacheFilename,WriteFileMode,
+    exception);
+  if (cache->file_info == (FileInfo *) NULL)
+    {
+      (void) ThrowWizardException(exception,GetWizardModule(),FileError,
+        "unable to open digest cache `%s'",path);
+      cache->entries=DestroyHashmap(cache->entries);
+      return((DigestCache *) RelinquishWizardMemory(cache));
+    }
+  if (GetFileProperties(cache->file_info)->st_size == 0)
+    return(cache);
+  status=ReadFileChunk(cache->file_info,magick,sizeof(magick));
+  if ((status == WizardFalse) ||
+      (memcmp(magick,DigestCacheMagick,sizeof(magick)) != 0))
+    {
+      (void) ThrowWizardException(exception,GetWizardModule(),FileError,
+        "corrupt digest cache `%s'",path);
+      cache->file_info=DestroyFileInfo(cache->file_info,exception);
+      cache->entries=DestroyHashmap(cache->entries);
+      return((DigestCache *) RelinquishWizardMemory(cache));
+    }
+  while (ReadFile32Bits(cache->file_info,&signature) != WizardFalse)
+  {
+    if (signature != WizardSignature)
+      break;
+    status=ReadFile64Bits(cache->file_info,&entry.device);
+    status&=ReadFile64Bits(cache->file_info,&entry.inode);
+    status&=ReadFile64Bits(cache->file_info,&entry.extent);
+    status&=ReadFile64Bits(cache->file_info,&entry.modify_time);
+    status&=ReadFile64Bits(cache->file_info,&entry.change_time);
+    status&=ReadFile64Bits(cache->file_info,&entry.timestamp);
+    status&=ReadFile16Bits(cache->file_info,&hash);
+    status&=ReadFile32Bits(cache->file_info,&length);
+    if ((status == WizardFalse) || (length >= WizardPathExtent))
+      break;
+    entry.hash=(HashType) hash;
+    entry.digest=AcquireString((char *) NULL);
+    status=ReadFileChunk(cache->file_info,entry.digest,length);
+    entry.digest[length]='\0';
+    if (status != WizardFalse)
+      status=PutDigestCacheEntry(cache,&entry);
+    entry.digest=DestroyString(entry.digest);
+    if (status == WizardFalse)
+      break;
+  }
+  return(cache);
+}
+
+static WizardBooleanType CloseDigestCache(DigestCache *cache,
+  ExceptionInfo *exception)
+{
+  const DigestCacheEntry
+    *entry;
+
+  int
+    file;
+
+  size_t
+    length;
+
+  WizardBooleanType
+    status;
+
+  /*
+    Write the digest cache and release its lock.
+  */
+  status=SeekFile(cache->file_info,0,SEEK_SET) == 0 ? WizardTrue :
+    WizardFalse;
+  status&=WriteFileChunk(cache->file_info,DigestCacheMagick,
+    sizeof(DigestCacheMagick)-1);
+  ResetHashmapIterator(cache->entries);
+  for ( ; ; )
+  {
+    entry=(const DigestCacheEntry *) GetNextValueInHashmap(cache->entries);
+    if (entry == (const DigestCacheEntry *) NULL)
+      break;
+    if (entry->timestamp < cache->expiry)
+      continue;  /* expired, a lookup would rehash it */
+    length=strlen(entry->digest);
+    status&=WriteFile32Bits(cache->file_info,WizardSignature);
+    status&=WriteFile64Bits(cache->file_info,entry->device);
+    status&=WriteFile64Bits(cache->file_info,entry->inode);
+    status&=WriteFile64Bits(cache->file_info,entry->extent);
+    status&=WriteFile64Bits(cache->file_info,entry->modify_time);
+    status&=WriteFile64Bits(cache->file_info,entry->change_time);
+    status&=WriteFile64Bits(cache->file_info,entry->timestamp);
+    status&=WriteFile16Bits(cache->file_info,(unsigned short) entry->hash);
+    status&=WriteFile32Bits(cache->file_info,length);
+    status&=WriteFileChunk(cache->file_info,entry->digest,length);
+  }
+  if (status != WizardFalse)
+    status=FlushFile(cache->file_info);
+  if (status != WizardFalse)
+    {
+      file=GetFileDescriptor(cache->file_info);
+      status=ftruncate(file,lseek(file,0,SEEK_CUR)) == 0 ? WizardTrue :
+        WizardFalse;
+    }
+  if (status == WizardFalse)
+    (void) ThrowWizardException(exception,GetWizardModule(),FileError,
+      "unable to write digest cache `%s': %s",GetFilePath(cache->file_info),
+      strerror(errno));
+  cache->file_info=DestroyFileInfo(cache->file_info,exception);
+  cache->entries=DestroyHashmap(cache->entries);
+  cache=(DigestCache *) RelinquishWizardMemory(cache);
+  return(status);
+}
+
+static char *GetDigestCacheValue(DigestCache *cache,
+  const struct stat *properties,const HashType hash)
+{
+  char
+    *digest,
+    *key;
+
+  const DigestCacheEntry
+    *entry;
+
+  DigestCacheEntry
+    target;
+
+  digest=(char *) NULL;
+  GetDigestCacheProperties(properties,&target);
+  target.hash=hash;
+  key=GetDigestCacheKey(&target);
+#if defined(WIZARDSTOOLKIT_HAVE_OPENMP)
+  #pragma omp critical (WizardsToolkit_DigestCache)
+#endif
+  {
+    entry=(const DigestCacheEntry *) GetValueFromHashmap(cache->entries,key);
+    if ((entry != (const DigestCacheEntry *) NULL) &&
+        (entry->extent == target.extent) &&
+        (entry->modify_time == target.modify_time) &&
+        (entry->change_time == target.change_time) &&
+        (entry->timestamp >= cache->expiry))
+      digest=ConstantString(entry->digest);
+  }
+  key=DestroyString(key);
+  return(digest);
+}
+
+static void SetDigestCacheValue(DigestCache *cache,
+  const struct stat *properties,const HashType hash,const char *digest)
+{
+  DigestCacheEntry
+    entry;
+
+  GetDigestCacheProperties(properties,&entry);
+  entry.timestamp=(WizardSizeType) time((time_t *) NULL);
+  entry.hash=hash;
+  entry.digest=(char *) digest;
+#if defined(WIZARDSTOOLKIT_HAVE_OPENMP)
+  #pragma omp critical (WizardsToolkit_DigestCache)
+#endif
+  (void) PutDigestCacheEntry(cache,&entry);
+}
+
+static size_t ParseDigestHashes(const char *list,HashType *hashes)
+{
+  char
+    token[WizardPathExtent];
+
+  register const char
+    *p,
+    *q;
+
+  size_t
+    number_hashes;
+
+  ssize_t
+    type;
+
+  /*
+    Parse a comma-separated list of hashes, e.g. SHA256,SHA3-512.
+  */
+  number_hashes=0;
+  for (p=list; *p != '\0'; p=q)
+  {
+    while ((*p == ',') || (isspace((int) ((unsigned char) *p)) != 0))
+      p++;
+    for (q=p; (*q != '\0') && (*q != ','); q++) ;
+    if (q == p)
+      continue;
+    if ((size_t) (q-p) >= WizardPathExtent)
+      return(0);
+    (void) CopyWizardString(token,p,(size_t) (q-p)+1);
+    StripString(token);
+    type=ParseWizardOption(WizardHashOptions,WizardFalse,token);
+    if ((type <= (ssize_t) UndefinedHash) ||
+        (type >= (ssize_t) NumberDigestHashes))
+      return(0);
+    if (number_hashes >= NumberDigestHashes)
+      return(0);
+    hashes[number_hashes++]=(HashType) type;
+  }
+  return(number_hashes);
+}
+
+static inline int ReadDigestByte(DigestReader *reader)
+{
+  ssize_t
+    count;
+
+  if (reader->next == reader->end)
+    {
+      count=ReadBlobChunk(reader->blob,sizeof(reader->buffer),reader->buffer);
+      if (count <= 0)
+        return(EOF);
+      reader->next=reader->buffer;
+      reader->end=reader->buffer+count;
+    }
+  return((int) *reader->next++);
+}
+
+static char *AuthenticateContent(const DigestEntry *entry,
+  ExceptionInfo *exception)
+{
+  BlobInfo
+    *content_blob;
+
+  char
+    algorithm[WizardPathExtent],
+    date[WizardPathExtent],
+    *digest,
+    *message;
+
+  HashInfo
+    *hash_info[NumberDigestHashes];
+
+  register ssize_t
+    i;
+
+  size_t
+    length;
+
+  ssize_t
+    count;
+
+  StringInfo
+    *content;
+
+  content_blob=OpenBlob(entry->path,ReadBinaryBlobMode,WizardFalse,exception);
+  if (content_blob == (BlobInfo *) NULL)
+    return((char *) NULL);
+  /*
+    Compute content message digests in one pass and verify.
+  */
+  for (i=0; i < (ssize_t) NumberDigestHashes; i++)
+  {
+    hash_info[i]=(HashInfo *) NULL;
+    if (entry->digests[i] == (char *) NULL)
+      continue;
+    hash_info[i]=AcquireHashInfo((HashType) i);
+    InitializeHash(hash_info[i]);
+  }
+  for (content=AcquireStringInfo(WizardMaxBufferExtent); ; )
+  {
+    count=ReadBlobChunk(content_blob,WizardMaxBufferExtent,GetStringInfoDatum(
+      content));
+    if (count <= 0)
+      break;
+    length=(size_t) count;
+    SetStringInfoLength(content,length);
+    for (i=0; i < (ssize_t) NumberDigestHashes; i++)
+      if (hash_info[i] != (HashInfo *) NULL)
+        UpdateHash(hash_info[i],content);
+  }
+  content=DestroyStringInfo(content);
+  if (CloseBlob(content_blob) != WizardFalse)
+    ThrowFileException(exception,FileError,entry->path);
+  content_blob=DestroyBlob(content_blob);
+  message=(char *) NULL;
+  for (i=0; i < (ssize_t) NumberDigestHashes; i++)
+  {
+    if (hash_info[i] == (HashInfo *) NULL)
+      continue;
+    FinalizeHash(hash_info[i]);
+    digest=GetHashHexDigest(hash_info[i]);
+    hash_info[i]=DestroyHashInfo(hash_info[i]);
+    if (strcmp(entry->digests[i],digest) == 0)
+      {
+        digest=DestroyString(digest);
+        continue;
+      }
+    if (message == (char *) NULL)
+      message=AcquireString((char *) NULL);
+    (void) ConcatenateString(&message,"Path: ");
+    (void) ConcatenateString(&message,entry->path);
+    (void) ConcatenateString(&message,"\n");
+    (void) ConcatenateString(&message,"  create date: ");
+    (void) ConcatenateString(&message,entry->create_date);
+    (void) ConcatenateString(&message,"\n");
+    (void) ConcatenateString(&message,"  modify date: ");
+    (void) ConcatenateString(&message,entry->modify_date);
+    (void) ConcatenateString(&message,"\n");
+    (void) FormatLocaleString(algorithm,WizardPathExtent,"%s",
+      WizardOptionToMnemonic(WizardHashOptions,i));
+    (void) ConcatenateString(&message,"  hash: ");
+    (void) ConcatenateString(&message,algorithm);
+    (void) ConcatenateString(&message,"\n");
+    (void) ConcatenateString(&message,"  digest (");
+    (void) ConcatenateString(&message,entry->timestamp);
+    (void) ConcatenateString(&message,"):\n    ");
+    (void) ConcatenateString(&message,entry->digests[i]);
+    (void) ConcatenateString(&message,"\n");
+    (void) ConcatenateString(&message,"  errant digest (");
+    (void) FormatWizardTime(time((time_t *) NULL),WizardPathExtent,date);
+    (void) ConcatenateString(&message,date);
+    (void) ConcatenateString(&message,"):\n    ");
+    (void) ConcatenateString(&message,digest);
+    (void) ConcatenateString(&message,"\n");
+    digest=DestroyString(digest);
+  }
+  return(message);
+}
+
+static void AuthenticateEntries(DigestEntry *entries,
+  const size_t number_entries,const size_t threads,BlobInfo *authenticate_blob,
+  const char *filename,ExceptionInfo *exception)
+{
+  register ssize_t
+    i,
+    j;
+
+  ssize_t
+    count;
+
+  /*
+    Verify the queued contents in parallel and report in manifest order.
+  */
+#if defined(WIZARDSTOOLKIT_HAVE_OPENMP)
+  #pragma omp parallel for schedule(dynamic,1) num_threads(threads)
+#endif
+  for (i=0; i < (ssize_t) number_entries; i++)
+  {
+    entries[i].exception=AcquireExceptionInfo();
+    entries[i].message=AuthenticateContent(entries+i,entries[i].exception);
+  }
+  for (i=0; i < (ssize_t) number_entries; i++)
+  {
+    InheritException(exception,entries[i].exception);
+    entries[i].exception=DestroyExceptionInfo(entries[i].exception);
+    if (entries[i].message != (char *) NULL)
+      {
+        count=WriteBlobString(authenticate_blob,entries[i].message);
+        if (count != (ssize_t) strlen(entries[i].message))
+          ThrowFileException(exception,FileError,filename);
+        entries[i].message=DestroyString(entries[i].message);
+      }
+    for (j=0; j < (ssize_t) NumberDigestHashes; j++)
+      if (entries[i].digests[j] != (char *) NULL)
+        entries[i].digests[j]=DestroyString(entries[i].digests[j]);
+    entries[i].timestamp=DestroyString(entries[i].timestamp);
+    entries[i].modify_date=DestroyString(entries[i].modify_date);
+    entries[i].create_date=DestroyString(entries[i].create_date);
+    entries[i].path=DestroyString(entries[i].path);
+  }
+}
+
 static WizardBooleanType AuthenticateDigest(int argc,char **argv,
   ExceptionInfo *exception)
 {
@@ -132,23 +678,23 @@ static WizardBooleanType AuthenticateDigest(int argc,char **argv,
 
   BlobInfo
     *authenticate_blob,
-    *content_blob,
     *digest_blob;
 
   char
     *create_date,
-    date[WizardPathExtent],
-    *digest,
+    *digests[NumberDigestHashes],
     key[WizardPathExtent],
-    *message,
     *modify_date,
     *option,
     *options,
     *path,
     *timestamp;
 
-  HashInfo
-    *hash_info;
+  DigestEntry
+    *entries;
+
+  DigestReader
+    reader;
 
   HashType
     hash;
@@ -157,16 +703,14 @@ static WizardBooleanType AuthenticateDigest(int argc,char **argv,
     c;
 
   register ssize_t
-    i;
+    i,
+    j;
 
   size_t
-    length;
-
-  ssize_t
-    count;
-
-  StringInfo
-    *content;
+    extent,
+    length,
+    number_entries,
+    threads;
 
   WizardBooleanType
     status;
@@ -177,6 +721,10 @@ static WizardBooleanType AuthenticateDigest(int argc,char **argv,
   if (authenticate_blob == (BlobInfo *) NULL)
     return(WizardFalse);
   hash=UndefinedHash;
+  threads=1;
+  extent=0;
+  number_entries=0;
+  entries=(DigestEntry *) NULL;
   for (i=1; i < (ssize_t) (argc-1); i++)
   {
     option=argv[i];
@@ -232,6 +780,36 @@ static WizardBooleanType AuthenticateDigest(int argc,char **argv,
               option);
             break;
           }
+          case 't':
+          {
+            if (LocaleCompare("threads",option+1) == 0)
+              {
+                char
+                  *p;
+
+                double
+                  value;
+
+                if (*option == '+')
+                  {
+                    threads=1;
+                    break;
+                  }
+                i++;
+                if (i == (ssize_t) argc)
+                  ThrowDigestException(OptionError,"missing threads: `%s'",
+                    option);
+                value=StringToDouble(argv[i],&p);
+                if ((p == argv[i]) || (value < 1.0))
+                  ThrowDigestException(OptionFatalError,"invalid argument: "
+                    "`%s'",argv[i]);
+                threads=(size_t) value;
+                break;
+              }
+            ThrowDigestException(OptionFatalError,"unrecognized option: `%s'",
+              option);
+            break;
+          }
           case 'v':
           {
             if (strcasecmp(option,"-version") == 0)
@@ -260,14 +838,26 @@ static WizardBooleanType AuthenticateDigest(int argc,char **argv,
     digest_blob=OpenBlob(argv[i],ReadBinaryBlobMode,WizardTrue,exception);
     if (digest_blob == (BlobInfo *) NULL)
       return(WizardFalse);
+    if (extent < (256*threads))
+      {
+        extent=256*threads;
+        entries=(DigestEntry *) ResizeQuantumMemory(entries,extent,
+          sizeof(*entries));
+        if (entries == (DigestEntry *) NULL)
+          ThrowDigestException(ResourceError,"memory allocation failed: `%s'",
+            strerror(errno));
+      }
+    reader.blob=digest_blob;
+    reader.next=reader.buffer;
+    reader.end=reader.buffer;
     (void) ResetWizardMemory(key,0,sizeof(key));
     create_date=ConstantString("unknown");
-    digest=ConstantString("unknown");
+    (void) ResetWizardMemory(digests,0,sizeof(digests));
     path=ConstantString("unknown");
     modify_date=ConstantString("unknown");
     timestamp=ConstantString("unknown");
     hash=SHA2256Hash;
-    for (c=ReadBlobByte(digest_blob); (c != '>') && (c != EOF); )
+    for (c=ReadDigestByte(&reader); (c != '>') && (c != EOF); )
     {
       length=WizardPathExtent;
       options=AcquireString((char *) NULL);
@@ -277,7 +867,7 @@ static WizardBooleanType AuthenticateDigest(int argc,char **argv,
           *p;
 
         if ((isalnum(c) == WizardFalse) && (c != '/'))
-          c=ReadBlobByte(digest_blob);
+          c=ReadDigestByte(&reader);
         else
           {
             /*
@@ -292,18 +882,18 @@ static WizardBooleanType AuthenticateDigest(int argc,char **argv,
                 break;
               if ((size_t) (p-key) < WizardPathExtent)
                 *p++=(char) c;
-              c=ReadBlobByte(digest_blob);
+              c=ReadDigestByte(&reader);
             } while (c != EOF);
             *p='\0';
             p=options;
             while (isspace((int) ((unsigned char) c)) != 0)
-              c=ReadBlobByte(digest_blob);
+              c=ReadDigestByte(&reader);
             if (c == (int) '>')
               {
                 /*
                   Get the value.
                 */
-                c=ReadBlobByte(digest_blob);
+                c=ReadDigestByte(&reader);
                 while ((c != (int) '<') && (c != EOF))
                 {
                   if ((size_t) (p-options+1) >= length)
@@ -324,7 +914,7 @@ static WizardBooleanType AuthenticateDigest(int argc,char **argv,
                       return(WizardFalse);
                     }
                   *p++=(char) c;
-                  c=ReadBlobByte(digest_blob);
+                  c=ReadDigestByte(&reader);
                   if (*options != '<')
                     if (isspace((int) ((unsigned char) c)) != 0)
                       break;
@@ -366,9 +956,14 @@ static WizardBooleanType AuthenticateDigest(int argc,char **argv,
                       key+7);
                     if (algorithm < 0)
                       break;
+                    if ((algorithm <= (ssize_t) UndefinedHash) ||
+                        (algorithm >= (ssize_t) NumberDigestHashes))
+                      break;
                     hash=(HashType) algorithm;
                     StripString(options);
-                    digest=ConstantString(options);
+                    if (digests[hash] != (char *) NULL)
+                      digests[hash]=DestroyString(digests[hash]);
+                    digests[hash]=ConstantString(options);
                     break;
                   }
                 break;
@@ -382,11 +977,9 @@ static WizardBooleanType AuthenticateDigest(int argc,char **argv,
                     if (path != (char *) NULL)
                       path=DestroyString(path);
                     path=ConstantString(key+10);
-                    if (digest != (char *) NULL)
-                      {
-                        digest=DestroyString(digest);
-                        digest=ConstantString("unknown");
-                      }
+                    for (j=0; j < (ssize_t) NumberDigestHashes; j++)
+                      if (digests[j] != (char *) NULL)
+                        digests[j]=DestroyString(digests[j]);
                     if (timestamp != (char *) NULL)
                       {
                         timestamp=DestroyString(timestamp);
@@ -411,68 +1004,31 @@ static WizardBooleanType AuthenticateDigest(int argc,char **argv,
                 if ((LocaleCompare(key,"/digest:Content") == 0) ||
                     (LocaleCompare(key,"/rdf:Description") == 0))
                   {
-                    content_blob=OpenBlob(path,ReadBinaryBlobMode,WizardFalse,
-                      exception);
-                    if (content_blob == (BlobInfo *) NULL)
-                      break;
                     /*
-                      Compute content message digest and verify.
+                      Queue the content for verification.
                     */
-                    hash_info=AcquireHashInfo(hash);
-                    InitializeHash(hash_info);
-                    for (content=AcquireStringInfo(WizardMaxBufferExtent); ; )
-                    {
-                      count=ReadBlobChunk(content_blob,WizardMaxBufferExtent,
-                        GetStringInfoDatum(content));
-                      if (count <= 0)
+                    for (j=0; j < (ssize_t) NumberDigestHashes; j++)
+                      if (digests[j] != (char *) NULL)
                         break;
-                      length=(size_t) count;
-                      SetStringInfoLength(content,length);
-                      UpdateHash(hash_info,content);
-                    }
-                    FinalizeHash(hash_info);
-                    content=DestroyStringInfo(content);
-                    if (strcmp(digest,GetHashHexDigest(hash_info)) != 0)
+                    if (j == (ssize_t) NumberDigestHashes)
+                      digests[hash]=ConstantString("unknown");
+                    entries[number_entries].path=ConstantString(path);
+                    entries[number_entries].create_date=
+                      ConstantString(create_date);
+                    entries[number_entries].modify_date=
+                      ConstantString(modify_date);
+                    entries[number_entries].timestamp=
+                      ConstantString(timestamp);
+                    (void) memcpy(entries[number_entries].digests,digests,
+                      sizeof(digests));
+                    (void) ResetWizardMemory(digests,0,sizeof(digests));
+                    number_entries++;
+                    if (number_entries == extent)
                       {
-                        char
-                          algorithm[WizardPathExtent];
-
-                        message=AcquireString("Path: ");
-                        (void) ConcatenateString(&message,path);
-                        (void) ConcatenateString(&message,"\n");
-                        (void) ConcatenateString(&message,"  create date: ");
-                        (void) ConcatenateString(&message,create_date);
-                        (void) ConcatenateString(&message,"\n");
-                        (void) ConcatenateString(&message,"  modify date: ");
-                        (void) ConcatenateString(&message,modify_date);
-                        (void) ConcatenateString(&message,"\n");
-                        (void) FormatLocaleString(algorithm,WizardPathExtent,"%s",
-                          WizardOptionToMnemonic(WizardHashOptions,hash));
-                        (void) ConcatenateString(&message,"  hash: ");
-                        (void) ConcatenateString(&message,algorithm);
-                        (void) ConcatenateString(&message,"\n");
-                        (void) ConcatenateString(&message,"  digest (");
-                        (void) ConcatenateString(&message,timestamp);
-                        (void) ConcatenateString(&message,"):\n    ");
-                        (void) ConcatenateString(&message,digest);
-                        (void) ConcatenateString(&message,"\n");
-                        (void) ConcatenateString(&message,"  errant digest (");
-                        (void) FormatWizardTime(time((time_t *) NULL),
-                          WizardPathExtent,date);
-                        (void) ConcatenateString(&message,date);
-                        (void) ConcatenateString(&message,"):\n    ");
-                        (void) ConcatenateString(&message,GetHashHexDigest(
-                          hash_info));
-                        (void) ConcatenateString(&message,"\n");
-                        count=WriteBlobString(authenticate_blob,message);
-                        if (count != (ssize_t) strlen(message))
-                          ThrowFileException(exception,FileError,argv[argc-1]);
-                        message=DestroyString(message);
+                        AuthenticateEntries(entries,number_entries,threads,
+                          authenticate_blob,argv[argc-1],exception);
+                        number_entries=0;
                       }
-                    hash_info=DestroyHashInfo(hash_info);
-                    if (CloseBlob(content_blob) != WizardFalse)
-                      ThrowFileException(exception,FileError,argv[i]);
-                    content_blob=DestroyBlob(content_blob);
                     break;
                   }
               }
@@ -481,16 +1037,21 @@ static WizardBooleanType AuthenticateDigest(int argc,char **argv,
             }
           }
         while (isspace((int) ((unsigned char) c)) != 0)
-          c=ReadBlobByte(digest_blob);
+          c=ReadDigestByte(&reader);
       }
       options=DestroyString(options);
-      if (CloseBlob(digest_blob) != WizardFalse)
-        ThrowFileException(exception,FileError,argv[i]);
     }
+    AuthenticateEntries(entries,number_entries,threads,authenticate_blob,
+      argv[argc-1],exception);
+    number_entries=0;
+    if (CloseBlob(digest_blob) != WizardFalse)
+      ThrowFileException(exception,FileError,argv[i]);
+    digest_blob=DestroyBlob(digest_blob);
     if (path != (char *) NULL)
       path=DestroyString(path);
-    if (digest != (char *) NULL)
-      digest=DestroyString(digest);
+    for (j=0; j < (ssize_t) NumberDigestHashes; j++)
+      if (digests[j] != (char *) NULL)
+        digests[j]=DestroyString(digests[j]);
     if (timestamp != (char *) NULL)
       timestamp=DestroyString(timestamp);
     if (create_date != (char *) NULL)
@@ -498,6 +1059,8 @@ static WizardBooleanType AuthenticateDigest(int argc,char **argv,
     if (modify_date != (char *) NULL)
       modify_date=DestroyString(modify_date);
   }
+  if (entries != (DigestEntry *) NULL)
+    entries=(DigestEntry *) RelinquishWizardMemory(entries);
   (void) CloseBlob(authenticate_blob);
   authenticate_blob=DestroyBlob(authenticate_blob);
   if (hash == UndefinedHash)
@@ -506,36 +1069,36 @@ static WizardBooleanType AuthenticateDigest(int argc,char **argv,
   return(status);
 }
 
-WizardExport WizardBooleanType DigestCommand(int argc,char **argv,
-  ExceptionInfo *exception)
+static char *DigestContent(const char *filename,const char *hash_list,
+  DigestCache *cache,ExceptionInfo *exception)
 {
   BlobInfo
-    *content_blob,
-    *digest_blob;
+    *content_blob;
 
   char
     algorithm[WizardPathExtent],
     *canonical_path,
     content_extent[WizardPathExtent],
+    *digests[NumberDigestHashes],
     *digest_rdf,
-    *digest,
-    *option,
     timestamp[WizardPathExtent];
 
   const struct stat
     *properties;
 
   HashInfo
-    *hash_info;
+    *hash_info[NumberDigestHashes];
 
   HashType
-    hash;
+    hashes[NumberDigestHashes];
 
   register ssize_t
     i;
 
   size_t
-    length;
+    length,
+    number_hashes,
+    pending;
 
   ssize_t
     count;
@@ -543,11 +1106,204 @@ WizardExport WizardBooleanType DigestCommand(int argc,char **argv,
   StringInfo
     *content;
 
+  WizardSizeType
+    extent;
+
+  number_hashes=ParseDigestHashes(hash_list,hashes);
+  if (number_hashes == 0)
+    {
+      (void) ThrowWizardException(exception,GetWizardModule(),OptionError,
+        "unrecognized hash type: `%s'",hash_list);
+      return((char *) NULL);
+    }
+  content_blob=OpenBlob(filename,ReadBinaryBlobMode,WizardFalse,exception);
+  if (content_blob == (BlobInfo *) NULL)
+    return((char *) NULL);
+  properties=GetBlobProperties(content_blob);
+  pending=0;
+  for (i=0; i < (ssize_t) number_hashes; i++)
+  {
+    /*
+      Reuse the cached message digest if the content is unchanged.
+    */
+    hash_info[i]=(HashInfo *) NULL;
+    digests[i]=(char *) NULL;
+    if (cache != (DigestCache *) NULL)
+      digests[i]=GetDigestCacheValue(cache,properties,hashes[i]);
+    if (digests[i] != (char *) NULL)
+      continue;
+    hash_info[i]=AcquireHashInfo(hashes[i]);
+    InitializeHash(hash_info[i]);
+    pending++;
+  }
+  /*
+    Read the content once and update each message digest with it.
+  */
+  extent=(WizardSizeType) properties->st_size;
+  if (pending != 0)
+    {
+      extent=0;
+      for (content=AcquireStringInfo(WizardMaxBufferExtent); ; )
+      {
+        count=ReadBlobChunk(content_blob,WizardMaxBufferExtent,
+          GetStringInfoDatum(content));
+        if (count <= 0)
+          break;
+        length=(size_t) count;
+        SetStringInfoLength(content,length);
+        for (i=0; i < (ssize_t) number_hashes; i++)
+          if (hash_info[i] != (HashInfo *) NULL)
+            UpdateHash(hash_info[i],content);
+        extent+=length;
+      }
+      content=DestroyStringInfo(content);
+    }
+  for (i=0; i < (ssize_t) number_hashes; i++)
+  {
+    if (hash_info[i] == (HashInfo *) NULL)
+      continue;
+    FinalizeHash(hash_info[i]);
+    digests[i]=GetHashHexDigest(hash_info[i]);
+    hash_info[i]=DestroyHashInfo(hash_info[i]);
+    if (cache != (DigestCache *) NULL)
+      SetDigestCacheValue(cache,properties,hashes[i],digests[i]);
+  }
+  digest_rdf=AcquireString("  <digest:Content rdf:about=\"");
+  canonical_path=CanonicalXMLContent(filename,WizardFalse);
+  (void) ConcatenateString(&digest_rdf,canonical_path);
+  canonical_path=DestroyString(canonical_path);
+  (void) ConcatenateString(&digest_rdf,"\">\n");
+  (void) ConcatenateString(&digest_rdf,"    <digest:timestamp>");
+  (void) FormatWizardTime(time((time_t *) NULL),WizardPathExtent,timestamp);
+  (void) ConcatenateString(&digest_rdf,timestamp);
+  (void) ConcatenateString(&digest_rdf,"</digest:timestamp>\n");
+  (void) ConcatenateString(&digest_rdf,"    <digest:modify-date>");
+  (void) FormatWizardTime(properties->st_mtime,WizardPathExtent,timestamp);
+  (void) ConcatenateString(&digest_rdf,timestamp);
+  (void) ConcatenateString(&digest_rdf,"</digest:modify-date>\n");
+  (void) ConcatenateString(&digest_rdf,"    <digest:create-date>");
+  (void) FormatWizardTime(properties->st_mtime,WizardPathExtent,timestamp);
+  (void) ConcatenateString(&digest_rdf,timestamp);
+  (void) ConcatenateString(&digest_rdf,"</digest:create-date>\n");
+  (void) ConcatenateString(&digest_rdf,"    <digest:extent>");
+  (void) FormatLocaleString(content_extent,WizardPathExtent,"%.20g",(double)
+    extent);
+  (void) ConcatenateString(&digest_rdf,content_extent);
+  (void) ConcatenateString(&digest_rdf,"</digest:extent>\n");
+  for (i=0; i < (ssize_t) number_hashes; i++)
+  {
+    (void) FormatLocaleString(algorithm,WizardPathExtent,"%s",
+      WizardOptionToMnemonic(WizardHashOptions,hashes[i]));
+    LocaleLower(algorithm);
+    (void) ConcatenateString(&digest_rdf,"    <digest:");
+    (void) ConcatenateString(&digest_rdf,algorithm);
+    (void) ConcatenateString(&digest_rdf,">");
+    (void) ConcatenateString(&digest_rdf,digests[i]);
+    (void) ConcatenateString(&digest_rdf,"</digest:");
+    (void) ConcatenateString(&digest_rdf,algorithm);
+    (void) ConcatenateString(&digest_rdf,">\n");
+    digests[i]=DestroyString(digests[i]);
+  }
+  (void) ConcatenateString(&digest_rdf,"  </digest:Content>\n");
+  if (CloseBlob(content_blob) != WizardFalse)
+    ThrowFileException(exception,FileError,filename);
+  content_blob=DestroyBlob(content_blob);
+  return(digest_rdf);
+}
+
+static void FlushDigestQueue(DigestQueue *queue)
+{
+  register ssize_t
+    i;
+
+  size_t
+    length;
+
+  ssize_t
+    count;
+
+#if defined(WIZARDSTOOLKIT_HAVE_OPENMP)
+  #pragma omp parallel for schedule(dynamic,1) num_threads(queue->threads)
+#endif
+  for (i=0; i < (ssize_t) queue->number_contents; i++)
+  {
+    queue->exceptions[i]=AcquireExceptionInfo();
+    queue->digest_rdf[i]=DigestContent(queue->filenames[i],queue->hashes[i],
+      queue->cache,queue->exceptions[i]);
+  }
+  for (i=0; i < (ssize_t) queue->number_contents; i++)
+  {
+    InheritException(queue->exception,queue->exceptions[i]);
+    queue->exceptions[i]=DestroyExceptionInfo(queue->exceptions[i]);
+    queue->filenames[i]=DestroyString(queue->filenames[i]);
+    if (queue->digest_rdf[i] == (char *) NULL)
+      continue;
+    length=strlen(queue->digest_rdf[i]);
+    count=WriteBlob(queue->digest_blob,length,(unsigned char *)
+      queue->digest_rdf[i]);
+    queue->digest_rdf[i]=DestroyString(queue->digest_rdf[i]);
+    if (count != (ssize_t) length)
+      ThrowFileException(queue->exception,FileError,GetBlobFilename(
+        queue->digest_blob));
+  }
+  queue->number_contents=0;
+}
+
+static WizardBooleanType QueueDigestContent(const char *path,
+  const WizardBooleanType directory,void *context)
+{
+  DigestQueue
+    *queue;
+
+  if (directory != WizardFalse)
+    return(WizardTrue);
+  queue=(DigestQueue *) context;
+  queue->filenames[queue->number_contents]=ConstantString(path);
+  queue->hashes[queue->number_contents]=queue->hash;
+  queue->number_contents++;
+  if (queue->number_contents == queue->extent)
+    FlushDigestQueue(queue);
+  return(WizardTrue);
+}
+
+WizardExport WizardBooleanType DigestCommand(int argc,char **argv,
+  ExceptionInfo *exception)
+{
+  BlobInfo
+    *digest_blob;
+
+  char
+    *option;
+
+  const char
+    *cache_path,
+    *exclude,
+    *hash,
+    **hashes,
+    *include;
+
+  DigestCache
+    *cache;
+
+  DigestQueue
+    queue;
+
+  register ssize_t
+    i;
+
+  size_t
+    number_jobs,
+    threads;
+
+  ssize_t
+    *jobs;
+
   WizardBooleanType
+    recursive,
     status;
 
   WizardSizeType
-    extent;
+    expiry;
 
   /*
     Parse command-line options.
@@ -583,7 +1339,19 @@ WizardExport WizardBooleanType DigestCommand(int argc,char **argv,
   digest_blob=OpenBlob(argv[argc-1],WriteBinaryBlobMode,WizardTrue,exception);
   if (digest_blob == (BlobInfo *) NULL)
     return(WizardFalse);
-  hash=SHA2256Hash;
+  hash="SHA256";
+  cache_path=(const char *) NULL;
+  include=(const char *) NULL;
+  exclude=(const char *) NULL;
+  recursive=WizardFalse;
+  expiry=0;
+  threads=1;
+  number_jobs=0;
+  jobs=(ssize_t *) AcquireQuantumMemory((size_t) argc,sizeof(*jobs));
+  hashes=(const char **) AcquireQuantumMemory((size_t) argc,sizeof(*hashes));
+  if ((jobs == (ssize_t *) NULL) || (hashes == (const char **) NULL))
+    ThrowDigestException(ResourceError,"memory allocation failed: `%s'",
+      strerror(errno));
   (void) WriteBlobString(digest_blob,"<?xml version=\"1.0\"?>\n");
   (void) WriteBlobString(digest_blob,"<rdf:RDF xmlns:rdf=\""
     "http://www.w3.org/1999/02/22-rdf-syntax-ns#\"\n");
@@ -596,6 +1364,26 @@ WizardExport WizardBooleanType DigestCommand(int argc,char **argv,
       {
         switch(*(option+1))
         {
+          case 'c':
+          {
+            if (LocaleCompare("cache",option+1) == 0)
+              {
+                if (*option == '+')
+                  {
+                    cache_path=(const char *) NULL;
+                    break;
+                  }
+                i++;
+                if (i == (ssize_t) argc)
+                  ThrowDigestException(OptionError,"missing cache filename: "
+                    "`%s'",option);
+                cache_path=argv[i];
+                break;
+              }
+            ThrowDigestException(OptionFatalError,"unrecognized option: `%s'",
+              option);
+            break;
+          }
           case 'd':
           {
             if (strcasecmp(option,"-debug") == 0)
@@ -617,12 +1405,32 @@ WizardExport WizardBooleanType DigestCommand(int argc,char **argv,
               option);
             break;
           }
+          case 'e':
+          {
+            if (LocaleCompare("exclude",option+1) == 0)
+              {
+                if (*option == '+')
+                  {
+                    exclude=(const char *) NULL;
+                    break;
+                  }
+                i++;
+                if (i == (ssize_t) argc)
+                  ThrowDigestException(OptionError,"missing pattern: `%s'",
+                    option);
+                exclude=argv[i];
+                break;
+              }
+            ThrowDigestException(OptionFatalError,"unrecognized option: `%s'",
+              option);
+            break;
+          }
           case 'h':
           {
             if (LocaleCompare("hash",option+1) == 0)
               {
-                ssize_t
-                  type;
+                HashType
+                  types[NumberDigestHashes];
 
                 if (*option == '+')
                   break;
@@ -630,11 +1438,10 @@ WizardExport WizardBooleanType DigestCommand(int argc,char **argv,
                 if (i == (ssize_t) argc)
                   ThrowDigestException(OptionError,"missing hash type: `%s'",
                     option);
-                type=ParseWizardOption(WizardHashOptions,WizardFalse,argv[i]);
-                if (type < 0)
+                if (ParseDigestHashes(argv[i],types) == 0)
                   ThrowDigestException(OptionFatalError,"unrecognized hash "
                     "type: `%s'",argv[i]);
-                hash=(HashType) type;
+                hash=argv[i];
                 break;
               }
             if ((LocaleCompare("help",option+1) == 0) ||
@@ -644,6 +1451,26 @@ WizardExport WizardBooleanType DigestCommand(int argc,char **argv,
               option);
             break;
           }
+          case 'i':
+          {
+            if (LocaleCompare("include",option+1) == 0)
+              {
+                if (*option == '+')
+                  {
+                    include=(const char *) NULL;
+                    break;
+                  }
+                i++;
+                if (i == (ssize_t) argc)
+                  ThrowDigestException(OptionError,"missing pattern: `%s'",
+                    option);
+                include=argv[i];
+                break;
+              }
+            ThrowDigestException(OptionFatalError,"unrecognized option: `%s'",
+              option);
+            break;
+          }
           case 'l':
           {
             if (LocaleCompare("list",option+1) == 0)
@@ -685,6 +1512,71 @@ WizardExport WizardBooleanType DigestCommand(int argc,char **argv,
               option);
             break;
           }
+          case 'r':
+          {
+            if (LocaleCompare("recursive",option+1) == 0)
+              {
+                recursive=(*option == '-') ? WizardTrue : WizardFalse;
+                break;
+              }
+            if (LocaleCompare("rehash-older-than",option+1) == 0)
+              {
+                char
+                  *p;
+
+                double
+                  age;
+
+                if (*option == '+')
+                  {
+                    expiry=0;
+                    break;
+                  }
+                i++;
+                if (i == (ssize_t) argc)
+                  ThrowDigestException(OptionError,"missing seconds: `%s'",
+                    option);
+                age=StringToDouble(argv[i],&p);
+                if ((p == argv[i]) || (age < 0.0))
+                  ThrowDigestException(OptionFatalError,"invalid argument: "
+                    "`%s'",argv[i]);
+                expiry=(WizardSizeType) (time((time_t *) NULL)-(time_t) age);
+                break;
+              }
+            ThrowDigestException(OptionFatalError,"unrecognized option: `%s'",
+              option);
+            break;
+          }
+          case 't':
+          {
+            if (LocaleCompare("threads",option+1) == 0)
+              {
+                char
+                  *p;
+
+                double
+                  value;
+
+                if (*option == '+')
+                  {
+                    threads=1;
+                    break;
+                  }
+                i++;
+                if (i == (ssize_t) argc)
+                  ThrowDigestException(OptionError,"missing threads: `%s'",
+                    option);
+                value=StringToDouble(argv[i],&p);
+                if ((p == argv[i]) || (value < 1.0))
+                  ThrowDigestException(OptionFatalError,"invalid argument: "
+                    "`%s'",argv[i]);
+                threads=(size_t) value;
+                break;
+              }
+            ThrowDigestException(OptionFatalError,"unrecognized option: `%s'",
+              option);
+            break;
+          }
           case 'v':
           {
             if (strcasecmp(option,"-version") == 0)
@@ -708,81 +1600,73 @@ WizardExport WizardBooleanType DigestCommand(int argc,char **argv,
         continue;
       }
     /*
-      Compute message digest for this content.
+      Defer the message digest for this content.
     */
-    content_blob=OpenBlob(argv[i],ReadBinaryBlobMode,WizardFalse,exception);
-    if (content_blob == (BlobInfo *) NULL)
-      continue;
-    properties=GetBlobProperties(content_blob);
-    hash_info=AcquireHashInfo(hash);
-    InitializeHash(hash_info);
-    extent=0;
-    for (content=AcquireStringInfo(WizardMaxBufferExtent); ; )
+    jobs[number_jobs]=i;
+    hashes[number_jobs]=hash;
+    number_jobs++;
+  }
+  cache=(DigestCache *) NULL;
+  if (cache_path != (const char *) NULL)
     {
-      count=ReadBlobChunk(content_blob,WizardMaxBufferExtent,GetStringInfoDatum(
-        content));
-      if (count <= 0)
-        break;
-      length=(size_t) count;
-      SetStringInfoLength(content,length);
-      UpdateHash(hash_info,content);
-      extent+=length;
+      cache=AcquireDigestCache(cache_path,expiry,exception);
+      if (cache == (DigestCache *) NULL)
+        {
+          DestroyDigest();
+          return(WizardFalse);
+        }
     }
-    FinalizeHash(hash_info);
-    digest_rdf=AcquireString("  <digest:Content rdf:about=\"");
-    canonical_path=CanonicalXMLContent(argv[i],WizardFalse);
-    (void) ConcatenateString(&digest_rdf,canonical_path);
-    canonical_path=DestroyString(canonical_path);
-    (void) ConcatenateString(&digest_rdf,"\">\n");
-    (void) ConcatenateString(&digest_rdf,"    <digest:timestamp>");
-    (void) FormatWizardTime(time((time_t *) NULL),WizardPathExtent,timestamp);
-    (void) ConcatenateString(&digest_rdf,timestamp);
-    (void) ConcatenateString(&digest_rdf,"</digest:timestamp>\n");
-    (void) ConcatenateString(&digest_rdf,"    <digest:modify-date>");
-    (void) FormatWizardTime(properties->st_mtime,WizardPathExtent,timestamp);
-    (void) ConcatenateString(&digest_rdf,timestamp);
-    (void) ConcatenateString(&digest_rdf,"</digest:modify-date>\n");
-    (void) ConcatenateString(&digest_rdf,"    <digest:create-date>");
-    (void) FormatWizardTime(properties->st_mtime,WizardPathExtent,timestamp);
-    (void) ConcatenateString(&digest_rdf,timestamp);
-    (void) ConcatenateString(&digest_rdf,"</digest:create-date>\n");
-    (void) ConcatenateString(&digest_rdf,"    <digest:extent>");
-    (void) FormatLocaleString(content_extent,WizardPathExtent,"%.20g",(double)
-      extent);
-    (void) ConcatenateString(&digest_rdf,content_extent);
-    (void) ConcatenateString(&digest_rdf,"</digest:extent>\n");
-    (void) ConcatenateString(&digest_rdf,"    <digest:");
-    (void) FormatLocaleString(algorithm,WizardPathExtent,"%s",
-      WizardOptionToMnemonic(WizardHashOptions,hash));
-    LocaleLower(algorithm);
-    (void) ConcatenateString(&digest_rdf,algorithm);
-    (void) ConcatenateString(&digest_rdf,">");
-    digest=GetHashHexDigest(hash_info);
-    (void) ConcatenateString(&digest_rdf,digest);
-    digest=DestroyString(digest);
-    (void) ConcatenateString(&digest_rdf,"</digest:");
-    (void) FormatLocaleString(algorithm,WizardPathExtent,"%s",
-      WizardOptionToMnemonic(WizardHashOptions,hash));
-    LocaleLower(algorithm);
-    (void) ConcatenateString(&digest_rdf,algorithm);
-    (void) ConcatenateString(&digest_rdf,">\n");
-    (void) ConcatenateString(&digest_rdf,"  </digest:Content>\n");
-    content=DestroyStringInfo(content);
-    hash_info=DestroyHashInfo(hash_info);
-    if (CloseBlob(content_blob) != WizardFalse)
-      ThrowFileException(exception,FileError,argv[i]);
-    content_blob=DestroyBlob(content_blob);
-    length=strlen(digest_rdf);
-    count=WriteBlob(digest_blob,length,(unsigned char *) digest_rdf);
-    digest_rdf=DestroyString(digest_rdf);
-    if (count != (ssize_t) length)
-      ThrowFileException(exception,FileError,argv[argc-1]);
+  /*
+    Compute message digests in parallel and write them in content order.
+  */
+  (void) ResetWizardMemory(&queue,0,sizeof(queue));
+  queue.digest_blob=digest_blob;
+  queue.cache=cache;
+  queue.exception=exception;
+  queue.threads=threads;
+  queue.extent=256*threads;
+  queue.filenames=(char **) AcquireQuantumMemory(queue.extent,
+    sizeof(*queue.filenames));
+  queue.digest_rdf=(char **) AcquireQuantumMemory(queue.extent,
+    sizeof(*queue.digest_rdf));
+  queue.hashes=(const char **) AcquireQuantumMemory(queue.extent,
+    sizeof(*queue.hashes));
+  queue.exceptions=(ExceptionInfo **) AcquireQuantumMemory(queue.extent,
+    sizeof(*queue.exceptions));
+  if ((queue.filenames == (char **) NULL) ||
+      (queue.digest_rdf == (char **) NULL) ||
+      (queue.hashes == (const char **) NULL) ||
+      (queue.exceptions == (ExceptionInfo **) NULL))
+    ThrowDigestException(ResourceError,"memory allocation failed: `%s'",
+      strerror(errno));
+  for (i=0; i < (ssize_t) number_jobs; i++)
+  {
+    queue.hash=hashes[i];
+    if (recursive == WizardFalse)
+      {
+        (void) QueueDigestContent(argv[jobs[i]],WizardFalse,&queue);
+        continue;
+      }
+    if (WalkDirectory(argv[jobs[i]],include,exclude,QueueDigestContent,
+          &queue) == WizardFalse)
+      (void) ThrowWizardException(exception,GetWizardModule(),FileError,
+        "unable to read directory `%s': %s",argv[jobs[i]],strerror(errno));
   }
+  FlushDigestQueue(&queue);
+  if (cache != (DigestCache *) NULL)
+    (void) CloseDigestCache(cache,exception);
   (void) WriteBlobString(digest_blob,"</rdf:RDF>\n");
   status=CloseBlob(digest_blob);
   /*
     Free resources.
   */
+  queue.exceptions=(ExceptionInfo **) RelinquishWizardMemory(
+    queue.exceptions);
+  queue.hashes=(const char **) RelinquishWizardMemory(queue.hashes);
+  queue.digest_rdf=(char **) RelinquishWizardMemory(queue.digest_rdf);
+  queue.filenames=(char **) RelinquishWizardMemory(queue.filenames);
+  hashes=(const char **) RelinquishWizardMemory(hashes);
+  jobs=(ssize_t *) RelinquishWizardMemory(jobs);
   digest_blob=DestroyBlob(digest_blob);
   DestroyDigest();
   return(status);
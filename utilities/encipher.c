@@ -61,14 +61,403 @@
 #endif
 #include "content.h"
 #include "utility_.h"
+
+/*
+  Typedef declarations.
+*/
+typedef struct _EncipherQueue
+{
+  ContentInfo
+    *content_info;
+
+  char
+    **filenames;
+
+  const char
+    *cipher_path;
+
+  ExceptionInfo
+    *exception;
+
+  size_t
+    extent,
+    extent_filenames,
+    failures,
+    number_contents,
+    number_filenames;
+
+  WizardBooleanType
+    compress,
+    verbose;
+} EncipherQueue;
 
 /*
   Forward declaraction.
 */
 static WizardBooleanType
+  EncipherBatch(ContentInfo *,const char *,const WizardBooleanType,
+    const WizardBooleanType,ExceptionInfo *),
   EncipherContent(ContentInfo *,const char *,const char *,
-    const WizardBooleanType,ExceptionInfo *);
+    const WizardBooleanType,ExceptionInfo *),
+  GenerateContentKey(ContentInfo *,ExceptionInfo *);
+
+static size_t
+  EncipherContents(ContentInfo *,char **,const size_t,const WizardBooleanType,
+    const WizardBooleanType);
 
+/*
+%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%
+%                                                                             %
+%                                                                             %
+%                                                                             %
+%   E n c i p h e r B a t c h                                                 %
+%                                                                             %
+%                                                                             %
+%                                                                             %
+%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%
+%
+%  EncipherBatch() enciphers each plaintext ciphertext pair listed in a batch
+%  manifest.  The key is generated and the random reservoir is seeded once
+%  and shared by every content in the batch.  Each content gets its own
+%  nonce.  The contents are enciphered in parallel, one per thread, and the
+%  status of each is reported as it completes.
+%
+%  The format of the EncipherBatch method is:
+%
+%      WizardBooleanType EncipherBatch(ContentInfo *content_info,
+%        const char *batch_filename,const WizardBooleanType compress,
+%        const WizardBooleanType verbose,ExceptionInfo *exception)
+%
+%  A description of each parameter follows:
+%
+%    o content_info: the cipher options.
+%
+%    o batch_filename: the batch manifest filename.
+%
+%    o compress: automagically (de)compress BZIP and ZIP files.
+%
+%    o verbose: print detailed information about each content.
+%
+%    o exception: return any exceptions in this structure.
+%
+*/
+static WizardBooleanType EncipherBatch(ContentInfo *content_info,
+  const char *batch_filename,const WizardBooleanType compress,
+  const WizardBooleanType verbose,ExceptionInfo *exception)
+{
+  char
+    **filenames,
+    *manifest;
+
+  int
+    number_filenames;
+
+  register ssize_t
+    i;
+
+  size_t
+    failures;
+
+  WizardBooleanType
+    status;
+
+  /*
+    The batch manifest lists whitespace separated plaintext ciphertext pairs.
+  */
+  if (content_info->properties != (char *) NULL)
+    {
+      (void) ThrowWizardException(exception,GetWizardModule(),OptionError,
+        "cipher properties are not supported in batch mode: `%s'",
+        content_info->properties);
+      return(WizardFalse);
+    }
+  manifest=FileToString(batch_filename,~0UL,exception);
+  if (manifest == (char *) NULL)
+    return(WizardFalse);
+  filenames=StringToArgv(manifest,&number_filenames);
+  manifest=DestroyString(manifest);
+  if (filenames == (char **) NULL)
+    return(WizardFalse);
+  failures=0;
+  status=WizardTrue;
+  if ((number_filenames % 2) != 0)
+    {
+      (void) ThrowWizardException(exception,GetWizardModule(),OptionError,
+        "plaintext without a ciphertext in batch manifest: `%s'",
+        filenames[number_filenames-1]);
+      status=WizardFalse;
+    }
+  if (status != WizardFalse)
+    status=GenerateContentKey(content_info,exception);
+  if (status != WizardFalse)
+    {
+      failures=EncipherContents(content_info,filenames,(size_t)
+        number_filenames,compress,verbose);
+      if (failures != 0)
+        {
+          (void) ThrowWizardException(exception,GetWizardModule(),FileError,
+            "unable to encipher %.20g of %.20g batch contents: `%s'",(double)
+            failures,(double) (number_filenames/2),batch_filename);
+          status=WizardFalse;
+        }
+    }
+  for (i=0; i < (ssize_t) number_filenames; i++)
+    filenames[i]=DestroyString(filenames[i]);
+  filenames=(char **) RelinquishWizardMemory(filenames);
+  return(status);
+}
+
+/*
+%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%
+%                                                                             %
+%                                                                             %
+%                                                                             %
+%   E n c i p h e r C o n t e n t s                                           %
+%                                                                             %
+%                                                                             %
+%                                                                             %
+%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%
+%
+%  EncipherContents() enciphers a list of plaintext ciphertext pairs in
+%  parallel, one per thread, with the key and random reservoir of the content
+%  info.  The status of each content is reported as it completes.  It returns
+%  the number of contents that could not be enciphered.
+%
+%  The format of the EncipherContents method is:
+%
+%      size_t EncipherContents(ContentInfo *content_info,char **filenames,
+%        const size_t number_filenames,const WizardBooleanType compress,
+%        const WizardBooleanType verbose)
+%
+%  A description of each parameter follows:
+%
+%    o content_info: the cipher options.
+%
+%    o filenames: the plaintext ciphertext pairs.
+%
+%    o number_filenames: the number of filenames, twice the number of pairs.
+%
+%    o compress: automagically (de)compress BZIP and ZIP files.
+%
+%    o verbose: print detailed information about each content.
+%
+*/
+static size_t EncipherContents(ContentInfo *content_info,char **filenames,
+  const size_t number_filenames,const WizardBooleanType compress,
+  const WizardBooleanType verbose)
+{
+  register ssize_t
+    i;
+
+  size_t
+    failures;
+
+  failures=0;
+#if defined(WIZARDSTOOLKIT_HAVE_OPENMP)
+  #pragma omp parallel for schedule(dynamic,1) \
+    num_threads(content_info->threads)
+#endif
+  for (i=0; i < (ssize_t) number_filenames; i+=2)
+  {
+    ContentInfo
+      *batch_info;
+
+    ExceptionInfo
+      *batch_exception;
+
+    WizardBooleanType
+      batch_status;
+
+    batch_info=CloneContentInfo(content_info);
+    batch_info->threads=1;
+    batch_info->content=ConstantString(filenames[i]);
+    batch_info->authenticate_info=content_info->authenticate_info;
+    batch_info->random_info=content_info->random_info;
+    batch_exception=AcquireExceptionInfo();
+    batch_status=EncipherContent(batch_info,filenames[i],filenames[i+1],
+      compress,batch_exception);
+#if defined(WIZARDSTOOLKIT_HAVE_OPENMP)
+    #pragma omp critical (WizardsToolkit_EncipherContents)
+#endif
+    {
+      if (batch_status == WizardFalse)
+        failures++;
+      (void) fprintf(stdout,"%s: %s\n",filenames[i],batch_status !=
+        WizardFalse ? "ok" : "failed");
+      if ((batch_status != WizardFalse) && (verbose != WizardFalse))
+        (void) PrintCipherProperties(batch_info,stdout);
+      (void) fflush(stdout);
+      CatchException(batch_exception);
+    }
+    batch_exception=DestroyExceptionInfo(batch_exception);
+    batch_info->authenticate_info=(AuthenticateInfo *) NULL;
+    batch_info->random_info=(RandomInfo *) NULL;
+    batch_info=DestroyContentInfo(batch_info);
+  }
+  return(failures);
+}
+
+/*
+%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%
+%                                                                             %
+%                                                                             %
+%                                                                             %
+%   E n c i p h e r R e c u r s i v e                                         %
+%                                                                             %
+%                                                                             %
+%                                                                             %
+%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%
+%
+%  EncipherRecursive() enciphers each file below a plaintext directory to the
+%  same relative path below a ciphertext directory, creating directories as
+%  needed.  Like a batch, the key is generated once and the contents are
+%  enciphered in parallel.
+%
+%  The format of the EncipherRecursive method is:
+%
+%      WizardBooleanType EncipherRecursive(ContentInfo *content_info,
+%        const char *plain_path,const char *cipher_path,const char *include,
+%        const char *exclude,const WizardBooleanType compress,
+%        const WizardBooleanType verbose,ExceptionInfo *exception)
+%
+%  A description of each parameter follows:
+%
+%    o content_info: the cipher options.
+%
+%    o plain_path: the plaintext directory.
+%
+%    o cipher_path: the ciphertext directory.
+%
+%    o include: only encipher files that match this pattern.
+%
+%    o exclude: skip files and directories that match this pattern.
+%
+%    o compress: automagically (de)compress BZIP and ZIP files.
+%
+%    o verbose: print detailed information about each content.
+%
+%    o exception: return any exceptions in this structure.
+%
+*/
+
+static void FlushEncipherQueue(EncipherQueue *queue)
+{
+  register ssize_t
+    i;
+
+  if (queue->number_filenames == 0)
+    return;
+  queue->failures+=EncipherContents(queue->content_info,queue->filenames,
+    queue->number_filenames,queue->compress,queue->verbose);
+  for (i=0; i < (ssize_t) queue->number_filenames; i++)
+    queue->filenames[i]=DestroyString(queue->filenames[i]);
+  queue->number_filenames=0;
+}
+
+static WizardBooleanType QueueEncipherContent(const char *path,
+  const WizardBooleanType directory,void *context)
+{
+  char
+    *cipher_filename;
+
+  EncipherQueue
+    *queue;
+
+  queue=(EncipherQueue *) context;
+  cipher_filename=AcquireString(queue->cipher_path);
+  (void) ConcatenateString(&cipher_filename,path+queue->extent);
+  if (directory != WizardFalse)
+    {
+      int
+        status;
+
+#if defined(WIZARDSTOOLKIT_WINDOWS_SUPPORT)
+      status=mkdir(cipher_filename);
+#else
+      status=mkdir(cipher_filename,S_IRWXU | S_IRWXG | S_IRWXO);
+#endif
+      if ((status == -1) && (errno != EEXIST))
+        {
+          (void) ThrowWizardException(queue->exception,GetWizardModule(),
+            FileError,"unable to create directory `%s': %s",cipher_filename,
+            strerror(errno));
+          cipher_filename=DestroyString(cipher_filename);
+          return(WizardFalse);
+        }
+      cipher_filename=DestroyString(cipher_filename);
+      return(WizardTrue);
+    }
+  queue->filenames[queue->number_filenames++]=ConstantString(path);
+  queue->filenames[queue->number_filenames++]=cipher_filename;
+  queue->number_contents++;
+  if (queue->number_filenames == queue->extent_filenames)
+    FlushEncipherQueue(queue);
+  return(WizardTrue);
+}
+
+static WizardBooleanType EncipherRecursive(ContentInfo *content_info,
+  const char *plain_path,const char *cipher_path,const char *include,
+  const char *exclude,const WizardBooleanType compress,
+  const WizardBooleanType verbose,ExceptionInfo *exception)
+{
+  EncipherQueue
+    queue;
+
+  struct stat
+    attributes;
+
+  WizardBooleanType
+    status;
+
+  if (content_info->properties != (char *) NULL)
+    {
+      (void) ThrowWizardException(exception,GetWizardModule(),OptionError,
+        "cipher properties are not supported in recursive mode: `%s'",
+        content_info->properties);
+      return(WizardFalse);
+    }
+  if ((stat(plain_path,&attributes) != 0) ||
+      (S_ISDIR(attributes.st_mode) == 0))
+    {
+      (void) ThrowWizardException(exception,GetWizardModule(),FileError,
+        "not a directory: `%s'",plain_path);
+      return(WizardFalse);
+    }
+  status=GenerateContentKey(content_info,exception);
+  if (status == WizardFalse)
+    return(WizardFalse);
+  (void) memset(&queue,0,sizeof(queue));
+  queue.content_info=content_info;
+  queue.cipher_path=cipher_path;
+  queue.extent=strlen(plain_path);
+  while ((queue.extent != 0) &&
+         (plain_path[queue.extent-1] == *DirectorySeparator))
+    queue.extent--;  /* keep the separator before the relative path */
+  queue.extent_filenames=2*256*content_info->threads;
+  queue.filenames=(char **) AcquireQuantumMemory(queue.extent_filenames,
+    sizeof(*queue.filenames));
+  if (queue.filenames == (char **) NULL)
+    {
+      (void) ThrowWizardException(exception,GetWizardModule(),ResourceError,
+        "memory allocation failed: `%s'",plain_path);
+      return(WizardFalse);
+    }
+  queue.compress=compress;
+  queue.verbose=verbose;
+  queue.exception=exception;
+  status=WalkDirectory(plain_path,include,exclude,QueueEncipherContent,&queue);
+  FlushEncipherQueue(&queue);
+  queue.filenames=(char **) RelinquishWizardMemory(queue.filenames);
+  if (queue.failures != 0)
+    {
+      (void) ThrowWizardException(exception,GetWizardModule(),FileError,
+        "unable to encipher %.20g of %.20g contents: `%s'",(double)
+        queue.failures,(double) queue.number_contents,plain_path);
+      status=WizardFalse;
+    }
+  return(status);
+}
+
 /*
 %%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%
 %                                                                             %
@@ -103,13 +492,18 @@ static void EncipherUsage()
     *options[]=
     {
       "-authenticate method authenticate with this method: Secret or Public",
+      "-batch filename      encipher each plaintext ciphertext pair in this file",
+      "-chunk-nonce         derive an independent nonce for each chunk",
       "-chunksize bytes     number of bytes in a chunk",
       "-cipher type         cipher to encipher content",
       "-debug events        display copious debugging information",
       "-(de)compress        automagically (de)compress BZIP and ZIP files",
       "-entropy type        increase content entropy",
+      "-exclude pattern     skip files and directories that match this pattern",
+      "-header type         cipher header format: XML or Binary",
       "-help                print program options",
       "-hmac hash           ensure message integrity with this hash",
+      "-include pattern     only encipher files that match this pattern",
       "-key hash            strengthen the key with this hash",
       "-key-length value    cipher key length in bits: 256, 512, 1024, or 2048",
       "-keyring filename    get private key from this keyring",
@@ -120,6 +514,9 @@ static void EncipherUsage()
       "-passphrase filename get the passphrase from this file",
       "-properties filename put cipher properties to this file",
       "-random hash         strengthen random data with this hash",
+      "-recursive           encipher the files below the plaintext directory",
+      "-sync policy         sync output: Never, Chunk, or End (the default)",
+      "-threads value       number of threads to process chunks in parallel",
       "-true-random         strengthen enciphering with true random numbers",
       "-verbose             print detailed information about the secure content",
       "-version             print version information",
@@ -134,6 +531,10 @@ static void EncipherUsage()
   (void) fprintf(stdout,"Copyright: %s\n\n",GetWizardCopyright());
   (void) fprintf(stdout,"Usage: %s [options ...] plaintext ciphertext\n",
     GetClientName());
+  (void) fprintf(stdout,"       %s [options ...] -batch filename\n",
+    GetClientName());
+  (void) fprintf(stdout,"       %s [options ...] -recursive plaintext "
+    "ciphertext\n",GetClientName());
   (void) fprintf(stdout,"\nWhere options include:\n");
   for (p=options; *p != (char *) NULL; p++)
     (void) fprintf(stdout,"  %s\n",*p);
@@ -166,7 +567,10 @@ WizardExport WizardBooleanType EncipherCommand(int argc,char **argv,
 }
 
   const char
+    *batch_filename,
     *cipher_filename,
+    *exclude,
+    *include,
     *option,
     *plain_filename;
 
@@ -181,6 +585,7 @@ WizardExport WizardBooleanType EncipherCommand(int argc,char **argv,
 
   WizardBooleanType
     compress,
+    recursive,
     status,
     verbose;
 
@@ -206,9 +611,13 @@ WizardExport WizardBooleanType EncipherCommand(int argc,char **argv,
   if (status == WizardFalse)
     ThrowCipherException(ResourceError,"memory allocation failed: `%s'",
       strerror(errno));
+  batch_filename=(const char *) NULL;
   plain_filename=(const char *) NULL;
   cipher_filename=(const char *) NULL;
   compress=WizardTrue;
+  exclude=(const char *) NULL;
+  include=(const char *) NULL;
+  recursive=WizardFalse;
   verbose=WizardFalse;
   for (i=1; i < (ssize_t) argc; i++)
   {
@@ -265,8 +674,34 @@ WizardExport WizardBooleanType EncipherCommand(int argc,char **argv,
           option);
         break;
       }
+      case 'b':
+      {
+        if (LocaleCompare("batch",option+1) == 0)
+          {
+            if (*option == '+')
+              {
+                batch_filename=(const char *) NULL;
+                break;
+              }
+            i++;
+            if (i == (ssize_t) argc)
+              ThrowCipherException(OptionError,"missing batch filename: `%s'",
+                option);
+            batch_filename=argv[i];
+            break;
+          }
+        ThrowCipherException(OptionFatalError,"unrecognized option: `%s'",
+          option);
+        break;
+      }
       case 'c':
       {
+        if (LocaleCompare("chunk-nonce",option+1) == 0)
+          {
+            content_info->chunk_nonce=(*option == '-') ? WizardTrue :
+              WizardFalse;
+            break;
+          }
         if (LocaleCompare("cipher",option+1) == 0)
           {
             if (*option == '+')
@@ -346,12 +781,47 @@ WizardExport WizardBooleanType EncipherCommand(int argc,char **argv,
             content_info->entropy=(EntropyType) type;
             break;
           }
+        if (LocaleCompare("exclude",option+1) == 0)
+          {
+            if (*option == '+')
+              {
+                exclude=(const char *) NULL;
+                break;
+              }
+            i++;
+            if (i == (ssize_t) argc)
+              ThrowCipherException(OptionError,"missing exclude pattern: `%s'",
+                option);
+            exclude=argv[i];
+            break;
+          }
         ThrowCipherException(OptionFatalError,"unrecognized option: `%s'",
           option);
         break;
       }
       case 'h':
       {
+        if (LocaleCompare("header",option+1) == 0)
+          {
+            if (*option == '+')
+              {
+                content_info->header=XMLHeader;
+                break;
+              }
+            i++;
+            if (i == (ssize_t) argc)
+              ThrowCipherException(OptionError,"missing header type: `%s'",
+                option);
+            if (LocaleCompare(argv[i],"Binary") == 0)
+              content_info->header=BinaryHeader;
+            else
+              if (LocaleCompare(argv[i],"XML") == 0)
+                content_info->header=XMLHeader;
+              else
+                ThrowCipherException(OptionFatalError,"unrecognized header "
+                  "type: `%s'",argv[i]);
+            break;
+          }
         if (LocaleCompare("hmac",option+1) == 0)
           {
             ssize_t
@@ -377,6 +847,26 @@ WizardExport WizardBooleanType EncipherCommand(int argc,char **argv,
           option);
         break;
       }
+      case 'i':
+      {
+        if (LocaleCompare("include",option+1) == 0)
+          {
+            if (*option == '+')
+              {
+                include=(const char *) NULL;
+                break;
+              }
+            i++;
+            if (i == (ssize_t) argc)
+              ThrowCipherException(OptionError,"missing include pattern: `%s'",
+                option);
+            include=argv[i];
+            break;
+          }
+        ThrowCipherException(OptionFatalError,"unrecognized option: `%s'",
+          option);
+        break;
+      }
       case 'k':
       {
         if (LocaleCompare("key",option+1) == 0)
@@ -532,8 +1022,63 @@ WizardExport WizardBooleanType EncipherCommand(int argc,char **argv,
           option);
         break;
       }
+      case 'r':
+      {
+        if (LocaleCompare("recursive",option+1) == 0)
+          {
+            recursive=(*option == '-') ? WizardTrue : WizardFalse;
+            break;
+          }
+        ThrowCipherException(OptionFatalError,"unrecognized option: `%s'",
+          option);
+        break;
+      }
+      case 's':
+      {
+        if (LocaleCompare("sync",option+1) == 0)
+          {
+            ssize_t
+              type;
+
+            if (*option == '+')
+              break;
+            i++;
+            if (i == (ssize_t) argc)
+              ThrowCipherException(OptionError,"missing sync policy: `%s'",
+                option);
+            type=ParseWizardOption(WizardSyncOptions,WizardFalse,argv[i]);
+            if (type < 0)
+              ThrowCipherException(OptionFatalError,"unrecognized sync "
+                "policy: `%s'",argv[i]);
+            content_info->sync=(SyncType) type;
+            break;
+          }
+        ThrowCipherException(OptionFatalError,"unrecognized option: `%s'",
+          option);
+        break;
+      }
       case 't':
       {
+        if (LocaleCompare(option,"-threads") == 0)
+          {
+            char
+              *p;
+
+            double
+              value;
+
+            if (*option == '+')
+              break;
+            i++;
+            if (i == (ssize_t) argc)
+              ThrowCipherException(OptionError,"missing threads: `%s'",
+                option);
+            value=StringToDouble(argv[i],&p);
+            if ((p == argv[i]) || (value < 1.0))
+              ThrowInvalidArgumentException(option,argv[i]);
+            content_info->threads=(size_t) value;
+            break;
+          }
         if (LocaleCompare(option+1,"true-random") == 0)
           {
             SetRandomTrueRandom(*option == '-' ? WizardTrue : WizardFalse);
@@ -572,9 +1117,25 @@ WizardExport WizardBooleanType EncipherCommand(int argc,char **argv,
   /*
     Encipher content.
   */
+  if (batch_filename != (const char *) NULL)
+    {
+      if (plain_filename != (char *) NULL)
+        EncipherUsage();
+      status=EncipherBatch(content_info,batch_filename,compress,verbose,
+        exception);
+      DestroyCipher();
+      return(status);
+    }
   if ((plain_filename == (char *) NULL) ||
       (cipher_filename == (char *) NULL))
     EncipherUsage();
+  if (recursive != WizardFalse)
+    {
+      status=EncipherRecursive(content_info,plain_filename,cipher_filename,
+        include,exclude,compress,verbose,exception);
+      DestroyCipher();
+      return(status);
+    }
   content_info->content=ConstantString(plain_filename);
   status=EncipherContent(content_info,plain_filename,cipher_filename,
     compress,exception);
@@ -627,28 +1188,28 @@ static WizardBooleanType EncipherContent(ContentInfo *content_info,
 { \
   (void) ThrowWizardException(exception,GetWizardModule(),asperity, \
     tag,context,strerror(errno)); \
+  if (chunk_info != (ChunkInfo **) NULL) \
+    chunk_info=DestroyChunkInfoThreadSet(chunk_info); \
   return(WizardFalse); \
 }
 
-  char
-    *cipher_packet,
-    *cipher_rdf,
-    *digest,
-    message[WizardPathExtent],
-    timestamp[WizardPathExtent];
+  ChunkInfo
+    **chunk_info;
 
   const StringInfo
-    *chaos,
-    *hmac;
+    *hmac,
+    *nonce;
 
   const struct stat
     *properties;
 
-  HashInfo
-    *hash_info;
+  register ssize_t
+    i;
 
   size_t
     blocksize,
+    chunk,
+    chunks,
     length,
     pad;
 
@@ -662,6 +1223,7 @@ static WizardBooleanType EncipherContent(ContentInfo *content_info,
   WizardBooleanType
     status;
 
+  chunk_info=(ChunkInfo **) NULL;
   /*
     Open plaintext and ciphertext content files.
   */
@@ -673,126 +1235,26 @@ static WizardBooleanType EncipherContent(ContentInfo *content_info,
     compress,exception);
   if (content_info->cipherblob == (BlobInfo *) NULL)
     return(WizardFalse);
+  SetBlobSynchronize(content_info->cipherblob,content_info->sync == EndSync ?
+    WizardTrue : WizardFalse);
   content_info->cipher_info=AcquireCipherInfo(content_info->cipher,
     content_info->mode);
-  content_info->authenticate_info=AcquireAuthenticateInfo(
-    content_info->authenticate_method,content_info->keyring,
-    content_info->key_hash);
-  if (content_info->passphrase != (char *) NULL)
-    SetAuthenticatePassphrase(content_info->authenticate_info,
-      content_info->passphrase);
-  SetAuthenticateKeyLength(content_info->authenticate_info,
-    content_info->key_length);
-  status=GenerateAuthenticateKey(content_info->authenticate_info,exception);
-  if (status == WizardFalse)
-    return(WizardFalse);
-  content_info->id=StringInfoToHexString(GetAuthenticateId(
-    content_info->authenticate_info));
+  if (content_info->authenticate_info == (AuthenticateInfo *) NULL)
+    {
+      status=GenerateContentKey(content_info,exception);
+      if (status == WizardFalse)
+        return(WizardFalse);
+    }
   SetCipherKey(content_info->cipher_info,GetAuthenticateKey(
     content_info->authenticate_info));
   content_info->nonce=StringInfoToHexString(GetCipherNonce(
     content_info->cipher_info));
-  content_info->random_info=AcquireRandomInfo(content_info->random_hash);
   properties=GetBlobProperties(content_info->plainblob);
   content_info->access_date=properties->st_atime;
   content_info->modify_date=properties->st_mtime;
   content_info->create_date=properties->st_ctime;
-  /*
-    Generate cipher RDF blob.
-  */
-  cipher_rdf=AcquireString("<rdf:RDF xmlns:rdf=\""
-    "http://www.w3.org/1999/02/22-rdf-syntax-ns#\"\n");
-  (void) ConcatenateString(&cipher_rdf,"         xmlns:cipher=\""
-     "http://www.wizards-toolkit.org/cipher/1.0/\">\n");
-  (void) ConcatenateString(&cipher_rdf,"  <cipher:Content rdf:about=\"");
-  (void) ConcatenateString(&cipher_rdf,plain_filename);
-  (void) ConcatenateString(&cipher_rdf,"\">\n");
-  (void) FormatLocaleString(message,WizardPathExtent,
-    "    <cipher:type>%s</cipher:type>\n",WizardOptionToMnemonic(
-    WizardCipherOptions,content_info->cipher));
-  (void) ConcatenateString(&cipher_rdf,message);
-  (void) FormatLocaleString(message,WizardPathExtent,
-    "    <cipher:mode>%s</cipher:mode>\n",WizardOptionToMnemonic(
-    WizardModeOptions,content_info->mode));
-  (void) ConcatenateString(&cipher_rdf,message);
-  (void) FormatLocaleString(message,WizardPathExtent,
-    "    <cipher:nonce>%s</cipher:nonce>\n",content_info->nonce);
-  (void) ConcatenateString(&cipher_rdf,message);
-  (void) FormatLocaleString(message,WizardPathExtent,
-    "    <cipher:authenticate>%s</cipher:authenticate>\n",
-    WizardOptionToMnemonic(WizardAuthenticateOptions,
-    content_info->authenticate_method));
-  (void) ConcatenateString(&cipher_rdf,message);
-  (void) FormatLocaleString(message,WizardPathExtent,
-    "    <cipher:id>%s</cipher:id>\n",content_info->id);
-  (void) ConcatenateString(&cipher_rdf,message);
-  (void) FormatLocaleString(message,WizardPathExtent,
-    "    <cipher:key-hash>%s</cipher:key-hash>\n",WizardOptionToMnemonic(
-    WizardHashOptions,content_info->key_hash));
-  (void) ConcatenateString(&cipher_rdf,message);
-  (void) FormatLocaleString(message,WizardPathExtent,
-    "    <cipher:key-length>%u</cipher:key-length>\n",content_info->key_length);
-  (void) ConcatenateString(&cipher_rdf,message);
-  (void) FormatLocaleString(message,WizardPathExtent,
-    "    <cipher:entropy>%s</cipher:entropy>\n",WizardOptionToMnemonic(
-    WizardEntropyOptions,content_info->entropy));
-  (void) ConcatenateString(&cipher_rdf,message);
-  (void) FormatLocaleString(message,WizardPathExtent,
-    "    <cipher:level>%u</cipher:level>\n",content_info->level);
-  (void) ConcatenateString(&cipher_rdf,message);
-  (void) FormatLocaleString(message,WizardPathExtent,
-    "    <cipher:hmac>%s</cipher:hmac>\n",WizardOptionToMnemonic(
-    WizardHashOptions,content_info->hmac));
-  (void) ConcatenateString(&cipher_rdf,message);
-  (void) FormatLocaleString(message,WizardPathExtent,
-    "    <cipher:chunksize>%.20g</cipher:chunksize>\n",(double)
-    content_info->chunksize);
-  (void) ConcatenateString(&cipher_rdf,message);
-  (void) FormatWizardTime(content_info->modify_date,WizardPathExtent,timestamp);
-  (void) FormatLocaleString(message,WizardPathExtent,
-    "    <cipher:modify-date>%s</cipher:modify-date>\n",timestamp);
-  (void) ConcatenateString(&cipher_rdf,message);
-  (void) FormatWizardTime(content_info->create_date,WizardPathExtent,timestamp);
-  (void) FormatLocaleString(message,WizardPathExtent,
-    "    <cipher:create-date>%s</cipher:create-date>\n",timestamp);
-  (void) ConcatenateString(&cipher_rdf,message);
-  (void) FormatWizardTime(content_info->timestamp,WizardPathExtent,timestamp);
-  (void) FormatLocaleString(message,WizardPathExtent,
-    "    <cipher:timestamp>%s</cipher:timestamp>\n",timestamp);
-  (void) ConcatenateString(&cipher_rdf,message);
-  (void) FormatLocaleString(message,WizardPathExtent,
-    "    <cipher:protocol>%u.%u</cipher:protocol>\n",
-    content_info->protocol_major,content_info->protocol_minor);
-  (void) ConcatenateString(&cipher_rdf,message);
-  (void) FormatLocaleString(message,WizardPathExtent,
-    "    <cipher:version>%s</cipher:version>\n",content_info->version);
-  (void) ConcatenateString(&cipher_rdf,message);
-  (void) ConcatenateString(&cipher_rdf,"  </cipher:Content>\n");
-  (void) ConcatenateString(&cipher_rdf,"</rdf:RDF>\n");
-  /*
-    Wrap cipher RDF in a cipher-packet.
-  */
-  length=strlen(cipher_rdf);
-  hash_info=AcquireHashInfo(SHA2256Hash);
-  InitializeHash(hash_info);
-  plaintext=StringToStringInfo(cipher_rdf);
-  UpdateHash(hash_info,plaintext);
-  plaintext=DestroyStringInfo(plaintext);
-  FinalizeHash(hash_info);
-  digest=GetHashHexDigest(hash_info);
-  length=(size_t) FormatLocaleString(message,WizardPathExtent,
-    "<?cipherpacket digest=\"%s\" bytes=\"%u\"?>\n",digest,(unsigned int)
-    length);
-  digest=DestroyString(digest);
-  hash_info=DestroyHashInfo(hash_info);
-  cipher_packet=AcquireString(message);
-  (void) ConcatenateString(&cipher_packet,cipher_rdf);
-  cipher_rdf=DestroyString(cipher_rdf);
-  (void) ConcatenateString(&cipher_packet,"<?cipherpacket?>\f\n");
-  length=strlen(cipher_packet);
   if (content_info->properties == (char *) NULL)
-    count=WriteBlob(content_info->cipherblob,length,(unsigned char *)
-      cipher_packet);
+    status=PutContentInfo(content_info,content_info->cipherblob,exception);
   else
     {
       BlobInfo
@@ -805,84 +1267,133 @@ static WizardBooleanType EncipherContent(ContentInfo *content_info,
         WizardTrue,exception);
       if (properties == (BlobInfo *) NULL)
         return(WizardFalse);
-      count=WriteBlob(properties,length,(unsigned char *) cipher_packet);
+      status=PutContentInfo(content_info,properties,exception);
       if (CloseBlob(properties) == WizardTrue)
         ThrowFileException(exception,FileError,content_info->properties);
       properties=DestroyBlob(properties);
     }
-  cipher_packet=DestroyString(cipher_packet);
-  if (count != (ssize_t) length)
-    ThrowEncipherContentException(FileError,
-      "unable to write cipher properties `%s': `%s'",cipher_filename);
+  if (status == WizardFalse)
+    return(WizardFalse);
   /*
     Encipher plaintext.
   */
-  if (content_info->hmac != NoHash)
-    content_info->hmac_info=AcquireHMACInfo(content_info->hmac);
-  content_info->entropy_info=(EntropyInfo *) NULL;
-  if (content_info->entropy != NoEntropy)
-    content_info->entropy_info=AcquireEntropyInfo(content_info->entropy,
-      content_info->level);
+  chunk_info=AcquireChunkInfoThreadSet(content_info);
+  nonce=GetCipherNonce(content_info->cipher_info);
   pad=0;
+  length=0;
   blocksize=GetCipherBlocksize(content_info->cipher_info);
   ciphertext=(StringInfo *) NULL;
-  for (plaintext=AcquireStringInfo(content_info->chunksize); ; )
+  for (chunk=0; ; chunk+=chunks)
   {
-    SetStringInfoLength(plaintext,content_info->chunksize);
-    count=ReadBlobChunk(content_info->plainblob,content_info->chunksize,
-      GetStringInfoDatum(plaintext));
-    if (count <= 0)
+    /*
+      Read a chunk for each thread.
+    */
+    for (chunks=0; chunk_info[chunks] != (ChunkInfo *) NULL; chunks++)
+    {
+      plaintext=chunk_info[chunks]->chunk;
+      SetStringInfoLength(plaintext,content_info->chunksize);
+      count=ReadBlobChunk(content_info->plainblob,content_info->chunksize,
+        GetStringInfoDatum(plaintext));
+      if (count <= 0)
+        break;
+      SetStringInfoLength(plaintext,(size_t) count);
+    }
+    if (chunks == 0)
       break;
-    length=(size_t) count;
-    SetStringInfoLength(plaintext,length);
-    if (content_info->hmac != NoHash)
-      {
-        ConstructHMAC(content_info->hmac_info,GetAuthenticateKey(
-          content_info->authenticate_info),plaintext);
-        hmac=GetHMACDigest(content_info->hmac_info);
-        count=WriteBlobChunk(content_info->cipherblob,GetStringInfoLength(hmac),
-          GetStringInfoDatum(hmac));
-        if (count != (ssize_t) GetStringInfoLength(hmac))
-          ThrowEncipherContentException(FileError,"unable to write ciphertext "
-            "`%s': `%s'",cipher_filename);
-      }
-    if (content_info->entropy != NoEntropy)
-      {
-        status=IncreaseEntropy(content_info->entropy_info,plaintext,exception);
-        chaos=GetEntropyChaos(content_info->entropy_info);
-        if (status == WizardFalse)
-          ThrowEncipherContentException(FileError,"unable to increase entropy "
-            "`%s': `%s'",cipher_filename);
-        if (GetStringInfoLength(chaos) > length)
+    /*
+      Authenticate, increase the entropy of, and encipher the chunks in
+      parallel.
+    */
+#if defined(WIZARDSTOOLKIT_HAVE_OPENMP)
+    #pragma omp parallel for schedule(static,1) num_threads(chunks)
+#endif
+    for (i=0; i < (ssize_t) chunks; i++)
+    {
+      ChunkInfo
+        *info;
+
+      info=chunk_info[i];
+      info->status=WizardTrue;
+      info->entropy=NoEntropy;
+      if (content_info->hmac != NoHash)
+        ConstructHMAC(info->hmac_info,GetAuthenticateKey(
+          content_info->authenticate_info),info->chunk);
+      if ((content_info->entropy != NoEntropy) &&
+          (IsEntropyIncreasable(info->entropy_info,info->chunk) !=
+           WizardFalse))
+        {
+          const StringInfo
+            *chaos;
+
+          size_t
+            extent;
+
+          info->status=IncreaseEntropy(info->entropy_info,info->chunk,
+            exception);
+          if (info->status == WizardFalse)
+            continue;
+          chaos=GetEntropyChaos(info->entropy_info);
+          extent=GetStringInfoLength(chaos);
+          if (extent <= GetStringInfoLength(info->chunk))
+            {
+              info->entropy=content_info->entropy;
+              SetStringInfo(info->chunk,chaos);
+              SetRandomKey(content_info->random_info,GetStringInfoLength(
+                info->chunk)-extent,GetStringInfoDatum(info->chunk)+extent);
+            }
+        }
+      if (content_info->chunk_nonce != WizardFalse)
+        SetCipherChunkNonce(info->cipher_info,nonce,(WizardSizeType)
+          (chunk+i),content_info->chunksize);
+      else
+        SetCipherNonce(info->cipher_info,nonce);
+      (void) EncipherCipher(info->cipher_info,info->chunk);
+    }
+    /*
+      Write the chunks in order.
+    */
+    for (i=0; i < (ssize_t) chunks; i++)
+    {
+      ciphertext=chunk_info[i]->chunk;
+      length=GetStringInfoLength(ciphertext);
+      if (content_info->hmac != NoHash)
+        {
+          hmac=GetHMACDigest(chunk_info[i]->hmac_info);
+          count=WriteBlobChunk(content_info->cipherblob,GetStringInfoLength(
+            hmac),GetStringInfoDatum(hmac));
+          if (count != (ssize_t) GetStringInfoLength(hmac))
+            ThrowEncipherContentException(FileError,"unable to write "
+              "ciphertext `%s': `%s'",cipher_filename);
+        }
+      if (content_info->entropy != NoEntropy)
+        {
+          if (chunk_info[i]->status == WizardFalse)
+            ThrowEncipherContentException(FileError,"unable to increase "
+              "entropy `%s': `%s'",cipher_filename);
           count=WriteBlobByte(content_info->cipherblob,(unsigned char)
-            NoEntropy);
-        else
-          {
-            SetStringInfo(plaintext,chaos);
-            SetRandomKey(content_info->random_info,length-GetStringInfoLength(
-              chaos),GetStringInfoDatum(plaintext)+GetStringInfoLength(chaos));
-            count=WriteBlobByte(content_info->cipherblob,(unsigned char)
-              content_info->entropy);
-          }
-        if (count != 1)
-          ThrowEncipherContentException(FileError,"unable to write ciphertext "
-            "`%s': `%s'",cipher_filename);
-      }
-    ciphertext=EncipherCipher(content_info->cipher_info,plaintext);
-    if (content_info->mode != CFBMode)
-      {
-        pad=blocksize-length % blocksize;
-        if (pad != blocksize)
-          length+=pad;
-      }
-    count=WriteBlobChunk(content_info->cipherblob,length,GetStringInfoDatum(
-      ciphertext));
-    if (count != (ssize_t) length)
-      ThrowEncipherContentException(FileError,"unable to write ciphertext "
-        "`%s': `%s'",cipher_filename);
-    if (SyncBlob(content_info->cipherblob) != WizardFalse)
-      ThrowEncipherContentException(FileError,"unable to sync ciphertext `%s': "
-        "`%s'",cipher_filename);
+            chunk_info[i]->entropy);
+          if (count != 1)
+            ThrowEncipherContentException(FileError,"unable to write "
+              "ciphertext `%s': `%s'",cipher_filename);
+        }
+      if (content_info->mode != CFBMode)
+        {
+          pad=blocksize-length % blocksize;
+          if (pad != blocksize)
+            length+=pad;
+        }
+      count=WriteBlobChunk(content_info->cipherblob,length,GetStringInfoDatum(
+        ciphertext));
+      if (count != (ssize_t) length)
+        ThrowEncipherContentException(FileError,"unable to write ciphertext "
+          "`%s': `%s'",cipher_filename);
+      if ((content_info->sync == ChunkSync) &&
+          (SyncBlob(content_info->cipherblob) != WizardFalse))
+        ThrowEncipherContentException(FileError,"unable to sync ciphertext "
+          "`%s': `%s'",cipher_filename);
+    }
+    if (chunk_info[chunks] != (ChunkInfo *) NULL)
+      break;
   }
   if ((content_info->mode != CFBMode) && (pad == blocksize))
     {
@@ -899,7 +1410,56 @@ static WizardBooleanType EncipherContent(ContentInfo *content_info,
     ThrowFileException(exception,FileError,content_info->content);
   if (CloseBlob(content_info->plainblob) != WizardFalse)
     ThrowFileException(exception,FileError,content_info->content);
-  plaintext=DestroyStringInfo(plaintext);
+  chunk_info=DestroyChunkInfoThreadSet(chunk_info);
+  return(WizardTrue);
+}
+
+/*
+%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%
+%                                                                             %
+%                                                                             %
+%                                                                             %
+%   G e n e r a t e C o n t e n t K e y                                       %
+%                                                                             %
+%                                                                             %
+%                                                                             %
+%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%
+%
+%  GenerateContentKey() generates the authenticated cipher key and its id,
+%  and seeds the random reservoir used to increase the content entropy.
+%
+%  The format of the GenerateContentKey method is:
+%
+%      WizardBooleanType GenerateContentKey(ContentInfo *content_info,
+%        ExceptionInfo *exception)
+%
+%  A description of each parameter follows:
+%
+%    o content_info: the cipher options.
+%
+%    o exception: return any exceptions in this structure.
+%
+*/
+static WizardBooleanType GenerateContentKey(ContentInfo *content_info,
+  ExceptionInfo *exception)
+{
+  WizardBooleanType
+    status;
+
+  content_info->authenticate_info=AcquireAuthenticateInfo(
+    content_info->authenticate_method,content_info->keyring,
+    content_info->key_hash);
+  if (content_info->passphrase != (char *) NULL)
+    SetAuthenticatePassphrase(content_info->authenticate_info,
+      content_info->passphrase);
+  SetAuthenticateKeyLength(content_info->authenticate_info,
+    content_info->key_length);
+  status=GenerateAuthenticateKey(content_info->authenticate_info,exception);
+  if (status == WizardFalse)
+    return(WizardFalse);
+  content_info->id=StringInfoToHexString(GetAuthenticateId(
+    content_info->authenticate_info));
+  content_info->random_info=AcquireRandomInfo(content_info->random_hash);
   return(WizardTrue);
 }
 
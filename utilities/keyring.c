@@ -95,9 +95,13 @@ static void KeyringUsage()
   static const char
     *options[]=
     {
+      "-compact             rewrite the keyring without its deleted keys",
       "-debug events        display copious debugging information",
+      "-delete id           delete a key from your keyring",
       "-export id           export a key from your keyring",
+      "-export-all          export all keys to a keyring",
       "-help                print program options",
+      "-import-many         import all keys of the keyrings to your keyring",
       "-list type           print a list of supported option arguments",
       "-log format          format of debugging information",
       "-version             print version information",
@@ -112,8 +116,16 @@ static void KeyringUsage()
   (void) fprintf(stdout,"Copyright: %s\n\n",GetWizardCopyright());
   (void) fprintf(stdout,"Usage: %s [options ...] [ keyring ...] keyring.rdf\n",
     GetClientName());
+  (void) fprintf(stdout,"       %s [options ...] -compact [ keyring.xdm ...]\n",
+    GetClientName());
+  (void) fprintf(stdout,"       %s [options ...] -delete id [ keyring.xdm ]\n",
+    GetClientName());
   (void) fprintf(stdout,"       %s [options ...] -export id [ keyring ...] "
     "keyring.xdm\n",GetClientName());
+  (void) fprintf(stdout,"       %s [options ...] -export-all [ keyring ...] "
+    "keyring.xdm\n",GetClientName());
+  (void) fprintf(stdout,"       %s [options ...] -import-many keyring.xdm "
+    "[ keyring ...]\n",GetClientName());
   (void) fprintf(stdout,"\nWhere options include:\n");
   for (p=options; *p != (char *) NULL; p++)
     (void) fprintf(stdout,"  %s\n",*p);
@@ -313,6 +325,260 @@ WizardExport WizardBooleanType ExportKeyring(int argc,char **argv,
   return(status);
 }
 
+static WizardBooleanType AppendKeyringKeys(const char *path,
+  KeyringInfo ***keyring_info,size_t *number_keys,ExceptionInfo *exception)
+{
+  KeyringInfo
+    **keys;
+
+  register ssize_t
+    i;
+
+  size_t
+    number_exports;
+
+  keys=ExportKeyringKeys(path,&number_exports,exception);
+  if (keys == (KeyringInfo **) NULL)
+    return(WizardFalse);
+  *keyring_info=(KeyringInfo **) ResizeQuantumMemory(*keyring_info,
+    *number_keys+number_exports+1,sizeof(**keyring_info));
+  if (*keyring_info == (KeyringInfo **) NULL)
+    ThrowWizardFatalError(KeyringDomain,MemoryError);
+  for (i=0; i < (ssize_t) number_exports; i++)
+    (*keyring_info)[(*number_keys)++]=keys[i];
+  keys=(KeyringInfo **) RelinquishWizardMemory(keys);
+  return(WizardTrue);
+}
+
+static WizardBooleanType MergeKeyring(int argc,char **argv,
+  const WizardBooleanType import,ExceptionInfo *exception)
+{
+  const char
+    *option,
+    *target;
+
+  KeyringInfo
+    **keyring_info;
+
+  register ssize_t
+    i;
+
+  size_t
+    number_keyrings,
+    number_keys;
+
+  ssize_t
+    last;
+
+  WizardBooleanType
+    status;
+
+  /*
+    Parse command-line options.
+  */
+  number_keyrings=0;
+  for (i=1; i < (ssize_t) argc; i++)
+  {
+    option=argv[i];
+    if (IsWizardOption(option) == WizardFalse)
+      {
+        number_keyrings++;
+        continue;
+      }
+    if ((LocaleCompare(option,"-debug") == 0) ||
+        (LocaleCompare(option,"-log") == 0))
+      {
+        i++;
+        if (i == (ssize_t) argc)
+          {
+            (void) ThrowWizardException(exception,GetWizardModule(),
+              OptionError,"missing argument: `%s'",option);
+            return(WizardFalse);
+          }
+        if ((LocaleCompare(option,"-debug") == 0) &&
+            (SetLogEventMask(argv[i]) == UndefinedEvents))
+          {
+            (void) ThrowWizardException(exception,GetWizardModule(),
+              OptionFatalError,"unrecognized log event type: `%s'",argv[i]);
+            return(WizardFalse);
+          }
+        continue;
+      }
+    if ((LocaleCompare(option+1,"export-all") == 0) ||
+        (LocaleCompare(option+1,"import-many") == 0))
+      continue;
+    (void) ThrowWizardException(exception,GetWizardModule(),OptionFatalError,
+      "unrecognized option: `%s'",option);
+    return(WizardFalse);
+  }
+  if (number_keyrings == 0)
+    {
+      (void) ThrowWizardException(exception,GetWizardModule(),OptionError,
+        "missing keyring: `%s'",import != WizardFalse ? "-import-many" :
+        "-export-all");
+      return(WizardFalse);
+    }
+  /*
+    Export the keys of each source keyring, then import them to the target
+    keyring in one transaction: -export-all copies the listed keyrings (or
+    yours) to the last keyring, -import-many copies the listed keyrings to
+    yours.
+  */
+  target=(const char *) NULL;
+  last=(ssize_t) argc;
+  if (import == WizardFalse)
+    {
+      target=argv[argc-1];
+      last=(ssize_t) argc-1;
+    }
+  keyring_info=(KeyringInfo **) NULL;
+  number_keys=0;
+  status=WizardTrue;
+  for (i=1; (i < last) && (status != WizardFalse); i++)
+  {
+    option=argv[i];
+    if (IsWizardOption(option) == WizardFalse)
+      {
+        status=AppendKeyringKeys(option,&keyring_info,&number_keys,exception);
+        continue;
+      }
+    if ((LocaleCompare(option,"-debug") == 0) ||
+        (LocaleCompare(option,"-log") == 0))
+      i++;
+  }
+  if ((import == WizardFalse) && (number_keyrings == 1))
+    status=AppendKeyringKeys((const char *) NULL,&keyring_info,&number_keys,
+      exception);
+  if (status != WizardFalse)
+    status=ImportKeyringKeys(target,keyring_info,number_keys,exception);
+  for (i=0; i < (ssize_t) number_keys; i++)
+    keyring_info[i]=DestroyKeyringInfo(keyring_info[i]);
+  if (keyring_info != (KeyringInfo **) NULL)
+    keyring_info=(KeyringInfo **) RelinquishWizardMemory(keyring_info);
+  return(status);
+}
+
+static WizardBooleanType ReviseKeyring(int argc,char **argv,
+  ExceptionInfo *exception)
+{
+  const char
+    *keyring,
+    *option;
+
+  KeyringInfo
+    *keyring_info;
+
+  register ssize_t
+    i;
+
+  size_t
+    number_keyrings;
+
+  StringInfo
+    *id;
+
+  WizardBooleanType
+    compact,
+    status;
+
+  /*
+    Parse command-line options.
+  */
+  compact=WizardFalse;
+  id=(StringInfo *) NULL;
+  keyring=(const char *) NULL;
+  number_keyrings=0;
+  status=WizardTrue;
+  for (i=1; (i < (ssize_t) argc) && (status != WizardFalse); i++)
+  {
+    option=argv[i];
+    if (IsWizardOption(option) == WizardFalse)
+      {
+        keyring=option;
+        number_keyrings++;
+        continue;
+      }
+    if (LocaleCompare(option+1,"compact") == 0)
+      {
+        compact=WizardTrue;
+        continue;
+      }
+    if ((LocaleCompare(option,"-debug") == 0) ||
+        (LocaleCompare(option,"-delete") == 0) ||
+        (LocaleCompare(option,"-log") == 0))
+      {
+        i++;
+        if (i == (ssize_t) argc)
+          {
+            (void) ThrowWizardException(exception,GetWizardModule(),
+              OptionError,"missing argument: `%s'",option);
+            status=WizardFalse;
+            break;
+          }
+        if ((LocaleCompare(option,"-debug") == 0) &&
+            (SetLogEventMask(argv[i]) == UndefinedEvents))
+          {
+            (void) ThrowWizardException(exception,GetWizardModule(),
+              OptionFatalError,"unrecognized log event type: `%s'",argv[i]);
+            status=WizardFalse;
+          }
+        if (LocaleCompare(option,"-delete") == 0)
+          {
+            if (id != (StringInfo *) NULL)
+              id=DestroyStringInfo(id);
+            id=HexStringToStringInfo(argv[i]);
+          }
+        continue;
+      }
+    (void) ThrowWizardException(exception,GetWizardModule(),OptionFatalError,
+      "unrecognized option: `%s'",option);
+    status=WizardFalse;
+  }
+  if ((status != WizardFalse) && (id != (StringInfo *) NULL))
+    {
+      /*
+        Delete key from keyring.
+      */
+      if (number_keyrings > 1)
+        {
+          (void) ThrowWizardException(exception,GetWizardModule(),OptionError,
+            "too many keyrings: `%s'","-delete");
+          status=WizardFalse;
+        }
+      else
+        {
+          keyring_info=AcquireKeyringInfo(keyring);
+          SetKeyringId(keyring_info,id);
+          status=DeleteKeyringKey(keyring_info,exception);
+          keyring_info=DestroyKeyringInfo(keyring_info);
+        }
+    }
+  if (id != (StringInfo *) NULL)
+    id=DestroyStringInfo(id);
+  if ((status == WizardFalse) || (compact == WizardFalse))
+    return(status);
+  /*
+    Compact keyrings.
+  */
+  if (number_keyrings == 0)
+    return(CompactKeyring((const char *) NULL,exception));
+  for (i=1; i < (ssize_t) argc; i++)
+  {
+    option=argv[i];
+    if (IsWizardOption(option) == WizardFalse)
+      {
+        if (CompactKeyring(option,exception) == WizardFalse)
+          status=WizardFalse;
+        continue;
+      }
+    if ((LocaleCompare(option,"-debug") == 0) ||
+        (LocaleCompare(option,"-delete") == 0) ||
+        (LocaleCompare(option,"-log") == 0))
+      i++;
+  }
+  return(status);
+}
+
 WizardExport WizardBooleanType KeyringCommand(int argc,char **argv,
   ExceptionInfo *exception)
 {
@@ -370,15 +636,32 @@ WizardExport WizardBooleanType KeyringCommand(int argc,char **argv,
   if (status == WizardFalse)
     ThrowKeyringException(ResourceError,"memory allocation failed: `%s'",
       strerror(errno));
-  for (i=1; i < (argc-1); i++)
+  for (i=1; i < argc; i++)
   {
     option=argv[i];
+    if ((LocaleCompare(option+1,"compact") == 0) ||
+        (LocaleCompare(option,"-delete") == 0))
+      {
+        status=ReviseKeyring(argc,argv,exception);
+        DestroyKeyring();
+        return(status);
+      }
+    if (i == (argc-1))
+      break;
     if (LocaleCompare(option+1,"export") == 0)
       {
         status=ExportKeyring(argc,argv,exception);
         DestroyKeyring();
         return(status);
       }
+    if ((LocaleCompare(option+1,"export-all") == 0) ||
+        (LocaleCompare(option+1,"import-many") == 0))
+      {
+        status=MergeKeyring(argc,argv,LocaleCompare(option+1,"import-many") ==
+          0 ? WizardTrue : WizardFalse,exception);
+        DestroyKeyring();
+        return(status);
+      }
   }
   keyring_blob=OpenBlob(argv[argc-1],WriteBinaryBlobMode,WizardTrue,exception);
   if (keyring_blob == (BlobInfo *) NULL)
@@ -49,6 +49,18 @@
 #include "wizard/utility-private.h"
 #include "utility_.h"
 
+/*
+  Typedef declarations.
+*/
+typedef struct _DirectoryEntry
+{
+  char
+    *name;
+
+  WizardBooleanType
+    directory;
+} DirectoryEntry;
+
 /*
   Forward declaration.
 */
@@ -511,3 +523,258 @@ static char **ListFiles(const char *directory,const char *pattern,
     FileCompare);
   return(filelist);
 }
+
+/*
+%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%
+%                                                                             %
+%                                                                             %
+%                                                                             %
++   W a l k D i r e c t o r y                                                 %
+%                                                                             %
+%                                                                             %
+%                                                                             %
+%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%
+%
+%  WalkDirectory() visits a directory and then each file and directory below
+%  it, in ascending order of their names.  Directories are opened relative to
+%  the descriptor of their parent directory so each path component is
+%  resolved only once.  If path is not a directory, only path itself is
+%  visited.  Symbolic links to directories are not followed.
+%
+%  The format of the WalkDirectory function is:
+%
+%      WizardBooleanType WalkDirectory(const char *path,const char *include,
+%        const char *exclude,VisitPathMethod visit,void *context)
+%
+%  A description of each parameter follows:
+%
+%    o path: the directory path.
+%
+%    o include: visit only files whose name matches this glob pattern, or
+%      NULL for all files.
+%
+%    o exclude: skip files and directories whose name matches this glob
+%      pattern, or NULL to skip none.
+%
+%    o visit: this method is called with the path of each file or directory,
+%      whether it is a directory, and the context.
+%
+%    o context: the visit context.
+%
+*/
+
+#if defined(__cplusplus) || defined(c_plusplus)
+extern "C" {
+#endif
+
+static int DirectoryEntryCompare(const void *x,const void *y)
+{
+  register const DirectoryEntry
+    *p,
+    *q;
+
+  p=(const DirectoryEntry *) x;
+  q=(const DirectoryEntry *) y;
+  return(strcmp(p->name,q->name));
+}
+
+#if defined(__cplusplus) || defined(c_plusplus)
+}
+#endif
+
+#if defined(WIZARDSTOOLKIT_HAVE_OPENAT) && \
+    defined(WIZARDSTOOLKIT_HAVE_FDOPENDIR) && \
+    defined(WIZARDSTOOLKIT_HAVE_FSTATAT)
+#define WIZARDSTOOLKIT_HAVE_OPENAT_DIRECTORY  1
+#endif
+
+static WizardBooleanType WalkDirectoryEntries(const int parent,
+  const char *name,const char *path,const char *include,const char *exclude,
+  VisitPathMethod visit,void *context)
+{
+  char
+    *filename;
+
+  DIR
+    *directory;
+
+  DirectoryEntry
+    *entries;
+
+  int
+    status;
+
+  register ssize_t
+    i;
+
+  size_t
+    extent,
+    number_entries;
+
+  struct dirent
+    *entry;
+
+  struct stat
+    attributes;
+
+  WizardBooleanType
+    walk_status;
+
+  /*
+    Read the directory entries.
+  */
+#if defined(WIZARDSTOOLKIT_HAVE_OPENAT_DIRECTORY)
+  {
+    int
+      file,
+      flags;
+
+    flags=O_RDONLY;
+#if defined(O_DIRECTORY)
+    flags|=O_DIRECTORY;
+#endif
+#if defined(O_CLOEXEC)
+    flags|=O_CLOEXEC;
+#endif
+    file=openat(parent,name,flags);
+    if (file == -1)
+      return(WizardFalse);
+    directory=fdopendir(file);
+    if (directory == (DIR *) NULL)
+      {
+        (void) close(file);
+        return(WizardFalse);
+      }
+  }
+#else
+  (void) parent;
+  (void) name;
+  directory=opendir(path);
+  if (directory == (DIR *) NULL)
+    return(WizardFalse);
+#endif
+  extent=1024;
+  number_entries=0;
+  entries=(DirectoryEntry *) AcquireQuantumMemory(extent,sizeof(*entries));
+  if (entries == (DirectoryEntry *) NULL)
+    {
+      (void) closedir(directory);
+      return(WizardFalse);
+    }
+  walk_status=WizardTrue;
+  for (errno=0; (entry=readdir(directory)) != (struct dirent *) NULL; errno=0)
+  {
+    WizardBooleanType
+      is_directory;
+
+    if ((strcmp(entry->d_name,".") == 0) || (strcmp(entry->d_name,"..") == 0))
+      continue;
+    if ((exclude != (const char *) NULL) &&
+        (GlobExpression(entry->d_name,exclude,WizardFalse) != WizardFalse))
+      continue;
+#if defined(WIZARDSTOOLKIT_HAVE_OPENAT_DIRECTORY)
+    status=fstatat(dirfd(directory),entry->d_name,&attributes,
+      AT_SYMLINK_NOFOLLOW);
+#else
+    filename=AcquireString(path);
+    (void) ConcatenateString(&filename,DirectorySeparator);
+    (void) ConcatenateString(&filename,entry->d_name);
+    status=lstat(filename,&attributes);
+    filename=DestroyString(filename);
+#endif
+    if (status != 0)
+      continue;
+    if (S_ISLNK(attributes.st_mode) != 0)
+      {
+        /*
+          Follow symbolic links to files but not to directories.
+        */
+#if defined(WIZARDSTOOLKIT_HAVE_OPENAT_DIRECTORY)
+        status=fstatat(dirfd(directory),entry->d_name,&attributes,0);
+#else
+        filename=AcquireString(path);
+        (void) ConcatenateString(&filename,DirectorySeparator);
+        (void) ConcatenateString(&filename,entry->d_name);
+        status=stat_utf8(filename,&attributes);
+        filename=DestroyString(filename);
+#endif
+        if ((status != 0) || (S_ISREG(attributes.st_mode) == 0))
+          continue;
+      }
+    is_directory=S_ISDIR(attributes.st_mode) != 0 ? WizardTrue : WizardFalse;
+    if ((is_directory == WizardFalse) && (S_ISREG(attributes.st_mode) == 0))
+      continue;
+    if ((is_directory == WizardFalse) && (include != (const char *) NULL) &&
+        (GlobExpression(entry->d_name,include,WizardFalse) == WizardFalse))
+      continue;
+    if (number_entries >= extent)
+      {
+        extent<<=1;
+        entries=(DirectoryEntry *) ResizeQuantumMemory(entries,extent,
+          sizeof(*entries));
+        if (entries == (DirectoryEntry *) NULL)
+          {
+            (void) closedir(directory);
+            return(WizardFalse);
+          }
+      }
+    entries[number_entries].name=ConstantString(entry->d_name);
+    entries[number_entries].directory=is_directory;
+    number_entries++;
+  }
+  if (errno != 0)
+    walk_status=WizardFalse;
+  qsort((void *) entries,number_entries,sizeof(*entries),
+    DirectoryEntryCompare);
+  /*
+    Visit each entry; descend into directories.
+  */
+  for (i=0; i < (ssize_t) number_entries; i++)
+  {
+    filename=AcquireString(path);
+    if ((*filename != '\0') &&
+        (strcmp(filename+strlen(filename)-1,DirectorySeparator) != 0))
+      (void) ConcatenateString(&filename,DirectorySeparator);
+    (void) ConcatenateString(&filename,entries[i].name);
+    if (visit(filename,entries[i].directory,context) == WizardFalse)
+      walk_status=WizardFalse;
+    if (entries[i].directory != WizardFalse)
+      {
+#if defined(WIZARDSTOOLKIT_HAVE_OPENAT_DIRECTORY)
+        status=WalkDirectoryEntries(dirfd(directory),entries[i].name,filename,
+          include,exclude,visit,context);
+#else
+        status=WalkDirectoryEntries(-1,entries[i].name,filename,include,
+          exclude,visit,context);
+#endif
+        if (status == WizardFalse)
+          walk_status=WizardFalse;
+      }
+    filename=DestroyString(filename);
+    entries[i].name=DestroyString(entries[i].name);
+  }
+  entries=(DirectoryEntry *) RelinquishWizardMemory(entries);
+  (void) closedir(directory);
+  return(walk_status);
+}
+
+WizardExport WizardBooleanType WalkDirectory(const char *path,
+  const char *include,const char *exclude,VisitPathMethod visit,void *context)
+{
+  struct stat
+    attributes;
+
+  (void) LogWizardEvent(TraceEvent,GetWizardModule(),"%s",path);
+  assert(path != (const char *) NULL);
+  assert(visit != (VisitPathMethod) NULL);
+  if ((stat_utf8(path,&attributes) != 0) || (S_ISDIR(attributes.st_mode) == 0))
+    return(visit(path,WizardFalse,context));
+  if (visit(path,WizardTrue,context) == WizardFalse)
+    return(WizardFalse);
+#if defined(WIZARDSTOOLKIT_HAVE_OPENAT_DIRECTORY)
+  return(WalkDirectoryEntries(AT_FDCWD,path,path,include,exclude,visit,
+    context));
+#else
+  return(WalkDirectoryEntries(-1,path,path,include,exclude,visit,context));
+#endif
+}
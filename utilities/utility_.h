@@ -22,8 +22,12 @@
 extern "C" {
 #endif
 
+typedef WizardBooleanType
+  (*VisitPathMethod)(const char *,const WizardBooleanType,void *);
+
 extern WizardBooleanType
-  ExpandFilenames(int *,char ***);
+  ExpandFilenames(int *,char ***),
+  WalkDirectory(const char *,const char *,const char *,VisitPathMethod,void *);
 
 #if defined(__cplusplus) || defined(c_plusplus)
 }
@@ -41,11 +41,15 @@ typedef enum
 extern WizardExport BlobInfo
   *DestroyBlob(BlobInfo *),
   *OpenBlob(const char *,const BlobMode,const WizardBooleanType,
-    ExceptionInfo *);
+    ExceptionInfo *),
+  *OpenMemoryBlob(const char *,const void *,const size_t);
 
 extern WizardExport const char
   *GetBlobFilename(const BlobInfo *);
 
+extern WizardExport const void
+  *ReadBlobStream(BlobInfo *,const size_t,void *,ssize_t *);
+
 extern WizardExport const struct stat
   *GetBlobProperties(const BlobInfo *);
 
@@ -66,7 +70,11 @@ extern WizardExport WizardBooleanType
   CloseBlob(BlobInfo *),
   SetBlobExtent(BlobInfo *,const WizardSizeType);
 
+extern WizardExport void
+  SetBlobSynchronize(BlobInfo *,const WizardBooleanType);
+
 extern WizardExport WizardOffsetType
+  SeekBlob(BlobInfo *,const WizardOffsetType,const int),
   TellBlob(const BlobInfo *);
 
 extern WizardExport WizardSizeType
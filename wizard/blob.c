@@ -60,6 +60,7 @@
   Define declarations.
 */
 #define WizardMaxBlobExtent  (8*8192)
+#define WizardMapWindowExtent  (256*1024*1024)
 # if !defined(MAP_ANONYMOUS) && defined(MAP_ANON)
 #  define MAP_ANONYMOUS MAP_ANON
 # endif
@@ -112,7 +113,8 @@ struct _BlobInfo
     eof;
 
   WizardOffsetType
-    offset;
+    offset,
+    window;
 
   WizardSizeType
     size;
@@ -120,6 +122,7 @@ struct _BlobInfo
   WizardBooleanType
     exempt,
     status,
+    synchronize,
     temporary;
 
   StreamType
@@ -134,6 +137,9 @@ struct _BlobInfo
   unsigned char
     *data;
 
+  int
+    descriptor;
+
   WizardBooleanType
     debug;
 
@@ -150,8 +156,15 @@ struct _BlobInfo
 /*
   Forward declarations.
 */
+static int
+  SyncBlobFile(const char *);
+
 static unsigned char
   *DetachBlob(BlobInfo *);
+
+static WizardBooleanType
+  MapBlobWindow(BlobInfo *,const WizardOffsetType),
+  SlideBlobWindow(BlobInfo *,const WizardOffsetType);
 
 /*
 %%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%
@@ -240,7 +253,8 @@ WizardExport WizardBooleanType CloseBlob(BlobInfo *blob_info)
     case FileStream:
     case PipeStream:
     {
-      status=ferror(blob_info->file_info.file);
+      if (status == 0)
+        status=ferror(blob_info->file_info.file);
       break;
     }
     case ZipStream:
@@ -258,7 +272,11 @@ WizardExport WizardBooleanType CloseBlob(BlobInfo *blob_info)
       break;
     }
     case BlobStream:
+    {
+      if (blob_info->status != WizardFalse)
+        status=(-1);  /* a windowed read failed */
       break;
+    }
   }
   blob_info->status=status < 0 ? WizardTrue : WizardFalse;
   blob_info->size=GetBlobSize(blob_info);
@@ -289,6 +307,8 @@ WizardExport WizardBooleanType CloseBlob(BlobInfo *blob_info)
     {
 #if defined(WIZARDSTOOLKIT_ZLIB_DELEGATE)
       status=gzclose(blob_info->file_info.gzfile);
+      if ((status == Z_OK) && (blob_info->synchronize != WizardFalse))
+        status=SyncBlobFile(blob_info->filename);
 #endif
       break;
     }
@@ -296,6 +316,8 @@ WizardExport WizardBooleanType CloseBlob(BlobInfo *blob_info)
     {
 #if defined(WIZARDSTOOLKIT_BZLIB_DELEGATE)
       BZ2_bzclose(blob_info->file_info.bzfile);
+      if (blob_info->synchronize != WizardFalse)
+        status=SyncBlobFile(blob_info->filename);
 #endif
       break;
     }
@@ -390,6 +412,18 @@ static unsigned char *DetachBlob(BlobInfo *blob_info)
   assert(blob_info != (BlobInfo *) NULL);
   if (blob_info->debug != WizardFalse)
     (void) LogWizardEvent(TraceEvent,GetWizardModule(),"...");
+  if (blob_info->descriptor != -1)
+    {
+      /*
+        Release a windowed mapping.
+      */
+      if (blob_info->data != (unsigned char *) NULL)
+        (void) UnmapBlob(blob_info->data,blob_info->length);
+      blob_info->data=(unsigned char *) NULL;
+      RelinquishWizardResource(MapResource,WizardMapWindowExtent);
+      (void) close(blob_info->descriptor);
+      blob_info->descriptor=(-1);
+    }
   if (blob_info->mapped != WizardFalse)
     {
       (void) UnmapBlob(blob_info->data,blob_info->length);
@@ -399,6 +433,7 @@ static unsigned char *DetachBlob(BlobInfo *blob_info)
   blob_info->mapped=WizardFalse;
   blob_info->length=0;
   blob_info->offset=0;
+  blob_info->window=0;
   blob_info->eof=WizardFalse;
   blob_info->exempt=WizardFalse;
   blob_info->type=UndefinedStream;
@@ -714,6 +749,7 @@ WizardExport void GetBlobInfo(BlobInfo *blob_info)
   (void) ResetWizardMemory(blob_info,0,sizeof(*blob_info));
   blob_info->type=UndefinedStream;
   blob_info->quantum=(size_t) WizardMaxBlobExtent;
+  blob_info->descriptor=(-1);
   blob_info->debug=IsEventLogging();
   blob_info->reference_count=1;
   blob_info->semaphore=AcquireSemaphoreInfo();
@@ -795,6 +831,8 @@ WizardExport WizardSizeType GetBlobSize(BlobInfo *blob_info)
     case BlobStream:
     {
       length=(WizardSizeType) blob_info->length;
+      if (blob_info->descriptor != -1)
+        length=(WizardSizeType) blob_info->properties.st_size;
       break;
     }
   }
@@ -928,6 +966,79 @@ WizardExport void *MapBlob(int file,const MapMode mode,
 %                                                                             %
 %                                                                             %
 %                                                                             %
++  M a p B l o b W i n d o w                                                  %
+%                                                                             %
+%                                                                             %
+%                                                                             %
+%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%
+%
+%  MapBlobWindow() replaces the mapped window of a file too large to map at
+%  once with a window that begins at the page that contains the specified file
+%  offset.  It returns WizardFalse if the blob is not windowed or the offset is
+%  at or beyond the end of the file, or if the window cannot be mapped.  On
+%  failure it only unmaps the previous window; the caller decides whether to
+%  revert to buffered reads (see SlideBlobWindow()).
+%
+%  The file is re-stat'ed before each window so a file that shrank is never
+%  mapped beyond its end.  A file truncated while a window is mapped still
+%  raises SIGBUS when the lost pages are read, as with any mapped input.
+%
+%  The format of the MapBlobWindow method is:
+%
+%      WizardBooleanType MapBlobWindow(BlobInfo *blob_info,
+%        const WizardOffsetType offset)
+%
+%  A description of each parameter follows:
+%
+%    o blob_info: the blob info.
+%
+%    o offset: the file offset.
+%
+*/
+static WizardBooleanType MapBlobWindow(BlobInfo *blob_info,
+  const WizardOffsetType offset)
+{
+  size_t
+    length;
+
+  void
+    *map;
+
+  WizardOffsetType
+    window;
+
+  if (blob_info->descriptor == -1)
+    return(WizardFalse);
+  (void) fstat(blob_info->descriptor,&blob_info->properties);
+  if (offset >= (WizardOffsetType) blob_info->properties.st_size)
+    return(WizardFalse);
+  if (blob_info->data != (unsigned char *) NULL)
+    (void) UnmapBlob(blob_info->data,blob_info->length);
+  blob_info->data=(unsigned char *) NULL;
+  blob_info->length=0;
+  blob_info->extent=0;
+  window=offset-(offset % (WizardOffsetType) GetWizardPageSize());
+  length=(size_t) WizardMin((WizardSizeType) WizardMapWindowExtent,
+    (WizardSizeType) (blob_info->properties.st_size-window));
+  map=MapBlob(blob_info->descriptor,ReadMode,window,length);
+  if (map == (void *) NULL)
+    return(WizardFalse);
+#if defined(WIZARDSTOOLKIT_HAVE_MADVISE) && defined(MADV_SEQUENTIAL)
+  (void) madvise(map,length,MADV_SEQUENTIAL);
+#endif
+  blob_info->data=(unsigned char *) map;
+  blob_info->length=length;
+  blob_info->extent=length;
+  blob_info->window=window;
+  blob_info->offset=offset-window;
+  return(WizardTrue);
+}
+
+/*
+%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%
+%                                                                             %
+%                                                                             %
+%                                                                             %
 +   O p e n B l o b                                                           %
 %                                                                             %
 %                                                                             %
@@ -1125,6 +1236,8 @@ WizardExport BlobInfo *OpenBlob(const char *filename,const BlobMode mode,
           length=(size_t) blob_info->properties.st_size;
           if ((blob_info->type == FileStream) &&
               (blob_info->file_info.file != (FILE *) NULL) &&
+              ((WizardSizeType) length == (WizardSizeType)
+               blob_info->properties.st_size) &&
               (length > WizardMaxBufferExtent) &&
               (AcquireWizardResource(MapResource,length) != WizardFalse))
             {
@@ -1139,12 +1252,48 @@ WizardExport BlobInfo *OpenBlob(const char *filename,const BlobMode mode,
                   /*
                     Use memory-mapped I/O.
                   */
+#if defined(WIZARDSTOOLKIT_HAVE_MADVISE) && defined(MADV_SEQUENTIAL)
+                  (void) madvise(blob,length,MADV_SEQUENTIAL);
+#endif
                   (void) fclose(blob_info->file_info.file);
                   blob_info->file_info.file=(FILE *) NULL;
                   AttachBlob(blob_info,blob,length);
                   blob_info->mapped=WizardTrue;
                 }
             }
+          if ((blob_info->type == FileStream) &&
+              (blob_info->file_info.file != (FILE *) NULL) &&
+              ((WizardSizeType) blob_info->properties.st_size >
+               WizardMapWindowExtent) &&
+              (AcquireWizardResource(MapResource,WizardMapWindowExtent) !=
+               WizardFalse))
+            {
+              /*
+                The file exceeds the map budget, map it a window at a time.
+              */
+              blob_info->descriptor=dup(fileno(blob_info->file_info.file));
+              if (blob_info->descriptor == -1)
+                RelinquishWizardResource(MapResource,WizardMapWindowExtent);
+              else
+                {
+                  FILE
+                    *file;
+
+                  file=blob_info->file_info.file;
+                  AttachBlob(blob_info,(void *) NULL,0);
+                  if (MapBlobWindow(blob_info,0) != WizardFalse)
+                    (void) fclose(file);
+                  else
+                    {
+                      (void) close(blob_info->descriptor);
+                      blob_info->descriptor=(-1);
+                      RelinquishWizardResource(MapResource,
+                        WizardMapWindowExtent);
+                      blob_info->type=FileStream;
+                      blob_info->file_info.file=file;
+                    }
+                }
+            }
         }
     }
   else
@@ -1203,6 +1352,53 @@ WizardExport BlobInfo *OpenBlob(const char *filename,const BlobMode mode,
 %                                                                             %
 %                                                                             %
 %                                                                             %
++   O p e n M e m o r y B l o b                                               %
+%                                                                             %
+%                                                                             %
+%                                                                             %
+%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%
+%
+%  OpenMemoryBlob() opens a read-only blob over a region of memory, such as
+%  the leading bytes of a file read with a single system call.  The memory is
+%  not copied and remains owned by the caller; it must outlive the blob.
+%
+%  The format of the OpenMemoryBlob method is:
+%
+%      BlobInfo *OpenMemoryBlob(const char *filename,const void *blob,
+%        const size_t length)
+%
+%  A description of each parameter follows:
+%
+%    o filename: the name reported for the blob.
+%
+%    o blob: the memory region.
+%
+%    o length: the length in bytes of the memory region.
+%
+*/
+WizardExport BlobInfo *OpenMemoryBlob(const char *filename,const void *blob,
+  const size_t length)
+{
+  BlobInfo
+    *blob_info;
+
+  assert(filename != (const char *) NULL);
+  (void) LogWizardEvent(TraceEvent,GetWizardModule(),"%s",filename);
+  blob_info=(BlobInfo *) AcquireWizardMemory(sizeof(*blob_info));
+  if (blob_info == (BlobInfo *) NULL)
+    ThrowFatalException(ResourceFatalError,"memory allocation failed `%s'");
+  GetBlobInfo(blob_info);
+  (void) CopyWizardString(blob_info->filename,filename,WizardPathExtent);
+  AttachBlob(blob_info,blob,length);
+  blob_info->size=(WizardSizeType) length;
+  return(blob_info);
+}
+
+/*
+%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%
+%                                                                             %
+%                                                                             %
+%                                                                             %
 +  R e a d B l o b                                                            %
 %                                                                             %
 %                                                                             %
@@ -1361,17 +1557,33 @@ WizardExport ssize_t ReadBlob(BlobInfo *blob_info,const size_t length,
       register const unsigned char
         *p;
 
-      if (blob_info->offset >= (WizardOffsetType) blob_info->length)
+      size_t
+        extent;
+
+      while (count < (ssize_t) length)
+      {
+        if ((blob_info->offset >= (WizardOffsetType) blob_info->length) &&
+            (SlideBlobWindow(blob_info,blob_info->window+blob_info->offset) ==
+             WizardFalse))
+          break;
+        p=blob_info->data+blob_info->offset;
+        extent=WizardMin(length-count,blob_info->length-blob_info->offset);
+        (void) memcpy(q+count,p,extent);
+        blob_info->offset+=extent;
+        count+=(ssize_t) extent;
+      }
+      if (blob_info->type == FileStream)
         {
-          blob_info->eof=WizardTrue;
+          /*
+            The window could not be mapped, read the remainder buffered.
+          */
+          count+=ReadBlob(blob_info,length-count,q+count);
           break;
         }
-      p=blob_info->data+blob_info->offset;
-      count=(ssize_t) WizardMin(length,blob_info->length-blob_info->offset);
-      blob_info->offset+=count;
+      if (blob_info->status != WizardFalse)
+        return(-1);
       if (count != (ssize_t) length)
         blob_info->eof=WizardTrue;
-      (void) memcpy(q,p,(size_t) count);
       break;
     }
   }
@@ -1400,31 +1612,6 @@ WizardExport ssize_t ReadBlob(BlobInfo *blob_info,const size_t length,
 %    o blob_info: the blob info.
 %
 */
-
-static inline const void *ReadBlobStream(BlobInfo *blob_info,
-  const size_t length,void *data,ssize_t *count)
-{
-  assert(count != (ssize_t *) NULL);
-  assert(blob_info != (BlobInfo *) NULL);
-  if (blob_info->type != BlobStream)
-    {
-      *count=ReadBlob(blob_info,length,data);
-      return(data);
-    }
-  if (blob_info->offset >= (WizardOffsetType) blob_info->length)
-    {
-      *count=0;
-      blob_info->eof=WizardTrue;
-      return(data);
-    }
-  data=blob_info->data+blob_info->offset;
-  *count=(ssize_t) WizardMin(length,blob_info->length-blob_info->offset);
-  blob_info->offset+=(*count);
-  if (*count != (ssize_t) length)
-    blob_info->eof=WizardTrue;
-  return(data);
-}
-
 WizardExport int ReadBlobByte(BlobInfo *blob_info)
 {
   register const unsigned char
@@ -1509,6 +1696,188 @@ WizardExport ssize_t ReadBlobChunk(BlobInfo *blob_info,const size_t length,
 %                                                                             %
 %                                                                             %
 %                                                                             %
++  R e a d B l o b S t r e a m                                                %
+%                                                                             %
+%                                                                             %
+%                                                                             %
+%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%
+%
+%  ReadBlobStream() reads data from the blob.  For a memory mapped blob it
+%  returns a pointer directly into the mapping rather than copying to the
+%  supplied area, sliding the window of a very large file as required.
+%  Otherwise the data is read into the supplied area and it is returned.  The
+%  pointer is valid until the next read from the blob.
+%
+%  The format of the ReadBlobStream method is:
+%
+%      const void *ReadBlobStream(BlobInfo *blob_info,const size_t length,
+%        void *data,ssize_t *count)
+%
+%  A description of each parameter follows:
+%
+%    o blob_info: the blob info.
+%
+%    o length: the number of bytes to read from the blob.
+%
+%    o data: the area to place the information requested from the blob.
+%
+%    o count: returns the number of bytes read.
+%
+*/
+WizardExport const void *ReadBlobStream(BlobInfo *blob_info,
+  const size_t length,void *data,ssize_t *count)
+{
+  assert(count != (ssize_t *) NULL);
+  assert(blob_info != (BlobInfo *) NULL);
+  if (blob_info->type != BlobStream)
+    {
+      *count=ReadBlob(blob_info,length,data);
+      return(data);
+    }
+  if ((blob_info->descriptor != -1) &&
+      ((blob_info->offset+(WizardOffsetType) length) >
+       (WizardOffsetType) blob_info->length))
+    {
+      /*
+        Slide the window so the request is contiguous.
+      */
+      if ((SlideBlobWindow(blob_info,blob_info->window+blob_info->offset) ==
+           WizardFalse) && (blob_info->type != BlobStream))
+        {
+          *count=ReadBlob(blob_info,length,data);
+          return(data);
+        }
+      if (((blob_info->offset+(WizardOffsetType) length) >
+           (WizardOffsetType) blob_info->length) &&
+          ((blob_info->window+(WizardOffsetType) blob_info->length) <
+           (WizardOffsetType) blob_info->properties.st_size))
+        {
+          *count=ReadBlob(blob_info,length,data);
+          return(data);
+        }
+    }
+  if (blob_info->offset >= (WizardOffsetType) blob_info->length)
+    {
+      *count=0;
+      blob_info->eof=WizardTrue;
+      return(data);
+    }
+  data=blob_info->data+blob_info->offset;
+  *count=(ssize_t) WizardMin(length,blob_info->length-blob_info->offset);
+  blob_info->offset+=(*count);
+  if (*count != (ssize_t) length)
+    blob_info->eof=WizardTrue;
+  return(data);
+}
+
+/*
+%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%
+%                                                                             %
+%                                                                             %
+%                                                                             %
++  S e e k B l o b                                                            %
+%                                                                             %
+%                                                                             %
+%                                                                             %
+%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%
+%
+%  SeekBlob() sets the offset in bytes from the beginning of a blob or file
+%  and returns the resulting offset.  It returns -1 if the blob cannot seek,
+%  for example a pipe or a BZIP stream.
+%
+%  The format of the SeekBlob method is:
+%
+%      WizardOffsetType SeekBlob(BlobInfo *blob_info,
+%        const WizardOffsetType offset,const int whence)
+%
+%  A description of each parameter follows:
+%
+%    o blob_info: the blob info.
+%
+%    o offset:  specifies an integral value representing the offset in bytes.
+%
+%    o whence:  SEEK_SET, SEEK_CUR, or SEEK_END: the offset is relative to the
+%      beginning of the blob, the current offset, or the end of the blob.
+%
+*/
+WizardExport WizardOffsetType SeekBlob(BlobInfo *blob_info,
+  const WizardOffsetType offset,const int whence)
+{
+  assert(blob_info != (BlobInfo *) NULL);
+  assert(blob_info->signature == WizardSignature);
+  if (blob_info->debug != WizardFalse)
+    (void) LogWizardEvent(TraceEvent,GetWizardModule(),"%s",
+      blob_info->filename);
+  switch (blob_info->type)
+  {
+    case UndefinedStream:
+    case StandardStream:
+    case PipeStream:
+    case BZipStream:
+      return(-1);
+    case FileStream:
+    {
+      if (fseek(blob_info->file_info.file,offset,whence) < 0)
+        return(-1);
+      break;
+    }
+    case ZipStream:
+    {
+#if defined(WIZARDSTOOLKIT_ZLIB_DELEGATE)
+      if (gzseek(blob_info->file_info.gzfile,(off_t) offset,whence) < 0)
+        return(-1);
+#endif
+      break;
+    }
+    case BlobStream:
+    {
+      WizardOffsetType
+        target;
+
+      switch (whence)
+      {
+        case SEEK_SET:
+        default:
+        {
+          target=offset;
+          break;
+        }
+        case SEEK_CUR:
+        {
+          target=blob_info->window+blob_info->offset+offset;
+          break;
+        }
+        case SEEK_END:
+        {
+          target=(WizardOffsetType) GetBlobSize(blob_info)+offset;
+          break;
+        }
+      }
+      if (target < 0)
+        return(-1);
+      if ((blob_info->descriptor != -1) &&
+          ((target < blob_info->window) || (target >= (blob_info->window+
+           (WizardOffsetType) blob_info->length))) &&
+          (SlideBlobWindow(blob_info,target) == WizardFalse))
+        {
+          if (blob_info->type != BlobStream)
+            return(TellBlob(blob_info));
+          if (target < (WizardOffsetType) blob_info->properties.st_size)
+            return(-1);
+        }
+      blob_info->offset=target-blob_info->window;
+      blob_info->eof=WizardFalse;
+      break;
+    }
+  }
+  return(TellBlob(blob_info));
+}
+
+/*
+%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%
+%                                                                             %
+%                                                                             %
+%                                                                             %
 +  S e t B l o b E x t e n t                                                  %
 %                                                                             %
 %                                                                             %
@@ -1581,6 +1950,8 @@ WizardExport WizardBooleanType SetBlobExtent(BlobInfo *blob_info,
     {
       if (extent != (WizardSizeType) ((size_t) extent))
         return(WizardFalse);
+      if (blob_info->descriptor != -1)
+        return(WizardFalse);
       if (blob_info->mapped != WizardFalse)
         {
           ssize_t
@@ -1635,6 +2006,107 @@ WizardExport WizardBooleanType SetBlobExtent(BlobInfo *blob_info,
 %                                                                             %
 %                                                                             %
 %                                                                             %
++  S e t B l o b S y n c h r o n i z e                                        %
+%                                                                             %
+%                                                                             %
+%                                                                             %
+%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%
+%
+%  SetBlobSynchronize() sets whether SyncBlob() commits file data to stable
+%  storage with fdatasync() after flushing it.  CloseBlob() calls SyncBlob()
+%  so a synchronized blob is durable once it is closed.  A compressed stream
+%  is not durable until its trailer is written, so CloseBlob() commits it by
+%  name after gzclose() or BZ2_bzclose() rather than on each SyncBlob().
+%
+%  The format of the SetBlobSynchronize method is:
+%
+%      void SetBlobSynchronize(BlobInfo *blob_info,
+%        const WizardBooleanType synchronize)
+%
+%  A description of each parameter follows:
+%
+%    o blob_info: the blob info.
+%
+%    o synchronize: commit file data to stable storage when synchronized.
+%
+*/
+WizardExport void SetBlobSynchronize(BlobInfo *blob_info,
+  const WizardBooleanType synchronize)
+{
+  assert(blob_info != (BlobInfo *) NULL);
+  assert(blob_info->signature == WizardSignature);
+  blob_info->synchronize=synchronize;
+}
+
+/*
+%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%
+%                                                                             %
+%                                                                             %
+%                                                                             %
++  S l i d e B l o b W i n d o w                                              %
+%                                                                             %
+%                                                                             %
+%                                                                             %
+%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%
+%
+%  SlideBlobWindow() maps the window of a windowed blob that contains the
+%  specified file offset.  If the window cannot be mapped, the blob reverts to
+%  a buffered file stream positioned at the offset; WizardFalse is returned
+%  and the blob type becomes FileStream.  If it cannot revert either, the blob
+%  status is set and WizardFalse is returned.
+%
+%  The format of the SlideBlobWindow method is:
+%
+%      WizardBooleanType SlideBlobWindow(BlobInfo *blob_info,
+%        const WizardOffsetType offset)
+%
+%  A description of each parameter follows:
+%
+%    o blob_info: the blob info.
+%
+%    o offset: the file offset.
+%
+*/
+static WizardBooleanType SlideBlobWindow(BlobInfo *blob_info,
+  const WizardOffsetType offset)
+{
+  FILE
+    *file;
+
+  if (MapBlobWindow(blob_info,offset) != WizardFalse)
+    return(WizardTrue);
+  if ((blob_info->descriptor == -1) ||
+      (offset >= (WizardOffsetType) blob_info->properties.st_size))
+    return(WizardFalse);
+  /*
+    Revert to buffered reads from the offset.
+  */
+  file=fdopen(blob_info->descriptor,"rb");
+  if ((file == (FILE *) NULL) || (fseek(file,offset,SEEK_SET) != 0))
+    {
+      if (file != (FILE *) NULL)
+        (void) fclose(file);
+      else
+        (void) close(blob_info->descriptor);
+      blob_info->descriptor=(-1);
+      RelinquishWizardResource(MapResource,WizardMapWindowExtent);
+      blob_info->status=WizardTrue;
+      return(WizardFalse);
+    }
+  RelinquishWizardResource(MapResource,WizardMapWindowExtent);
+  blob_info->descriptor=(-1);
+  blob_info->window=0;
+  blob_info->offset=0;
+  blob_info->type=FileStream;
+  blob_info->file_info.file=file;
+  return(WizardFalse);
+}
+
+/*
+%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%
+%                                                                             %
+%                                                                             %
+%                                                                             %
 %  S y n c B l o b                                                            %
 %                                                                             %
 %                                                                             %
@@ -1642,7 +2114,8 @@ WizardExport WizardBooleanType SetBlobExtent(BlobInfo *blob_info,
 %%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%
 %
 %  SyncBlob() flushes the datastream if it is a file or synchonizes the data
-%  attributes if it is an blob.
+%  attributes if it is an blob.  If synchronization is enabled with
+%  SetBlobSynchronize(), file data is also committed to stable storage.
 %
 %  The format of the SyncBlob method is:
 %
@@ -1671,6 +2144,14 @@ WizardExport int SyncBlob(BlobInfo *blob_info)
     case PipeStream:
     {
       status=fflush(blob_info->file_info.file);
+      if ((status != 0) || (blob_info->synchronize == WizardFalse) ||
+          (blob_info->type != FileStream))
+        break;
+#if defined(WIZARDSTOOLKIT_HAVE_FDATASYNC)
+      status=fdatasync(fileno(blob_info->file_info.file));
+#elif defined(WIZARDSTOOLKIT_HAVE_FSYNC)
+      status=fsync(fileno(blob_info->file_info.file));
+#endif
       break;
     }
     case ZipStream:
@@ -1698,6 +2179,58 @@ WizardExport int SyncBlob(BlobInfo *blob_info)
 %                                                                             %
 %                                                                             %
 %                                                                             %
++   S y n c B l o b F i l e                                                   %
+%                                                                             %
+%                                                                             %
+%                                                                             %
+%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%
+%
+%  SyncBlobFile() commits the data of a closed file to stable storage.  The
+%  compressed streams do not expose their descriptor, so the file is reopened
+%  by name once gzclose() or BZ2_bzclose() has written the trailer.
+%
+%  The format of the SyncBlobFile method is:
+%
+%      int SyncBlobFile(const char *path)
+%
+%  A description of each parameter follows:
+%
+%    o path: the file path.
+%
+*/
+static int SyncBlobFile(const char *path)
+{
+  int
+    status;
+
+  status=0;
+#if defined(WIZARDSTOOLKIT_HAVE_FDATASYNC) || defined(WIZARDSTOOLKIT_HAVE_FSYNC)
+  {
+    int
+      file;
+
+    file=open_utf8(path,O_RDONLY | O_BINARY,0);
+    if (file == -1)
+      return(-1);
+#if defined(WIZARDSTOOLKIT_HAVE_FDATASYNC)
+    status=fdatasync(file);
+#else
+    status=fsync(file);
+#endif
+    if (close(file) != 0)
+      status=(-1);
+  }
+#else
+  (void) path;
+#endif
+  return(status);
+}
+
+/*
+%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%
+%                                                                             %
+%                                                                             %
+%                                                                             %
 +  T e l l B l o b                                                            %
 %                                                                             %
 %                                                                             %
@@ -1748,7 +2281,7 @@ WizardExport WizardOffsetType TellBlob(const BlobInfo *blob_info)
       break;
     case BlobStream:
     {
-      offset=blob_info->offset;
+      offset=blob_info->window+blob_info->offset;
       break;
     }
   }
@@ -1950,7 +2483,8 @@ WizardExport ssize_t WriteBlob(BlobInfo *blob_info,const size_t length,
       if ((blob_info->offset+(WizardOffsetType) length) >=
           (WizardOffsetType) blob_info->extent)
         {
-          if (blob_info->mapped != WizardFalse)
+          if ((blob_info->mapped != WizardFalse) ||
+              (blob_info->descriptor != -1))
             return(0);
           blob_info->quantum<<=1;
           blob_info->extent+=length+blob_info->quantum;
@@ -35,6 +35,14 @@ typedef enum
   IOMode
 } MapMode;
 
+typedef enum
+{
+  UndefinedSync,
+  NoSync,
+  ChunkSync,
+  EndSync
+} SyncType;
+
 typedef struct _BlobInfo
   BlobInfo;
 
@@ -1400,6 +1400,98 @@ WizardExport void SetCipherNonce(CipherInfo *cipher_info,
   WizardAssert(CipherDomain,nonce != (StringInfo *) NULL);
   SetStringInfo(cipher_info->nonce,nonce);
 }
+
+/*
+%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%
+%                                                                             %
+%                                                                             %
+%                                                                             %
+%   S e t C i p h e r C h u n k N o n c e                                     %
+%                                                                             %
+%                                                                             %
+%                                                                             %
+%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%
+%
+%  SetCipherChunkNonce() sets the initialization vector for one chunk of a
+%  message that is enciphered in chunks, derived from the message nonce and the
+%  chunk number, so each chunk can be enciphered or deciphered independently
+%  of the others.  In CTR mode the counter is advanced past every block of the
+%  preceding chunks, so no counter repeats within the message.  In the other
+%  modes the message nonce is exclusive-ORed with the chunk number and then
+%  enciphered with the key, giving each chunk a distinct, unpredictable
+%  initialization vector.  The cipher key must be set first.
+%
+%  The format of the SetCipherChunkNonce method is:
+%
+%      SetCipherChunkNonce(CipherInfo *cipher_info,const StringInfo *nonce,
+%        const WizardSizeType chunk,const size_t chunksize)
+%
+%  A description of each parameter follows:
+%
+%    o cipher_info: The cipher context.
+%
+%    o nonce: The message initialization vector.
+%
+%    o chunk: The chunk number.
+%
+%    o chunksize: The maximum number of bytes in a chunk.
+%
+*/
+WizardExport void SetCipherChunkNonce(CipherInfo *cipher_info,
+  const StringInfo *nonce,const WizardSizeType chunk,const size_t chunksize)
+{
+  register ssize_t
+    i;
+
+  register unsigned char
+    *p;
+
+  WizardSizeType
+    sum,
+    value;
+
+  (void) LogWizardEvent(TraceEvent,GetWizardModule(),"...");
+  WizardAssert(CipherDomain,cipher_info != (CipherInfo *) NULL);
+  WizardAssert(CipherDomain,cipher_info->signature == WizardSignature);
+  WizardAssert(CipherDomain,nonce != (StringInfo *) NULL);
+  SetStringInfo(cipher_info->nonce,nonce);
+  p=GetStringInfoDatum(cipher_info->nonce);
+  switch (cipher_info->mode)
+  {
+    case CTRMode:
+    {
+      /*
+        A chunk enciphers at most chunksize/blocksize+1 counter blocks.
+      */
+      value=chunk*(chunksize/cipher_info->blocksize+1);
+      sum=0;
+      for (i=(ssize_t) cipher_info->blocksize-1; i >= 0; i--)
+      {
+        sum+=(WizardSizeType) p[i]+(value & 0xff);
+        p[i]=(unsigned char) sum;
+        sum>>=8;
+        value>>=8;
+        if ((value == 0) && (sum == 0))
+          break;
+      }
+      break;
+    }
+    case ECBMode:
+      break;
+    default:
+    {
+      value=chunk;
+      for (i=(ssize_t) cipher_info->blocksize-1; (i >= 0) && (value != 0); i--)
+      {
+        p[i]^=(unsigned char) value;
+        value>>=8;
+      }
+      cipher_info->encipher_block(cipher_info->handle,p,p);
+      break;
+    }
+  }
+}
+
 
 /*
 %%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%
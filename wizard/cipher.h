@@ -66,6 +66,8 @@ extern WizardExport size_t
 
 extern WizardExport void
   ResetCipherNonce(CipherInfo *),
+  SetCipherChunkNonce(CipherInfo *,const StringInfo *,const WizardSizeType,
+    const size_t),
   SetCipherNonce(CipherInfo *,const StringInfo *),
   SetCipherKey(CipherInfo *,const StringInfo *);
 
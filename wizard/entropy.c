@@ -45,9 +45,20 @@
 #include "wizard/entropy.h"
 #include "wizard/exception.h"
 #include "wizard/exception-private.h"
+#include "wizard/lz4.h"
 #include "wizard/lzma.h"
 #include "wizard/memory_.h"
 #include "wizard/zip.h"
+#include "wizard/zstd.h"
+
+/*
+  Define declarations.
+*/
+#define EntropyBackoffLimit  64
+#define EntropyBackoffThreshold  4
+#define EntropySampleExtent  4096
+#define EntropySamples  16
+#define EntropyThreshold  7.9
 
 /*
   Typedef declarations.
@@ -60,6 +71,11 @@ struct _EntropyInfo
   void
     *handle;
 
+  size_t
+    incompressible,
+    backoff,
+    skip;
+
   time_t
     timestamp;
 
@@ -110,6 +126,11 @@ WizardExport EntropyInfo *AcquireEntropyInfo(const EntropyType entropy,
       entropy_info->handle=(EntropyInfo *) AcquireBZIPInfo(level);
       break;
     }
+    case LZ4Entropy:
+    {
+      entropy_info->handle=(EntropyInfo *) AcquireLZ4Info(level);
+      break;
+    }
     case LZMAEntropy:
     {
       entropy_info->handle=(EntropyInfo *) AcquireLZMAInfo(level);
@@ -120,6 +141,11 @@ WizardExport EntropyInfo *AcquireEntropyInfo(const EntropyType entropy,
       entropy_info->handle=(EntropyInfo *) AcquireZIPInfo(level);
       break;
     }
+    case ZSTDEntropy:
+    {
+      entropy_info->handle=(EntropyInfo *) AcquireZSTDInfo(level);
+      break;
+    }
     default:
       ThrowWizardFatalError(EntropyDomain,EnumerateError);
   }
@@ -165,6 +191,12 @@ WizardExport EntropyInfo *DestroyEntropyInfo(EntropyInfo *entropy_info)
           entropy_info->handle);
         break;
       }
+      case LZ4Entropy:
+      {
+        entropy_info->handle=(void *) DestroyLZ4Info((LZ4Info *)
+          entropy_info->handle);
+        break;
+      }
       case LZMAEntropy:
       {
         entropy_info->handle=(void *) DestroyLZMAInfo((LZMAInfo *)
@@ -177,6 +209,12 @@ WizardExport EntropyInfo *DestroyEntropyInfo(EntropyInfo *entropy_info)
           entropy_info->handle);
         break;
       }
+      case ZSTDEntropy:
+      {
+        entropy_info->handle=(void *) DestroyZSTDInfo((ZSTDInfo *)
+          entropy_info->handle);
+        break;
+      }
       default:
         break;
     }
@@ -229,6 +267,15 @@ WizardExport const StringInfo *GetEntropyChaos(const EntropyInfo *entropy_info)
       chaos=GetBZIPChaos(bzip_info);
       break;
     }
+    case LZ4Entropy:
+    {
+      LZ4Info
+        *lz4_info;
+
+      lz4_info=(LZ4Info *) entropy_info->handle;
+      chaos=GetLZ4Chaos(lz4_info);
+      break;
+    }
     case LZMAEntropy:
     {
       LZMAInfo
@@ -247,6 +294,15 @@ WizardExport const StringInfo *GetEntropyChaos(const EntropyInfo *entropy_info)
       chaos=GetZIPChaos(zip_info);
       break;
     }
+    case ZSTDEntropy:
+    {
+      ZSTDInfo
+        *zstd_info;
+
+      zstd_info=(ZSTDInfo *) entropy_info->handle;
+      chaos=GetZSTDChaos(zstd_info);
+      break;
+    }
     default:
       ThrowWizardFatalError(EntropyDomain,EnumerateError);
   }
@@ -305,6 +361,15 @@ WizardExport WizardBooleanType IncreaseEntropy(EntropyInfo *entropy_info,
       status=IncreaseBZIP(bzip_info,message,exception);
       break;
     }
+    case LZ4Entropy:
+    {
+      LZ4Info
+        *lz4_info;
+
+      lz4_info=(LZ4Info *) entropy_info->handle;
+      status=IncreaseLZ4(lz4_info,message,exception);
+      break;
+    }
     case LZMAEntropy:
     {
       LZMAInfo
@@ -323,9 +388,32 @@ WizardExport WizardBooleanType IncreaseEntropy(EntropyInfo *entropy_info,
       status=IncreaseZIP(zip_info,message,exception);
       break;
     }
+    case ZSTDEntropy:
+    {
+      ZSTDInfo
+        *zstd_info;
+
+      zstd_info=(ZSTDInfo *) entropy_info->handle;
+      status=IncreaseZSTD(zstd_info,message,exception);
+      break;
+    }
     default:
       ThrowWizardFatalError(EntropyDomain,EnumerateError);
   }
+  if (status != WizardFalse)
+    {
+      /*
+        Track consecutive incompressible messages for IsEntropyIncreasable().
+      */
+      if (GetStringInfoLength(GetEntropyChaos(entropy_info)) <
+          GetStringInfoLength(message))
+        {
+          entropy_info->incompressible=0;
+          entropy_info->backoff=0;
+        }
+      else
+        entropy_info->incompressible++;
+    }
   return(status);
 }
 
@@ -334,6 +422,124 @@ WizardExport WizardBooleanType IncreaseEntropy(EntropyInfo *entropy_info,
 %                                                                             %
 %                                                                             %
 %                                                                             %
+%   I s E n t r o p y I n c r e a s a b l e                                   %
+%                                                                             %
+%                                                                             %
+%                                                                             %
+%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%
+%
+%  IsEntropyIncreasable() returns WizardTrue if IncreaseEntropy() is likely to
+%  shrink the message.  A byte histogram of evenly spaced samples of the
+%  message estimates its Shannon entropy; messages that are already near 8
+%  bits per byte (e.g. JPEG, MP4, or gzip content) are reported as
+%  incompressible.  After several consecutive incompressible messages, the
+%  next messages are skipped without sampling, with the number skipped
+%  doubling each time up to a limit.  A compressible message resets the
+%  backoff.
+%
+%  The format of the IsEntropyIncreasable method is:
+%
+%      WizardBooleanType IsEntropyIncreasable(EntropyInfo *entropy_info,
+%        const StringInfo *message)
+%
+%  A description of each parameter follows:
+%
+%    o entropy_info: The entropy info.
+%
+%    o message: The message.
+%
+*/
+WizardExport WizardBooleanType IsEntropyIncreasable(EntropyInfo *entropy_info,
+  const StringInfo *message)
+{
+  double
+    entropy,
+    probability;
+
+  register const unsigned char
+    *p;
+
+  register ssize_t
+    i;
+
+  size_t
+    extent,
+    histogram[256],
+    length,
+    samples,
+    total;
+
+  ssize_t
+    j;
+
+  (void) LogWizardEvent(TraceEvent,GetWizardModule(),"...");
+  WizardAssert(EntropyDomain,entropy_info != (EntropyInfo *) NULL);
+  WizardAssert(EntropyDomain,entropy_info->signature == WizardSignature);
+  WizardAssert(EntropyDomain,message != (const StringInfo *) NULL);
+  if (entropy_info->entropy == NoEntropy)
+    return(WizardFalse);
+  if (entropy_info->skip != 0)
+    {
+      entropy_info->skip--;
+      return(WizardFalse);
+    }
+  if (entropy_info->incompressible >= EntropyBackoffThreshold)
+    {
+      /*
+        Back off after consecutive incompressible messages.
+      */
+      entropy_info->backoff=entropy_info->backoff == 0 ? 1 :
+        2*entropy_info->backoff;
+      if (entropy_info->backoff > EntropyBackoffLimit)
+        entropy_info->backoff=EntropyBackoffLimit;
+      entropy_info->skip=entropy_info->backoff-1;
+      entropy_info->incompressible=EntropyBackoffThreshold-1;
+      return(WizardFalse);
+    }
+  length=GetStringInfoLength(message);
+  if (length < EntropySampleExtent)
+    return(WizardTrue);
+  /*
+    Estimate the message entropy from evenly spaced samples.
+  */
+  (void) ResetWizardMemory(histogram,0,sizeof(histogram));
+  extent=length;
+  samples=1;
+  if (length > (EntropySamples*EntropySampleExtent))
+    {
+      extent=EntropySampleExtent;
+      samples=EntropySamples;
+    }
+  total=0;
+  for (j=0; j < (ssize_t) samples; j++)
+  {
+    p=GetStringInfoDatum(message);
+    if (samples > 1)
+      p+=j*(length-extent)/(samples-1);
+    for (i=0; i < (ssize_t) extent; i++)
+      histogram[*p++]++;
+    total+=extent;
+  }
+  entropy=0.0;
+  for (i=0; i < 256; i++)
+  {
+    if (histogram[i] == 0)
+      continue;
+    probability=(double) histogram[i]/total;
+    entropy-=probability*log(probability);
+  }
+  entropy/=log(2.0);
+  if (entropy < EntropyThreshold)
+    return(WizardTrue);
+  entropy_info->incompressible++;
+  return(WizardFalse);
+}
+
+/*
+%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%
+%                                                                             %
+%                                                                             %
+%                                                                             %
 %   R e s t o r e E n t r o p y                                               %
 %                                                                             %
 %                                                                             %
@@ -384,6 +590,15 @@ WizardExport WizardBooleanType RestoreEntropy(EntropyInfo *entropy_info,
       status=RestoreBZIP(bzip_info,length,message,exception);
       break;
     }
+    case LZ4Entropy:
+    {
+      LZ4Info
+        *lz4_info;
+
+      lz4_info=(LZ4Info *) entropy_info->handle;
+      status=RestoreLZ4(lz4_info,length,message,exception);
+      break;
+    }
     case LZMAEntropy:
     {
       LZMAInfo
@@ -402,6 +617,15 @@ WizardExport WizardBooleanType RestoreEntropy(EntropyInfo *entropy_info,
       status=RestoreZIP(zip_info,length,message,exception);
       break;
     }
+    case ZSTDEntropy:
+    {
+      ZSTDInfo
+        *zstd_info;
+
+      zstd_info=(ZSTDInfo *) entropy_info->handle;
+      status=RestoreZSTD(zstd_info,length,message,exception);
+      break;
+    }
     default:
       ThrowWizardFatalError(EntropyDomain,EnumerateError);
   }
@@ -31,7 +31,9 @@ typedef enum
   NoEntropy,
   ZIPEntropy,
   BZIPEntropy,
-  LZMAEntropy
+  LZMAEntropy,
+  ZSTDEntropy,
+  LZ4Entropy
 } EntropyType;
 
 typedef struct _EntropyInfo
@@ -46,6 +48,7 @@ extern WizardExport EntropyInfo
 
 extern WizardExport WizardBooleanType
   IncreaseEntropy(EntropyInfo *,const StringInfo *,ExceptionInfo *),
+  IsEntropyIncreasable(EntropyInfo *,const StringInfo *),
   RestoreEntropy(EntropyInfo *,const size_t,const StringInfo *,ExceptionInfo *);
 
 #if defined(__cplusplus) || defined(c_plusplus)
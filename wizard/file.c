@@ -55,17 +55,38 @@
 #endif
 #if defined(WIZARDSTOOLKIT_WINDOWS_SUPPORT)
 #include <windows.h>
+#else
+#include <sys/file.h>
+#endif
+#if defined(__linux__)
+#include <sys/vfs.h>
 #endif
 
+/*
+  Define declarations.
+*/
+#define NFSFilesystemType  0x6969
+
 /*
   Forward declarations.
 */
 static WizardBooleanType
   RelinquishFileLock(FileInfo *,ExceptionInfo *);
+
+static ssize_t
+  ReadDescriptor(const int,void *,const size_t),
+  WriteDescriptor(const int,const void *,const size_t);
 
 /*
   Typedef declarations.
 */
+typedef enum
+{
+  UndefinedFileLock,
+  DescriptorFileLock,
+  PathFileLock
+} FileLockType;
+
 struct _FileInfo
 {
   char
@@ -74,9 +95,20 @@ struct _FileInfo
   int
     file;
 
+  FileLockType
+    lock;
+
   struct stat
     properties;
 
+  unsigned char
+    *buffer;
+
+  size_t
+    length,
+    offset,
+    pending;
+
   SemaphoreInfo
     *semaphore;
 
@@ -98,7 +130,10 @@ struct _FileInfo
 %                                                                             %
 %%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%
 %
-%  AcquireFileLock() acquires a lock for a file.
+%  AcquireFileLock() acquires a lock for a file by creating a lock file next
+%  to it.  The lock is exclusive and re-entrant for the thread that holds it.
+%  It is the fallback for file systems without kernel advisory locks, such as
+%  NFS.
 %
 %  The format of the AcquireFileLock method is:
 %
@@ -163,8 +198,11 @@ static WizardBooleanType AcquireFileLock(FileInfo *file_info,
           break;
         pid=(-1);
         tid=(~0UL);
-        status=ReadFileChunk(file_info,&pid,sizeof(pid));
-        status&=ReadFileChunk(file_info,&tid,sizeof(tid));
+        status=ReadDescriptor(file_info->file,&pid,sizeof(pid)) ==
+          (ssize_t) sizeof(pid) ? WizardTrue : WizardFalse;
+        if (ReadDescriptor(file_info->file,&tid,sizeof(tid)) !=
+            (ssize_t) sizeof(tid))
+          status=WizardFalse;
         if (close(file_info->file) == -1)
           (void) ThrowWizardException(exception,GetWizardModule(),FileError,
             "unable to close file `%s': %s",path,strerror(errno));
@@ -177,6 +215,7 @@ static WizardBooleanType AcquireFileLock(FileInfo *file_info,
             if ((pid == (ssize_t) getpid()) && (tid == GetWizardThreadId()))
               {
                 path=DestroyString(path);
+                file_info->lock=PathFileLock;
                 UnlockSemaphoreInfo(file_info->semaphore);
                 return(WizardTrue);
               }
@@ -209,9 +248,12 @@ static WizardBooleanType AcquireFileLock(FileInfo *file_info,
         continue;
       }
     pid=(ssize_t) getpid();
-    status=WriteFileChunk(file_info,&pid,sizeof(pid));
+    status=WriteDescriptor(file_info->file,&pid,sizeof(pid)) ==
+      (ssize_t) sizeof(pid) ? WizardTrue : WizardFalse;
     tid=GetWizardThreadId();
-    status=WriteFileChunk(file_info,&tid,sizeof(tid));
+    if (WriteDescriptor(file_info->file,&tid,sizeof(tid)) !=
+        (ssize_t) sizeof(tid))
+      status=WizardFalse;
     if (close(file_info->file) == -1)
       (void) ThrowWizardException(exception,GetWizardModule(),FileError,
         "unable to close file `%s': %s",path,strerror(errno));
@@ -236,7 +278,9 @@ static WizardBooleanType AcquireFileLock(FileInfo *file_info,
 %%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%
 %
 %  AcquireFileInfo() opens the file for reading or writing and returns a
-%  FileInfo structure.
+%  FileInfo structure.  The file is locked until it is destroyed: readers
+%  share the lock, a writer holds it exclusively.  Do not acquire a file the
+%  same thread already holds, the lock is not re-entrant.
 %
 %  The format of the AcquireFileInfo method is:
 %
@@ -254,6 +298,73 @@ static WizardBooleanType AcquireFileLock(FileInfo *file_info,
 %    o exception: Return any errors or warnings in this structure.
 %
 */
+
+static WizardBooleanType IsFileReplaced(FileInfo *file_info)
+{
+  struct stat
+    attributes;
+
+  if (fstat(file_info->file,&file_info->properties) != 0)
+    return(WizardTrue);
+  if (stat_utf8(file_info->path,&attributes) != 0)
+    return(WizardTrue);
+  if ((attributes.st_dev != file_info->properties.st_dev) ||
+      (attributes.st_ino != file_info->properties.st_ino))
+    return(WizardTrue);
+  return(WizardFalse);
+}
+
+static WizardBooleanType LockFileDescriptor(FileInfo *file_info,
+  const FileMode mode)
+{
+  int
+    status;
+
+#if defined(__linux__)
+  {
+    struct statfs
+      attributes;
+
+    /*
+      NFS emulates advisory locks with byte-range locks of the process.
+    */
+    if ((fstatfs(file_info->file,&attributes) == 0) &&
+        (attributes.f_type == NFSFilesystemType))
+      return(WizardFalse);
+  }
+#endif
+#if defined(F_OFD_SETLKW)
+  {
+    struct flock
+      lock;
+
+    /*
+      Open file description locks: released on close, never shared with
+      other threads or descriptors of this process.
+    */
+    (void) ResetWizardMemory(&lock,0,sizeof(lock));
+    lock.l_type=mode == ReadFileMode ? F_RDLCK : F_WRLCK;
+    lock.l_whence=SEEK_SET;
+    do
+    {
+      status=fcntl(file_info->file,F_OFD_SETLKW,&lock);
+    } while ((status == -1) && (errno == EINTR));
+  }
+#elif defined(LOCK_EX)
+  do
+  {
+    status=flock(file_info->file,mode == ReadFileMode ? LOCK_SH : LOCK_EX);
+  } while ((status == -1) && (errno == EINTR));
+#else
+  (void) mode;
+  status=(-1);
+#endif
+  if (status == -1)
+    return(WizardFalse);
+  file_info->lock=DescriptorFileLock;
+  return(WizardTrue);
+}
+
 WizardExport FileInfo *AcquireFileInfo(const char *path,
   const char *relative_path,const FileMode mode,ExceptionInfo *exception)
 {
@@ -263,6 +374,9 @@ WizardExport FileInfo *AcquireFileInfo(const char *path,
   FileInfo
     *file_info;
 
+  int
+    flags;
+
   /*
     Acquire file info.
   */
@@ -323,25 +437,16 @@ WizardExport FileInfo *AcquireFileInfo(const char *path,
       (void) ConcatenateWizardString(file_info->path,relative_path,
         WizardPathExtent);
     }
-  if (AcquireFileLock(file_info,exception) == WizardFalse)
-    {
-      file_info=DestroyFileInfo(file_info,exception);
-      return((FileInfo *) NULL);
-    }
-  /*
-    Open file.
-  */
   switch (mode)
   {
     case ReadFileMode:
     {
-      file_info->file=open_utf8(file_info->path,O_RDONLY | O_BINARY,0);
+      flags=O_RDONLY | O_BINARY;
       break;
     }
     case WriteFileMode:
     {
-      file_info->file=open_utf8(file_info->path,O_RDWR | O_CREAT | O_BINARY,
-        S_MODE);
+      flags=O_RDWR | O_CREAT | O_BINARY;
       break;
     }
     default:
@@ -352,6 +457,37 @@ WizardExport FileInfo *AcquireFileInfo(const char *path,
       return((FileInfo *) NULL);
     }
   }
+  /*
+    Open file and lock it: shared to read, exclusive to write.  If the file
+    was replaced while we waited for the lock, open the replacement instead.
+  */
+  for ( ; ; )
+  {
+    file_info->file=open_utf8(file_info->path,flags,S_MODE);
+    if (file_info->file < 0)
+      {
+        file_info=DestroyFileInfo(file_info,exception);
+        return((FileInfo *) NULL);
+      }
+    if (LockFileDescriptor(file_info,mode) == WizardFalse)
+      break;
+    if (IsFileReplaced(file_info) == WizardFalse)
+      return(file_info);
+    (void) close(file_info->file);
+    file_info->file=(-1);
+    file_info->lock=UndefinedFileLock;
+  }
+  /*
+    Kernel advisory locks are not available, fall back to a lock file.
+  */
+  (void) close(file_info->file);
+  file_info->file=(-1);
+  if (AcquireFileLock(file_info,exception) == WizardFalse)
+    {
+      file_info=DestroyFileInfo(file_info,exception);
+      return((FileInfo *) NULL);
+    }
+  file_info->file=open_utf8(file_info->path,flags,S_MODE);
   if (file_info->file < 0)
     {
       file_info=DestroyFileInfo(file_info,exception);
@@ -389,6 +525,9 @@ WizardExport FileInfo *AcquireFileInfo(const char *path,
 WizardExport WizardBooleanType DestroyFile(FileInfo *file_info,
   ExceptionInfo *exception)
 {
+  file_info->length=0;
+  file_info->offset=0;
+  file_info->pending=0;
   if (file_info->file >= 0)
     if (close(file_info->file) == -1)
       {
@@ -435,12 +574,18 @@ WizardExport FileInfo *DestroyFileInfo(FileInfo *file_info,
   assert(file_info->signature == WizardSignature);
   (void) LogWizardEvent(TraceEvent,GetWizardModule(),"%s",file_info->path);
   LockSemaphoreInfo(file_info->semaphore);
+  if (FlushFile(file_info) == WizardFalse)
+    (void) ThrowWizardException(exception,GetWizardModule(),FileError,
+      "unable to write file `%s': %s",file_info->path,strerror(errno));
   if (file_info->file >= 0)
     if (close(file_info->file) == -1)
       (void) ThrowWizardException(exception,GetWizardModule(),FileError,
         "unable to close file `%s': %s",file_info->path,strerror(errno));
   file_info->file=(-1);
   (void) RelinquishFileLock(file_info,exception);
+  if (file_info->buffer != (unsigned char *) NULL)
+    file_info->buffer=(unsigned char *) RelinquishWizardMemory(
+      file_info->buffer);
   if (file_info->path != (char *) NULL)
     file_info->path=DestroyString(file_info->path);
   file_info->signature=(~WizardSignature);
@@ -450,6 +595,71 @@ WizardExport FileInfo *DestroyFileInfo(FileInfo *file_info,
   return(file_info);
 }
 
+/*
+%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%
+%                                                                             %
+%                                                                             %
+%                                                                             %
+%   F l u s h F i l e                                                         %
+%                                                                             %
+%                                                                             %
+%                                                                             %
+%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%
+%
+%  FlushFile() writes any data buffered by WriteFileChunk() to the file and
+%  discards any data read ahead by ReadFileChunk(), so the file offset of the
+%  descriptor matches the logical file offset.  Call it before operating on
+%  the descriptor returned by GetFileDescriptor() directly.  DestroyFileInfo()
+%  flushes the file before it releases the file lock.
+%
+%  The format of the FlushFile method is:
+%
+%      WizardBooleanType FlushFile(FileInfo *file_info)
+%
+%  A description of each parameter follows:
+%
+%    o file_info: The file info.
+%
+*/
+WizardExport WizardBooleanType FlushFile(FileInfo *file_info)
+{
+  assert(file_info != (FileInfo *) NULL);
+  assert(file_info->signature == WizardSignature);
+  if (file_info->pending != 0)
+    {
+      ssize_t
+        count;
+
+      (void) LogWizardEvent(TraceEvent,GetWizardModule(),"%s",
+        file_info->path);
+      count=WriteDescriptor(file_info->file,file_info->buffer,
+        file_info->pending);
+      if (count != (ssize_t) file_info->pending)
+        {
+          if (count > 0)
+            {
+              (void) memmove(file_info->buffer,file_info->buffer+count,
+                file_info->pending-count);
+              file_info->pending-=count;
+            }
+          return(WizardFalse);
+        }
+      file_info->pending=0;
+    }
+  if (file_info->offset < file_info->length)
+    {
+      /*
+        Rewind over the data read ahead but not consumed.
+      */
+      if (lseek(file_info->file,-(off_t) (file_info->length-file_info->offset),
+          SEEK_CUR) == -1)
+        return(WizardFalse);
+    }
+  file_info->length=0;
+  file_info->offset=0;
+  return(WizardTrue);
+}
+
 /*
 %%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%
 %                                                                             %
@@ -461,7 +671,8 @@ WizardExport FileInfo *DestroyFileInfo(FileInfo *file_info,
 %                                                                             %
 %%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%
 %
-%  GetFileDescriptor() returns the file descriptor.
+%  GetFileDescriptor() returns the file descriptor.  Call FlushFile() first if
+%  the descriptor is read, written, or repositioned directly.
 %
 %  The format of the GetFileDescriptor method is:
 %
@@ -570,6 +781,8 @@ WizardExport int ReadFileByte(FileInfo *file_info)
 
   assert(file_info != (FileInfo *) NULL);
   assert(file_info->signature == WizardSignature);
+  if (file_info->offset < file_info->length)
+    return((int) file_info->buffer[file_info->offset++]);
   if (ReadFileChunk(file_info,buffer,1) == WizardFalse)
     return(EOF);
   return((int) (*buffer));
@@ -587,7 +800,9 @@ WizardExport int ReadFileByte(FileInfo *file_info)
 %%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%
 %
 %  ReadFileChunk() reliably reads a chunk of data from a file.  It returns
-%  WizardTrue if all the data requested is read otherwise WizardFalse.
+%  WizardTrue if all the data requested is read otherwise WizardFalse.  Small
+%  reads are served from a read-ahead buffer, so parsing a file field by field
+%  costs one read(2) per buffer rather than one per field.
 %
 %  The format of the ReadFileChunk method is:
 %
@@ -605,6 +820,91 @@ WizardExport int ReadFileByte(FileInfo *file_info)
 */
 WizardExport WizardBooleanType ReadFileChunk(FileInfo *file_info,void *data,
   const size_t length)
+{
+  register unsigned char
+    *q;
+
+  size_t
+    count;
+
+  ssize_t
+    extent;
+
+  assert(file_info != (FileInfo *) NULL);
+  assert(file_info->signature == WizardSignature);
+  if ((file_info->pending != 0) && (FlushFile(file_info) == WizardFalse))
+    return(WizardFalse);
+  q=(unsigned char *) data;
+  count=length;
+  while (count != 0)
+  {
+    size_t
+      quantum;
+
+    if (file_info->offset < file_info->length)
+      {
+        quantum=Min(count,file_info->length-file_info->offset);
+        (void) memcpy(q,file_info->buffer+file_info->offset,quantum);
+        file_info->offset+=quantum;
+        q+=quantum;
+        count-=quantum;
+        continue;
+      }
+    (void) LogWizardEvent(TraceEvent,GetWizardModule(),"%s",file_info->path);
+    if (file_info->buffer == (unsigned char *) NULL)
+      file_info->buffer=(unsigned char *) AcquireQuantumMemory(
+        WizardMaxBufferExtent,sizeof(*file_info->buffer));
+    if ((count >= WizardMaxBufferExtent) ||
+        (file_info->buffer == (unsigned char *) NULL))
+      {
+        /*
+          Large reads bypass the read-ahead buffer.
+        */
+        extent=ReadDescriptor(file_info->file,q,count);
+        if (extent != (ssize_t) count)
+          return(WizardFalse);
+        break;
+      }
+    file_info->offset=0;
+    file_info->length=0;
+    extent=ReadDescriptor(file_info->file,file_info->buffer,
+      WizardMaxBufferExtent);
+    if (extent <= 0)
+      return(WizardFalse);
+    file_info->length=(size_t) extent;
+  }
+  return(WizardTrue);
+}
+
+/*
+%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%
+%                                                                             %
+%                                                                             %
+%                                                                             %
++   R e a d D e s c r i p t o r                                               %
+%                                                                             %
+%                                                                             %
+%                                                                             %
+%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%
+%
+%  ReadDescriptor() reads up to length bytes from a file descriptor, retrying
+%  short and interrupted reads, and returns the number of bytes read.  Fewer
+%  bytes are returned only at end of file or on error.
+%
+%  The format of the ReadDescriptor method is:
+%
+%      ssize_t ReadDescriptor(const int file,void *data,const size_t length)
+%
+%  A description of each parameter follows:
+%
+%    o file: The file descriptor.
+%
+%    o data: The data.
+%
+%    o length: The data length in bytes.
+%
+*/
+static ssize_t ReadDescriptor(const int file,void *data,const size_t length)
 {
   register ssize_t
     i;
@@ -612,25 +912,20 @@ WizardExport WizardBooleanType ReadFileChunk(FileInfo *file_info,void *data,
   ssize_t
     count;
 
-  assert(file_info != (FileInfo *) NULL);
-  assert(file_info->signature == WizardSignature);
-  (void) LogWizardEvent(TraceEvent,GetWizardModule(),"%s",file_info->path);
   for (i=0; i < (ssize_t) length; i+=count)
   {
-    count=read(file_info->file,(unsigned char *) data+i,Min(length-i,(size_t)
-      WizardMaxBufferExtent));
+    count=read(file,(unsigned char *) data+i,Min(length-i,(size_t)
+      SSIZE_MAX));
     if (count <= 0)
       {
-        count=0;
-        if (errno != EINTR)
+        if ((count == 0) || (errno != EINTR))
           break;
+        count=0;
       }
   }
-  if (i < (ssize_t) length)
-    return(WizardFalse);
-  return(WizardTrue);
+  return(i);
 }
-
+
 /*
 %%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%
 %                                                                             %
@@ -788,7 +1083,8 @@ WizardExport WizardBooleanType ReadFile64Bits(FileInfo *file_info,
 %                                                                             %
 %%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%
 %
-%  RelinquishFileLock() relinquishes a file lock.
+%  RelinquishFileLock() relinquishes a file lock.  Call it after the file is
+%  closed.
 %
 %  The format of the RelinquishFileLock method is:
 %
@@ -808,6 +1104,15 @@ static WizardBooleanType RelinquishFileLock(FileInfo *file_info,
   char
     *path;
 
+  if (file_info->lock != PathFileLock)
+    {
+      /*
+        Closing the file released its kernel advisory lock.
+      */
+      file_info->lock=UndefinedFileLock;
+      return(WizardTrue);
+    }
+  file_info->lock=UndefinedFileLock;
   path=AcquireString(file_info->path);
   AppendFileExtension("lck",path);
   if (remove_utf8(path) == -1)
@@ -821,6 +1126,82 @@ static WizardBooleanType RelinquishFileLock(FileInfo *file_info,
   return(WizardTrue);
 }
 
+/*
+%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%
+%                                                                             %
+%                                                                             %
+%                                                                             %
+%   S e e k F i l e                                                           %
+%                                                                             %
+%                                                                             %
+%                                                                             %
+%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%
+%
+%  SeekFile() flushes the file and sets the offset of the next read or write.
+%  It returns the resulting offset from the beginning of the file, or -1 on
+%  error.
+%
+%  The format of the SeekFile method is:
+%
+%      WizardOffsetType SeekFile(FileInfo *file_info,
+%        const WizardOffsetType offset,const int whence)
+%
+%  A description of each parameter follows:
+%
+%    o file_info: The file info.
+%
+%    o offset: The offset.
+%
+%    o whence: SEEK_SET, SEEK_CUR, or SEEK_END.
+%
+*/
+WizardExport WizardOffsetType SeekFile(FileInfo *file_info,
+  const WizardOffsetType offset,const int whence)
+{
+  assert(file_info != (FileInfo *) NULL);
+  assert(file_info->signature == WizardSignature);
+  if (FlushFile(file_info) == WizardFalse)
+    return(-1);
+  return((WizardOffsetType) lseek(file_info->file,(off_t) offset,whence));
+}
+
+/*
+%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%
+%                                                                             %
+%                                                                             %
+%                                                                             %
+%   T e l l F i l e                                                           %
+%                                                                             %
+%                                                                             %
+%                                                                             %
+%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%
+%
+%  TellFile() returns the offset of the next read or write from the beginning
+%  of the file, accounting for buffered data, or -1 on error.
+%
+%  The format of the TellFile method is:
+%
+%      WizardOffsetType TellFile(FileInfo *file_info)
+%
+%  A description of each parameter follows:
+%
+%    o file_info: The file info.
+%
+*/
+WizardExport WizardOffsetType TellFile(FileInfo *file_info)
+{
+  WizardOffsetType
+    offset;
+
+  assert(file_info != (FileInfo *) NULL);
+  assert(file_info->signature == WizardSignature);
+  offset=(WizardOffsetType) lseek(file_info->file,0,SEEK_CUR);
+  if (offset == -1)
+    return(-1);
+  return(offset-(WizardOffsetType) (file_info->length-file_info->offset)+
+    (WizardOffsetType) file_info->pending);
+}
+
 /*
 %%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%
 %                                                                             %
@@ -832,7 +1213,9 @@ static WizardBooleanType RelinquishFileLock(FileInfo *file_info,
 %                                                                             %
 %%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%
 %
-%  WriteFileChunk() reliably writes data to a file.
+%  WriteFileChunk() reliably writes data to a file.  Small writes are
+%  collected in a write-behind buffer that is written when it fills, when the
+%  file is read or repositioned, and by FlushFile() and DestroyFileInfo().
 %
 %  The format of the WriteFileChunk method is:
 %
@@ -850,6 +1233,67 @@ static WizardBooleanType RelinquishFileLock(FileInfo *file_info,
 */
 WizardExport WizardBooleanType WriteFileChunk(FileInfo *file_info,
   const void *data,const size_t length)
+{
+  assert(file_info != (FileInfo *) NULL);
+  assert(file_info->signature == WizardSignature);
+  if ((file_info->offset < file_info->length) &&
+      (FlushFile(file_info) == WizardFalse))
+    return(WizardFalse);
+  file_info->length=0;
+  file_info->offset=0;
+  if ((file_info->pending+length) > WizardMaxBufferExtent)
+    if (FlushFile(file_info) == WizardFalse)
+      return(WizardFalse);
+  if (file_info->buffer == (unsigned char *) NULL)
+    file_info->buffer=(unsigned char *) AcquireQuantumMemory(
+      WizardMaxBufferExtent,sizeof(*file_info->buffer));
+  if ((length >= WizardMaxBufferExtent) ||
+      (file_info->buffer == (unsigned char *) NULL))
+    {
+      /*
+        Large writes bypass the write-behind buffer.
+      */
+      (void) LogWizardEvent(TraceEvent,GetWizardModule(),"%s",
+        file_info->path);
+      if (WriteDescriptor(file_info->file,data,length) != (ssize_t) length)
+        return(WizardFalse);
+      return(WizardTrue);
+    }
+  (void) memcpy(file_info->buffer+file_info->pending,data,length);
+  file_info->pending+=length;
+  return(WizardTrue);
+}
+
+/*
+%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%
+%                                                                             %
+%                                                                             %
+%                                                                             %
++   W r i t e D e s c r i p t o r                                             %
+%                                                                             %
+%                                                                             %
+%                                                                             %
+%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%
+%
+%  WriteDescriptor() writes length bytes to a file descriptor, retrying short
+%  and interrupted writes, and returns the number of bytes written.
+%
+%  The format of the WriteDescriptor method is:
+%
+%      ssize_t WriteDescriptor(const int file,const void *data,
+%        const size_t length)
+%
+%  A description of each parameter follows:
+%
+%    o file: The file descriptor.
+%
+%    o data: The data.
+%
+%    o length: The data length in bytes.
+%
+*/
+static ssize_t WriteDescriptor(const int file,const void *data,
+  const size_t length)
 {
   register ssize_t
     i;
@@ -857,12 +1301,10 @@ WizardExport WizardBooleanType WriteFileChunk(FileInfo *file_info,
   ssize_t
     count;
 
-  assert(file_info != (FileInfo *) NULL);
-  assert(file_info->signature == WizardSignature);
-  (void) LogWizardEvent(TraceEvent,GetWizardModule(),"%s",file_info->path);
   for (i=0; i < (ssize_t) length; i+=count)
   {
-    count=write(file_info->file,(unsigned char *) data+i,length-i);
+    count=write(file,(const unsigned char *) data+i,Min(length-i,(size_t)
+      SSIZE_MAX));
     if (count <= 0)
       {
         count=0;
@@ -870,11 +1312,9 @@ WizardExport WizardBooleanType WriteFileChunk(FileInfo *file_info,
           break;
       }
   }
-  if (i < (ssize_t) length)
-    return(WizardFalse);
-  return(WizardTrue);
+  return(i);
 }
-
+
 /*
 %%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%
 %                                                                             %
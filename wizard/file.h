@@ -50,6 +50,7 @@ extern WizardExport int
 
 extern WizardExport WizardBooleanType
   DestroyFile(FileInfo *,ExceptionInfo *),
+  FlushFile(FileInfo *),
   ReadFile16Bits(FileInfo *,unsigned short *),
   ReadFile32Bits(FileInfo *,size_t *),
   ReadFile64Bits(FileInfo *,WizardSizeType *),
@@ -59,6 +60,10 @@ extern WizardExport WizardBooleanType
   WriteFile32Bits(FileInfo *,const size_t),
   WriteFile64Bits(FileInfo *,const WizardSizeType);
 
+extern WizardExport WizardOffsetType
+  SeekFile(FileInfo *,const WizardOffsetType,const int),
+  TellFile(FileInfo *);
+
 #if defined(__cplusplus) || defined(c_plusplus)
 }
 #endif
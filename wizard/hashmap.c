@@ -34,8 +34,11 @@
 %%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%
 %
 %  This module implements the standard handy hash and linked-list methods for
-%  storing and retrieving large numbers of data elements.  It is loosely based
-%  on the Java implementation of these algorithms.
+%  storing and retrieving large numbers of data elements.  The linked-list is
+%  loosely based on the Java implementation.  The hash-map is a flat open
+%  addressing table in the style of a Swiss table: a control byte per slot
+%  holds 7 bits of the hash, and lookups probe a group of 16 control bytes at
+%  a time.
 %
 */
 
@@ -45,12 +48,28 @@
 #include "wizard/studio.h"
 #include "wizard/exception.h"
 #include "wizard/exception-private.h"
-#include "wizard/hash.h"
 #include "wizard/hashmap.h"
 #include "wizard/memory_.h"
 #include "wizard/semaphore.h"
 #include "wizard/string_.h"
+#include "wizard/utility-private.h"
+#if defined(__SSE2__)
+#include <emmintrin.h>
+#endif
 
+/*
+  Define declarations.
+*/
+#define DefaultHashmapStripes  64
+#define DeletedHashmapSlot  0xfe
+#define EmptyHashmapSlot  0x80
+#define HashmapGroupSize  16
+#define HashmapMigrateGroups  2
+#define HashmapSecret0  0x2d358dccaa6c78a5ULL
+#define HashmapSecret1  0x8bb84b93962eacc9ULL
+#define HashmapSecret2  0x4b33a62ed433d4a3ULL
+#define HashmapSecret3  0x4d5a2da51de1aa47ULL
+
 /*
   Typedef declarations.
 */
@@ -65,9 +84,6 @@ typedef struct _ElementInfo
 
 typedef struct _EntryInfo
 {
-  size_t
-    hash;
-
   void
     *key,
     *value;
@@ -106,21 +122,171 @@ struct _HashmapInfo
   size_t
     capacity,
     entries,
+    deletions,
     next;
 
-  WizardBooleanType
-    head_of_list;
+  unsigned char
+    *control;
 
-  LinkedListInfo
-    **map;
+  EntryInfo
+    *map;
+
+  size_t
+    previous_capacity,
+    previous_entries,
+    migrate;
+
+  unsigned char
+    *previous_control;
+
+  EntryInfo
+    *previous_map;
 
+  size_t
+    number_stripes;
+
+  struct _HashmapInfo
+    **stripes;
+
+#if defined(WIZARDSTOOLKIT_THREAD_SUPPORT)
+  pthread_rwlock_t
+    lock;
+#elif defined(WIZARDSTOOLKIT_HAVE_WINTHREADS)
+  SRWLOCK
+    lock;
+#else
   SemaphoreInfo
     *semaphore;
+#endif
 
   size_t
     signature;
 };
 
+/*
+  Global declarations.
+*/
+static WizardSizeType
+  hashmap_seed = 0;
+
+/*
+  Hashmap locks: lookups share the lock, everything else holds it exclusively.
+*/
+static void AcquireHashmapLock(HashmapInfo *hashmap_info)
+{
+#if defined(WIZARDSTOOLKIT_THREAD_SUPPORT)
+  int
+    status;
+
+  pthread_rwlockattr_t
+    attributes;
+
+  status=pthread_rwlockattr_init(&attributes);
+#if defined(__GLIBC__)
+  /*
+    A steady stream of readers must not starve a writer.
+  */
+  if (status == 0)
+    (void) pthread_rwlockattr_setkind_np(&attributes,
+      PTHREAD_RWLOCK_PREFER_WRITER_NONRECURSIVE_NP);
+#endif
+  if (status == 0)
+    {
+      status=pthread_rwlock_init(&hashmap_info->lock,&attributes);
+      (void) pthread_rwlockattr_destroy(&attributes);
+    }
+  if (status != 0)
+    {
+      errno=status;
+      ThrowFatalException(ResourceFatalError,
+        "unable to initialize hashmap lock `%s'");
+    }
+#elif defined(WIZARDSTOOLKIT_HAVE_WINTHREADS)
+  InitializeSRWLock(&hashmap_info->lock);
+#else
+  hashmap_info->semaphore=AcquireSemaphoreInfo();
+#endif
+}
+
+static inline void LockHashmap(HashmapInfo *hashmap_info)
+{
+#if defined(WIZARDSTOOLKIT_THREAD_SUPPORT)
+  int
+    status;
+
+  status=pthread_rwlock_wrlock(&hashmap_info->lock);
+  if (status != 0)
+    {
+      errno=status;
+      ThrowFatalException(ResourceFatalError,"unable to lock hashmap `%s'");
+    }
+#elif defined(WIZARDSTOOLKIT_HAVE_WINTHREADS)
+  AcquireSRWLockExclusive(&hashmap_info->lock);
+#else
+  LockSemaphoreInfo(hashmap_info->semaphore);
+#endif
+}
+
+static inline void LockHashmapShared(HashmapInfo *hashmap_info)
+{
+#if defined(WIZARDSTOOLKIT_THREAD_SUPPORT)
+  int
+    status;
+
+  status=pthread_rwlock_rdlock(&hashmap_info->lock);
+  if (status != 0)
+    {
+      errno=status;
+      ThrowFatalException(ResourceFatalError,"unable to lock hashmap `%s'");
+    }
+#elif defined(WIZARDSTOOLKIT_HAVE_WINTHREADS)
+  AcquireSRWLockShared(&hashmap_info->lock);
+#else
+  LockSemaphoreInfo(hashmap_info->semaphore);
+#endif
+}
+
+static void RelinquishHashmapLock(HashmapInfo *hashmap_info)
+{
+#if defined(WIZARDSTOOLKIT_THREAD_SUPPORT)
+  (void) pthread_rwlock_destroy(&hashmap_info->lock);
+#elif defined(WIZARDSTOOLKIT_HAVE_WINTHREADS)
+  (void) hashmap_info;
+#else
+  RelinquishSemaphoreInfo(&hashmap_info->semaphore);
+#endif
+}
+
+static inline void UnlockHashmap(HashmapInfo *hashmap_info)
+{
+#if defined(WIZARDSTOOLKIT_THREAD_SUPPORT)
+  int
+    status;
+
+  status=pthread_rwlock_unlock(&hashmap_info->lock);
+  if (status != 0)
+    {
+      errno=status;
+      ThrowFatalException(ResourceFatalError,"unable to unlock hashmap `%s'");
+    }
+#elif defined(WIZARDSTOOLKIT_HAVE_WINTHREADS)
+  ReleaseSRWLockExclusive(&hashmap_info->lock);
+#else
+  UnlockSemaphoreInfo(hashmap_info->semaphore);
+#endif
+}
+
+static inline void UnlockHashmapShared(HashmapInfo *hashmap_info)
+{
+#if defined(WIZARDSTOOLKIT_THREAD_SUPPORT)
+  UnlockHashmap(hashmap_info);
+#elif defined(WIZARDSTOOLKIT_HAVE_WINTHREADS)
+  ReleaseSRWLockShared(&hashmap_info->lock);
+#else
+  UnlockSemaphoreInfo(hashmap_info->semaphore);
+#endif
+}
+
 /*
 %%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%
 %                                                                             %
@@ -326,44 +492,60 @@ WizardExport WizardBooleanType CompareHashmapStringInfo(const void *target,
 %    o hashmap_info: The hashmap info.
 %
 */
-WizardExport HashmapInfo *DestroyHashmap(HashmapInfo *hashmap_info)
-{
-  LinkedListInfo
-    *list_info;
 
+static void RelinquishHashmapEntries(HashmapInfo *hashmap_info,
+  const unsigned char *control,EntryInfo *map,const size_t capacity)
+{
   register EntryInfo
     *entry;
 
+  register size_t
+    i;
+
+  for (i=0; i < capacity; i++)
+  {
+    if (control[i] >= EmptyHashmapSlot)
+      continue;
+    entry=map+i;
+    if (hashmap_info->relinquish_key != (void *(*)(void *)) NULL)
+      entry->key=hashmap_info->relinquish_key(entry->key);
+    if (hashmap_info->relinquish_value != (void *(*)(void *)) NULL)
+      entry->value=hashmap_info->relinquish_value(entry->value);
+  }
+}
+
+WizardExport HashmapInfo *DestroyHashmap(HashmapInfo *hashmap_info)
+{
   register ssize_t
     i;
 
   assert(hashmap_info != (HashmapInfo *) NULL);
   assert(hashmap_info->signature == WizardSignature);
-  LockSemaphoreInfo(hashmap_info->semaphore);
-  for (i=0; i < (ssize_t) hashmap_info->capacity; i++)
-  {
-    list_info=hashmap_info->map[i];
-    if (list_info != (LinkedListInfo *) NULL)
-      {
-        list_info->next=list_info->head;
-        entry=(EntryInfo *) GetNextValueInLinkedList(list_info);
-        while (entry != (EntryInfo *) NULL)
-        {
-          if (hashmap_info->relinquish_key != (void *(*)(void *)) NULL)
-            entry->key=hashmap_info->relinquish_key(entry->key);
-          if (hashmap_info->relinquish_value != (void *(*)(void *)) NULL)
-            entry->value=hashmap_info->relinquish_value(entry->value);
-          entry=(EntryInfo *) GetNextValueInLinkedList(list_info);
-        }
-      }
-    if (list_info != (LinkedListInfo *) NULL)
-      list_info=DestroyLinkedList(list_info,RelinquishWizardMemory);
-  }
-  hashmap_info->map=(LinkedListInfo **) RelinquishWizardMemory(
-    hashmap_info->map);
+  LockHashmap(hashmap_info);
+  if (hashmap_info->stripes != (HashmapInfo **) NULL)
+    {
+      for (i=0; i < (ssize_t) hashmap_info->number_stripes; i++)
+        hashmap_info->stripes[i]=DestroyHashmap(hashmap_info->stripes[i]);
+      hashmap_info->stripes=(HashmapInfo **) RelinquishWizardMemory(
+        hashmap_info->stripes);
+    }
+  RelinquishHashmapEntries(hashmap_info,hashmap_info->control,
+    hashmap_info->map,hashmap_info->capacity);
+  hashmap_info->control=(unsigned char *) RelinquishWizardMemory(
+    hashmap_info->control);
+  hashmap_info->map=(EntryInfo *) RelinquishWizardMemory(hashmap_info->map);
+  if (hashmap_info->previous_control != (unsigned char *) NULL)
+    {
+      RelinquishHashmapEntries(hashmap_info,hashmap_info->previous_control,
+        hashmap_info->previous_map,hashmap_info->previous_capacity);
+      hashmap_info->previous_control=(unsigned char *) RelinquishWizardMemory(
+        hashmap_info->previous_control);
+      hashmap_info->previous_map=(EntryInfo *) RelinquishWizardMemory(
+        hashmap_info->previous_map);
+    }
   hashmap_info->signature=(~WizardSignature);
-  UnlockSemaphoreInfo(hashmap_info->semaphore);
-  RelinquishSemaphoreInfo(&hashmap_info->semaphore);
+  UnlockHashmap(hashmap_info);
+  RelinquishHashmapLock(hashmap_info);
   hashmap_info=(HashmapInfo *) RelinquishWizardMemory(hashmap_info);
   return(hashmap_info);
 }
@@ -480,12 +662,36 @@ WizardExport void *GetLastValueInLinkedList(LinkedListInfo *list_info)
 %    o hashmap_info: The hashmap info.
 %
 */
-WizardExport void *GetNextKeyInHashmap(HashmapInfo *hashmap_info)
+
+static EntryInfo *GetNextHashmapEntry(HashmapInfo *hashmap_info)
 {
-  LinkedListInfo
-    *list_info;
+  size_t
+    slot;
 
-  register EntryInfo
+  /*
+    Visit the slots of the current table, then those of the table being
+    migrated, if any.
+  */
+  while (hashmap_info->next < (hashmap_info->capacity+
+         hashmap_info->previous_capacity))
+  {
+    slot=hashmap_info->next++;
+    if (slot < hashmap_info->capacity)
+      {
+        if (hashmap_info->control[slot] < EmptyHashmapSlot)
+          return(hashmap_info->map+slot);
+        continue;
+      }
+    slot-=hashmap_info->capacity;
+    if (hashmap_info->previous_control[slot] < EmptyHashmapSlot)
+      return(hashmap_info->previous_map+slot);
+  }
+  return((EntryInfo *) NULL);
+}
+
+WizardExport void *GetNextKeyInHashmap(HashmapInfo *hashmap_info)
+{
+  EntryInfo
     *entry;
 
   void
@@ -493,30 +699,29 @@ WizardExport void *GetNextKeyInHashmap(HashmapInfo *hashmap_info)
 
   assert(hashmap_info != (HashmapInfo *) NULL);
   assert(hashmap_info->signature == WizardSignature);
-  LockSemaphoreInfo(hashmap_info->semaphore);
-  while (hashmap_info->next < hashmap_info->capacity)
-  {
-    list_info=hashmap_info->map[hashmap_info->next];
-    if (list_info != (LinkedListInfo *) NULL)
+  LockHashmap(hashmap_info);
+  if (hashmap_info->stripes != (HashmapInfo **) NULL)
+    {
+      /*
+        A concurrent hashmap iterates over its stripes in turn.
+      */
+      while (hashmap_info->next < hashmap_info->number_stripes)
       {
-        if (hashmap_info->head_of_list == WizardFalse)
-          {
-            list_info->next=list_info->head;
-            hashmap_info->head_of_list=WizardTrue;
-          }
-        entry=(EntryInfo *) GetNextValueInLinkedList(list_info);
-        if (entry != (EntryInfo *) NULL)
+        key=GetNextKeyInHashmap(hashmap_info->stripes[hashmap_info->next]);
+        if (key != (void *) NULL)
           {
-            key=entry->key;
-            UnlockSemaphoreInfo(hashmap_info->semaphore);
+            UnlockHashmap(hashmap_info);
             return(key);
           }
-        hashmap_info->head_of_list=WizardFalse;
+        hashmap_info->next++;
       }
-    hashmap_info->next++;
-  }
-  UnlockSemaphoreInfo(hashmap_info->semaphore);
-  return((void *) NULL);
+      UnlockHashmap(hashmap_info);
+      return((void *) NULL);
+    }
+  entry=GetNextHashmapEntry(hashmap_info);
+  key=entry != (EntryInfo *) NULL ? entry->key : (void *) NULL;
+  UnlockHashmap(hashmap_info);
+  return(key);
 }
 
 /*
@@ -543,10 +748,7 @@ WizardExport void *GetNextKeyInHashmap(HashmapInfo *hashmap_info)
 */
 WizardExport void *GetNextValueInHashmap(HashmapInfo *hashmap_info)
 {
-  LinkedListInfo
-    *list_info;
-
-  register EntryInfo
+  EntryInfo
     *entry;
 
   void
@@ -554,30 +756,29 @@ WizardExport void *GetNextValueInHashmap(HashmapInfo *hashmap_info)
 
   assert(hashmap_info != (HashmapInfo *) NULL);
   assert(hashmap_info->signature == WizardSignature);
-  LockSemaphoreInfo(hashmap_info->semaphore);
-  while (hashmap_info->next < hashmap_info->capacity)
-  {
-    list_info=hashmap_info->map[hashmap_info->next];
-    if (list_info != (LinkedListInfo *) NULL)
+  LockHashmap(hashmap_info);
+  if (hashmap_info->stripes != (HashmapInfo **) NULL)
+    {
+      /*
+        A concurrent hashmap iterates over its stripes in turn.
+      */
+      while (hashmap_info->next < hashmap_info->number_stripes)
       {
-        if (hashmap_info->head_of_list == WizardFalse)
-          {
-            list_info->next=list_info->head;
-            hashmap_info->head_of_list=WizardTrue;
-          }
-        entry=(EntryInfo *) GetNextValueInLinkedList(list_info);
-        if (entry != (EntryInfo *) NULL)
+        value=GetNextValueInHashmap(hashmap_info->stripes[hashmap_info->next]);
+        if (value != (void *) NULL)
           {
-            value=entry->value;
-            UnlockSemaphoreInfo(hashmap_info->semaphore);
+            UnlockHashmap(hashmap_info);
             return(value);
           }
-        hashmap_info->head_of_list=WizardFalse;
+        hashmap_info->next++;
       }
-    hashmap_info->next++;
-  }
-  UnlockSemaphoreInfo(hashmap_info->semaphore);
-  return((void *) NULL);
+      UnlockHashmap(hashmap_info);
+      return((void *) NULL);
+    }
+  entry=GetNextHashmapEntry(hashmap_info);
+  value=entry != (EntryInfo *) NULL ? entry->value : (void *) NULL;
+  UnlockHashmap(hashmap_info);
+  return(value);
 }
 
 /*
@@ -646,9 +847,20 @@ WizardExport void *GetNextValueInLinkedList(LinkedListInfo *list_info)
 WizardExport size_t GetNumberOfEntriesInHashmap(
   const HashmapInfo *hashmap_info)
 {
+  register ssize_t
+    i;
+
+  size_t
+    entries;
+
   assert(hashmap_info != (HashmapInfo *) NULL);
   assert(hashmap_info->signature == WizardSignature);
-  return(hashmap_info->entries);
+  if (hashmap_info->stripes == (HashmapInfo **) NULL)
+    return(hashmap_info->entries);
+  entries=0;
+  for (i=0; i < (ssize_t) hashmap_info->number_stripes; i++)
+    entries+=hashmap_info->stripes[i]->entries;
+  return(entries);
 }
 
 /*
@@ -707,13 +919,218 @@ WizardExport size_t GetNumberOfElementsInLinkedList(
 %    o key: The key.
 %
 */
+
+static inline WizardSizeType MixHashmapHash(const size_t hash)
+{
+  WizardSizeType
+    alpha;
+
+  /*
+    Spread the caller's hash over all 64 bits (murmur3 finalizer): the low
+    bits pick the group, the high 7 bits are kept in the control byte.
+  */
+  alpha=(WizardSizeType) hash;
+  alpha^=(alpha >> 33);
+  alpha*=0xff51afd7ed558ccdULL;
+  alpha^=(alpha >> 33);
+  alpha*=0xc4ceb9fe1a85ec53ULL;
+  alpha^=(alpha >> 33);
+  return(alpha);
+}
+
+static inline HashmapInfo *GetHashmapStripe(HashmapInfo *hashmap_info,
+  const size_t hash)
+{
+  size_t
+    stripe;
+
+  /*
+    The stripe takes the middle bits, the group the low bits of the hash.
+  */
+  if (hashmap_info->stripes == (HashmapInfo **) NULL)
+    return(hashmap_info);
+  stripe=(size_t) (MixHashmapHash(hash) >> 32) &
+    (hashmap_info->number_stripes-1);
+  return(hashmap_info->stripes[stripe]);
+}
+
+static inline unsigned int MatchHashmapGroup(const unsigned char *group,
+  const unsigned char control)
+{
+#if defined(__SSE2__)
+  return((unsigned int) _mm_movemask_epi8(_mm_cmpeq_epi8(_mm_loadu_si128(
+    (const __m128i *) group),_mm_set1_epi8((char) control))));
+#else
+  register ssize_t
+    i;
+
+  unsigned int
+    mask;
+
+  mask=0;
+  for (i=0; i < HashmapGroupSize; i++)
+    if (group[i] == control)
+      mask|=(1U << i);
+  return(mask);
+#endif
+}
+
+static inline unsigned int MatchHashmapGroupFree(const unsigned char *group)
+{
+#if defined(__SSE2__)
+  /*
+    Empty and deleted control bytes are the only ones with the high bit set.
+  */
+  return((unsigned int) _mm_movemask_epi8(_mm_loadu_si128((const __m128i *)
+    group)));
+#else
+  register ssize_t
+    i;
+
+  unsigned int
+    mask;
+
+  mask=0;
+  for (i=0; i < HashmapGroupSize; i++)
+    if ((group[i] & 0x80) != 0)
+      mask|=(1U << i);
+  return(mask);
+#endif
+}
+
+static inline size_t GetHashmapGroupSlot(const unsigned int mask)
+{
+#if defined(__GNUC__)
+  return((size_t) __builtin_ctz(mask));
+#else
+  register size_t
+    i;
+
+  for (i=0; (mask & (1U << i)) == 0; i++) ;
+  return(i);
+#endif
+}
+
+static ssize_t FindHashmapEntry(const HashmapInfo *hashmap_info,
+  const unsigned char *control,const EntryInfo *map,const size_t capacity,
+  const void *key,const size_t hash)
+{
+  register size_t
+    i;
+
+  size_t
+    group,
+    groups;
+
+  unsigned char
+    code;
+
+  WizardSizeType
+    alpha;
+
+  /*
+    Probe the groups in triangular order, this visits every group once when
+    the number of groups is a power of two.
+  */
+  alpha=MixHashmapHash(hash);
+  code=(unsigned char) (alpha >> 57);
+  groups=capacity/HashmapGroupSize;
+  group=(size_t) alpha & (groups-1);
+  for (i=0; i < groups; i++)
+  {
+    const unsigned char
+      *p;
+
+    unsigned int
+      mask;
+
+    p=control+group*HashmapGroupSize;
+    for (mask=MatchHashmapGroup(p,code); mask != 0; mask&=(mask-1))
+    {
+      size_t
+        slot;
+
+      WizardBooleanType
+        compare;
+
+      slot=group*HashmapGroupSize+GetHashmapGroupSlot(mask);
+      if (hashmap_info->compare !=
+          (WizardBooleanType (*)(const void *,const void *)) NULL)
+        compare=hashmap_info->compare(key,map[slot].key);
+      else
+        compare=hashmap_info->hash(map[slot].key) == hash ? WizardTrue :
+          WizardFalse;
+      if (compare != WizardFalse)
+        return((ssize_t) slot);
+    }
+    if (MatchHashmapGroup(p,EmptyHashmapSlot) != 0)
+      break;
+    group=(group+i+1) & (groups-1);
+  }
+  return(-1);
+}
+
+static size_t FindHashmapSlot(const unsigned char *control,
+  const size_t capacity,const size_t hash,unsigned char *code)
+{
+  register size_t
+    i;
+
+  size_t
+    group,
+    groups;
+
+  WizardSizeType
+    alpha;
+
+  /*
+    Return the first empty or deleted slot along the probe sequence.  There
+    is always one, the map never fills beyond 7/8 of its capacity.
+  */
+  alpha=MixHashmapHash(hash);
+  *code=(unsigned char) (alpha >> 57);
+  groups=capacity/HashmapGroupSize;
+  group=(size_t) alpha & (groups-1);
+  for (i=0; i < groups; i++)
+  {
+    unsigned int
+      mask;
+
+    mask=MatchHashmapGroupFree(control+group*HashmapGroupSize);
+    if (mask != 0)
+      return(group*HashmapGroupSize+GetHashmapGroupSlot(mask));
+    group=(group+i+1) & (groups-1);
+  }
+  return(0);
+}
+
+static EntryInfo *GetHashmapEntry(const HashmapInfo *hashmap_info,
+  const void *key,const size_t hash)
+{
+  ssize_t
+    slot;
+
+  /*
+    While the map grows, an entry is either in the current table or still
+    in the table being migrated.
+  */
+  slot=FindHashmapEntry(hashmap_info,hashmap_info->control,hashmap_info->map,
+    hashmap_info->capacity,key,hash);
+  if (slot >= 0)
+    return(hashmap_info->map+slot);
+  if (hashmap_info->previous_control == (unsigned char *) NULL)
+    return((EntryInfo *) NULL);
+  slot=FindHashmapEntry(hashmap_info,hashmap_info->previous_control,
+    hashmap_info->previous_map,hashmap_info->previous_capacity,key,hash);
+  if (slot >= 0)
+    return(hashmap_info->previous_map+slot);
+  return((EntryInfo *) NULL);
+}
+
 WizardExport void *GetValueFromHashmap(HashmapInfo *hashmap_info,
   const void *key)
 {
-  LinkedListInfo
-    *list_info;
-
-  register EntryInfo
+  EntryInfo
     *entry;
 
   size_t
@@ -726,36 +1143,15 @@ WizardExport void *GetValueFromHashmap(HashmapInfo *hashmap_info,
   assert(hashmap_info->signature == WizardSignature);
   if (key == NULL)
     return((void *) NULL);
-  LockSemaphoreInfo(hashmap_info->semaphore);
   hash=hashmap_info->hash(key);
-  list_info=hashmap_info->map[hash % hashmap_info->capacity];
-  if (list_info != (LinkedListInfo *) NULL)
-    {
-      list_info->next=list_info->head;
-      entry=(EntryInfo *) GetNextValueInLinkedList(list_info);
-      while (entry != (EntryInfo *) NULL)
-      {
-        if (entry->hash == hash)
-          {
-            WizardBooleanType
-              compare;
-
-            compare=WizardTrue;
-            if (hashmap_info->compare !=
-                (WizardBooleanType (*)(const void *,const void *)) NULL)
-              compare=hashmap_info->compare(key,entry->key);
-            if (compare == WizardTrue)
-              {
-                value=entry->value;
-                UnlockSemaphoreInfo(hashmap_info->semaphore);
-                return(value);
-              }
-          }
-        entry=(EntryInfo *) GetNextValueInLinkedList(list_info);
-      }
-    }
-  UnlockSemaphoreInfo(hashmap_info->semaphore);
-  return((void *) NULL);
+  hashmap_info=GetHashmapStripe(hashmap_info,hash);
+  LockHashmapShared(hashmap_info);
+  value=(void *) NULL;
+  entry=GetHashmapEntry(hashmap_info,key,hash);
+  if (entry != (EntryInfo *) NULL)
+    value=entry->value;
+  UnlockHashmapShared(hashmap_info);
+  return(value);
 }
 
 /*
@@ -826,6 +1222,57 @@ WizardExport void *GetValueFromLinkedList(LinkedListInfo *list_info,
 %                                                                             %
 %                                                                             %
 %                                                                             %
++   H a s h m a p C o m p o n e n t G e n e s i s                             %
+%                                                                             %
+%                                                                             %
+%                                                                             %
+%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%
+%
+%  HashmapComponentGenesis() instantiates the hashmap component.  It seeds the
+%  string hashes once per process, so it must run before any string-keyed
+%  hashmap is populated.  The seed comes from /dev/urandom, mixed with the
+%  time, the process id and an address; it never fails, since a hash seed
+%  needs no cryptographic strength.
+%
+%  The format of the HashmapComponentGenesis method is:
+%
+%      WizardBooleanType HashmapComponentGenesis(void)
+%
+*/
+WizardExport WizardBooleanType HashmapComponentGenesis(void)
+{
+  int
+    file;
+
+  ssize_t
+    count;
+
+  WizardSizeType
+    seed;
+
+  if (hashmap_seed != 0)
+    return(WizardTrue);
+  seed=0;
+  file=open_utf8("/dev/urandom",O_RDONLY | O_BINARY,0);
+  if (file != -1)
+    {
+      count=read(file,&seed,sizeof(seed));
+      if (count != (ssize_t) sizeof(seed))
+        seed=0;
+      (void) close(file);
+    }
+  seed^=(WizardSizeType) time((time_t *) NULL)*HashmapSecret1;
+  seed^=(WizardSizeType) getpid()*HashmapSecret2;
+  seed^=(WizardSizeType) ((size_t) &hashmap_seed)*HashmapSecret3;
+  hashmap_seed=seed != 0 ? seed : HashmapSecret0;
+  return(WizardTrue);
+}
+
+/*
+%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%
+%                                                                             %
+%                                                                             %
+%                                                                             %
 %   H a s h P o i n t e r T y p e                                             %
 %                                                                             %
 %                                                                             %
@@ -869,7 +1316,13 @@ WizardExport size_t HashPointerType(const void *pointer)
 %%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%
 %
 %  HashStringType() finds an entry in a hash-map based on the contents of a
-%  string.
+%  string.  The hash is a seeded 64-bit multiply-mix (wyhash) folded to the
+%  width of size_t; it reads the string in place and never allocates.
+%
+%  The seed is random per process (see HashmapComponentGenesis()), so string
+%  hashes, and the order GetNextKeyInHashmap() returns string keys in, change
+%  from run to run and differ from earlier releases.  Do not store them or
+%  depend on that order.
 %
 %  The format of the HashStringType method is:
 %
@@ -880,40 +1333,141 @@ WizardExport size_t HashPointerType(const void *pointer)
 %    o string: compute the hash entry location from this string.
 %
 */
-WizardExport size_t HashStringType(const void *string)
+
+static inline void MultiplyHashmap64Bits(WizardSizeType *alpha,
+  WizardSizeType *beta)
 {
-  const StringInfo
-    *digest;
+#if defined(__SIZEOF_INT128__)
+  __uint128_t
+    product;
+
+  product=(__uint128_t) *alpha*(*beta);
+  *alpha=(WizardSizeType) product;
+  *beta=(WizardSizeType) (product >> 64);
+#else
+  WizardSizeType
+    carry,
+    p00,
+    p01,
+    p10,
+    p11;
+
+  p00=(*alpha & 0xffffffffULL)*(*beta & 0xffffffffULL);
+  p01=(*alpha & 0xffffffffULL)*(*beta >> 32);
+  p10=(*alpha >> 32)*(*beta & 0xffffffffULL);
+  p11=(*alpha >> 32)*(*beta >> 32);
+  carry=(p00 >> 32)+(p01 & 0xffffffffULL)+(p10 & 0xffffffffULL);
+  *alpha=(p00 & 0xffffffffULL) | (carry << 32);
+  *beta=p11+(p01 >> 32)+(p10 >> 32)+(carry >> 32);
+#endif
+}
 
-  HashInfo
-    *hashmap_info;
+static inline WizardSizeType MixHashmap64Bits(WizardSizeType alpha,
+  WizardSizeType beta)
+{
+  MultiplyHashmap64Bits(&alpha,&beta);
+  return(alpha ^ beta);
+}
+
+static inline WizardSizeType GetHashmap32Bits(const unsigned char *p)
+{
+  return((WizardSizeType) p[0] | ((WizardSizeType) p[1] << 8) |
+    ((WizardSizeType) p[2] << 16) | ((WizardSizeType) p[3] << 24));
+}
+
+static inline WizardSizeType GetHashmap64Bits(const unsigned char *p)
+{
+  return(GetHashmap32Bits(p) | (GetHashmap32Bits(p+4) << 32));
+}
+
+static size_t HashmapBytes(const unsigned char *datum,const size_t length)
+{
+  register const unsigned char
+    *p;
 
   register size_t
     i;
 
-  size_t
-    hash;
+  WizardSizeType
+    alpha,
+    beta,
+    seed;
 
-  StringInfo
-    *message;
+  seed=hashmap_seed;
+  seed^=MixHashmap64Bits(seed ^ HashmapSecret0,HashmapSecret1);
+  p=datum;
+  if (length <= 16)
+    {
+      if (length >= 4)
+        {
+          alpha=(GetHashmap32Bits(p) << 32) |
+            GetHashmap32Bits(p+((length >> 3) << 2));
+          beta=(GetHashmap32Bits(p+length-4) << 32) |
+            GetHashmap32Bits(p+length-4-((length >> 3) << 2));
+        }
+      else
+        if (length > 0)
+          {
+            alpha=((WizardSizeType) p[0] << 16) |
+              ((WizardSizeType) p[length >> 1] << 8) | p[length-1];
+            beta=0;
+          }
+        else
+          {
+            alpha=0;
+            beta=0;
+          }
+    }
+  else
+    {
+      i=length;
+      if (i > 48)
+        {
+          WizardSizeType
+            see1,
+            see2;
 
-  unsigned char
-    *datum;
-
-  hashmap_info=AcquireHashInfo(CRC64Hash);
-  if (hashmap_info == (HashInfo *) NULL)
-    return((size_t) string);
-  InitializeHash(hashmap_info);
-  message=StringToStringInfo((const char *) string);
-  UpdateHash(hashmap_info,message);
-  FinalizeHash(hashmap_info);
-  hash=0;
-  digest=GetHashDigest(hashmap_info);
-  datum=GetStringInfoDatum(digest);
-  for (i=0; i < GetStringInfoLength(digest); i++)
-    hash^=datum[i];
-  hashmap_info=DestroyHashInfo(hashmap_info);
-  return(hash);
+          see1=seed;
+          see2=seed;
+          do
+          {
+            seed=MixHashmap64Bits(GetHashmap64Bits(p) ^ HashmapSecret1,
+              GetHashmap64Bits(p+8) ^ seed);
+            see1=MixHashmap64Bits(GetHashmap64Bits(p+16) ^ HashmapSecret2,
+              GetHashmap64Bits(p+24) ^ see1);
+            see2=MixHashmap64Bits(GetHashmap64Bits(p+32) ^ HashmapSecret3,
+              GetHashmap64Bits(p+40) ^ see2);
+            p+=48;
+            i-=48;
+          } while (i > 48);
+          seed^=see1 ^ see2;
+        }
+      while (i > 16)
+      {
+        seed=MixHashmap64Bits(GetHashmap64Bits(p) ^ HashmapSecret1,
+          GetHashmap64Bits(p+8) ^ seed);
+        p+=16;
+        i-=16;
+      }
+      alpha=GetHashmap64Bits(p+i-16);
+      beta=GetHashmap64Bits(p+i-8);
+    }
+  alpha^=HashmapSecret1;
+  beta^=seed;
+  MultiplyHashmap64Bits(&alpha,&beta);
+  alpha=MixHashmap64Bits(alpha ^ HashmapSecret0 ^ (WizardSizeType) length,
+    beta ^ HashmapSecret1);
+  if (sizeof(size_t) < sizeof(alpha))
+    alpha^=(alpha >> 32);
+  return((size_t) alpha);
+}
+
+WizardExport size_t HashStringType(const void *string)
+{
+  if (string == (const void *) NULL)
+    return(0);
+  return(HashmapBytes((const unsigned char *) string,strlen((const char *)
+    string)));
 }
 
 /* %%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%
@@ -927,7 +1481,7 @@ WizardExport size_t HashStringType(const void *string)
 %%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%
 %
 %  HashStringInfoType() finds an entry in a hash-map based on the contents of
-%  a string.
+%  a string.  It uses the same seeded hash as HashStringType().
 %
 %  The format of the HashStringInfoType method is:
 %
@@ -940,24 +1494,14 @@ WizardExport size_t HashStringType(const void *string)
 */
 WizardExport size_t HashStringInfoType(const void *string)
 {
-  register size_t
-    i;
-
-  size_t
-    hash;
-
-  StringInfo
+  const StringInfo
     *message;
 
-  unsigned char
-    *datum;
-
-  message=(StringInfo *) string;
-  hash=0;
-  datum=GetStringInfoDatum(message);
-  for (i=0; i < GetStringInfoLength(message); i++)
-    hash^=datum[i];
-  return(hash);
+  message=(const StringInfo *) string;
+  if (message == (const StringInfo *) NULL)
+    return(0);
+  return(HashmapBytes(GetStringInfoDatum(message),
+    GetStringInfoLength(message)));
 }
 
 /*
@@ -1178,7 +1722,8 @@ WizardExport WizardBooleanType IsHashmapEmpty(const HashmapInfo *hashmap_info)
 {
   assert(hashmap_info != (HashmapInfo *) NULL);
   assert(hashmap_info->signature == WizardSignature);
-  return(hashmap_info->entries == 0 ? WizardTrue : WizardFalse);
+  return(GetNumberOfEntriesInHashmap(hashmap_info) == 0 ? WizardTrue :
+    WizardFalse);
 }
 
 /*
@@ -1265,6 +1810,83 @@ WizardExport WizardBooleanType LinkedListToArray(LinkedListInfo *list_info,
 %                                                                             %
 %                                                                             %
 %                                                                             %
+%   N e w C o n c u r r e n t H a s h m a p                                   %
+%                                                                             %
+%                                                                             %
+%                                                                             %
+%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%
+%
+%  NewConcurrentHashmap() returns a pointer to a HashmapInfo structure for
+%  use by many threads at once.  The entries are spread over independent
+%  stripes by hash, each with its own reader/writer lock: lookups share the
+%  lock of their stripe, and writers to different stripes do not contend.
+%  The hashmap is used with the same methods as one returned by NewHashmap().
+%
+%  The format of the NewConcurrentHashmap method is:
+%
+%      HashmapInfo *NewConcurrentHashmap(const size_t capacity,
+%        const size_t stripes,size_t (*hash)(const void *),
+%        WizardBooleanType (*compare)(const void *,const void *),
+%        void *(*relinquish_key)(void *),void *(*relinquish_value)(void *))
+%
+%  A description of each parameter follows:
+%
+%    o capacity: The initial number entries in the hash-map, shared among
+%      the stripes.
+%
+%    o stripes: The number of stripes, rounded up to a power of two.  Zero
+%      selects a default of 64.
+%
+%    o hash: The hash method, typically HashPointerType(), HashStringType(),
+%      or HashStringInfoType().
+%
+%    o compare: The compare method, typically NULL, CompareHashmapString(),
+%      or CompareHashmapStringInfo().
+%
+%    o relinquish_key: The key deallocation method, typically
+%      RelinquishWizardMemory(), called whenever a key is removed from the
+%      hash-map.
+%
+%    o relinquish_value: The value deallocation method;  typically
+%      RelinquishWizardMemory(), called whenever a value object is removed from
+%      the hash-map.
+%
+*/
+WizardExport HashmapInfo *NewConcurrentHashmap(const size_t capacity,
+  const size_t stripes,size_t (*hash)(const void *),
+  WizardBooleanType (*compare)(const void *,const void *),
+  void *(*relinquish_key)(void *),void *(*relinquish_value)(void *))
+{
+  HashmapInfo
+    *hashmap_info;
+
+  register ssize_t
+    i;
+
+  size_t
+    number_stripes;
+
+  hashmap_info=NewHashmap(0,hash,compare,relinquish_key,relinquish_value);
+  number_stripes=1;
+  while ((number_stripes < (stripes == 0 ? DefaultHashmapStripes : stripes)) &&
+         (number_stripes < 65536))
+    number_stripes<<=1;
+  hashmap_info->stripes=(HashmapInfo **) AcquireQuantumMemory(number_stripes,
+    sizeof(*hashmap_info->stripes));
+  if (hashmap_info->stripes == (HashmapInfo **) NULL)
+    ThrowWizardFatalError(CacheDomain,MemoryError);
+  for (i=0; i < (ssize_t) number_stripes; i++)
+    hashmap_info->stripes[i]=NewHashmap(capacity/number_stripes,hash,compare,
+      relinquish_key,relinquish_value);
+  hashmap_info->number_stripes=number_stripes;
+  return(hashmap_info);
+}
+
+/*
+%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%
+%                                                                             %
+%                                                                             %
+%                                                                             %
 %   N e w H a s h m a p                                                       %
 %                                                                             %
 %                                                                             %
@@ -1285,8 +1907,9 @@ WizardExport WizardBooleanType LinkedListToArray(LinkedListInfo *list_info,
 %  A description of each parameter follows:
 %
 %    o capacity: The initial number entries in the hash-map: typically
-%      SmallHashmapSize, MediumHashmapSize, or LargeHashmapSize.  The
-%      hashmap will dynamically increase its capacity on demand.
+%      SmallHashmapSize, MediumHashmapSize, or LargeHashmapSize.  It is
+%      rounded up to a power of two and the hashmap doubles its capacity on
+%      demand.
 %
 %    o hash: The hash method, typically HashPointerType(), HashStringType(),
 %      or HashStringInfoType().
@@ -1324,14 +1947,20 @@ WizardExport HashmapInfo *NewHashmap(const size_t capacity,
   hashmap_info->relinquish_key=relinquish_key;
   hashmap_info->relinquish_value=relinquish_value;
   hashmap_info->entries=0;
-  hashmap_info->capacity=capacity;
-  hashmap_info->map=(LinkedListInfo **) AcquireQuantumMemory((size_t)
-    capacity+1UL,sizeof(*hashmap_info->map));
-  if (hashmap_info->map == (LinkedListInfo **) NULL)
-    ThrowWizardFatalError(CacheDomain,MemoryError);
-  (void) ResetWizardMemory(hashmap_info->map,0,(size_t) capacity*
+  hashmap_info->capacity=HashmapGroupSize;
+  while ((hashmap_info->capacity < capacity) &&
+         (hashmap_info->capacity <= ((~(size_t) 0) >> 2)))
+    hashmap_info->capacity<<=1;
+  hashmap_info->control=(unsigned char *) AcquireQuantumMemory(
+    hashmap_info->capacity,sizeof(*hashmap_info->control));
+  hashmap_info->map=(EntryInfo *) AcquireQuantumMemory(hashmap_info->capacity,
     sizeof(*hashmap_info->map));
-  hashmap_info->semaphore=AcquireSemaphoreInfo();
+  if ((hashmap_info->control == (unsigned char *) NULL) ||
+      (hashmap_info->map == (EntryInfo *) NULL))
+    ThrowWizardFatalError(CacheDomain,MemoryError);
+  (void) memset(hashmap_info->control,EmptyHashmapSlot,hashmap_info->capacity*
+    sizeof(*hashmap_info->control));
+  AcquireHashmapLock(hashmap_info);
   hashmap_info->signature=WizardSignature;
   return(hashmap_info);
 }
@@ -1407,86 +2036,88 @@ WizardExport LinkedListInfo *NewLinkedList(const size_t capacity)
 %
 */
 
-static WizardBooleanType IncreaseHashmapCapacity(HashmapInfo *hashmap_info)
+static void MigrateHashmap(HashmapInfo *hashmap_info,const size_t groups)
 {
-#define MaxCapacities  20
-
-  const size_t
-    capacities[MaxCapacities] =
-    {
-      17, 31, 61, 131, 257, 509, 1021, 2053, 4099, 8191, 16381, 32771,
-      65537, 131071, 262147, 524287, 1048573, 2097143, 4194301, 8388617
-    };
-
-  ElementInfo
-    *element;
-
-  EntryInfo
-    *entry;
-
-  LinkedListInfo
-    *map_info,
-    **map;
-
-  register ElementInfo
-    *next;
-
-  register ssize_t
+  register size_t
     i;
 
   size_t
-    capacity;
+    extent;
 
   /*
-    Increase to the next prime capacity.
-  */
-  for (i=0; i < MaxCapacities; i++)
-    if (hashmap_info->capacity < capacities[i])
-      break;
-  if (i >= (MaxCapacities-1))
-    return(WizardFalse);
-  capacity=capacities[i+1];
-  map=(LinkedListInfo **) AcquireQuantumMemory((size_t) capacity+1UL,
-    sizeof(*map));
-  if (map == (LinkedListInfo **) NULL)
-    return(WizardFalse);
-  (void) ResetWizardMemory(map,0,(size_t) capacity*sizeof(*map));
-  /*
-    Copy entries to new hashmap with increased capacity.
+    Move the entries of up to the given number of groups from the previous
+    table to the current one; free the previous table once it is drained.
   */
-  for (i=0; i < (ssize_t) hashmap_info->capacity; i++)
+  if (hashmap_info->previous_control == (unsigned char *) NULL)
+    return;
+  extent=hashmap_info->previous_capacity;
+  if (groups < ((extent-hashmap_info->migrate)/HashmapGroupSize))
+    extent=hashmap_info->migrate+groups*HashmapGroupSize;
+  for (i=hashmap_info->migrate; i < extent; i++)
   {
-    LinkedListInfo
-      *list_info;
+    size_t
+      slot;
 
-    list_info=hashmap_info->map[i];
-    if (list_info == (LinkedListInfo *) NULL)
+    unsigned char
+      code;
+
+    if (hashmap_info->previous_control[i] >= EmptyHashmapSlot)
       continue;
-    LockSemaphoreInfo(list_info->semaphore);
-    for (next=list_info->head; next != (ElementInfo *) NULL; )
+    slot=FindHashmapSlot(hashmap_info->control,hashmap_info->capacity,
+      hashmap_info->hash(hashmap_info->previous_map[i].key),&code);
+    if (hashmap_info->control[slot] == DeletedHashmapSlot)
+      hashmap_info->deletions--;
+    hashmap_info->control[slot]=code;
+    hashmap_info->map[slot]=hashmap_info->previous_map[i];
+    hashmap_info->previous_control[i]=DeletedHashmapSlot;
+    hashmap_info->previous_entries--;
+  }
+  hashmap_info->migrate=extent;
+  if (hashmap_info->migrate < hashmap_info->previous_capacity)
+    return;
+  hashmap_info->previous_control=(unsigned char *) RelinquishWizardMemory(
+    hashmap_info->previous_control);
+  hashmap_info->previous_map=(EntryInfo *) RelinquishWizardMemory(
+    hashmap_info->previous_map);
+  hashmap_info->previous_capacity=0;
+  hashmap_info->previous_entries=0;
+  hashmap_info->migrate=0;
+}
+
+static WizardBooleanType GrowHashmap(HashmapInfo *hashmap_info,
+  const size_t capacity)
+{
+  EntryInfo
+    *map;
+
+  unsigned char
+    *control;
+
+  /*
+    Start migrating to a new table.  The entries move over a few groups at a
+    time with each later put or removal, instead of all at once.
+  */
+  control=(unsigned char *) AcquireQuantumMemory(capacity,sizeof(*control));
+  map=(EntryInfo *) AcquireQuantumMemory(capacity,sizeof(*map));
+  if ((control == (unsigned char *) NULL) || (map == (EntryInfo *) NULL))
     {
-      element=next;
-      next=next->next;
-      entry=(EntryInfo *) element->value;
-      map_info=map[entry->hash % capacity];
-      if (map_info == (LinkedListInfo *) NULL)
-        {
-          map_info=NewLinkedList(0);
-          map[entry->hash % capacity]=map_info;
-        }
-      map_info->next=element;
-      element->next=map_info->head;
-      map_info->head=element;
-      map_info->elements++;
+      if (control != (unsigned char *) NULL)
+        control=(unsigned char *) RelinquishWizardMemory(control);
+      if (map != (EntryInfo *) NULL)
+        map=(EntryInfo *) RelinquishWizardMemory(map);
+      return(WizardFalse);
     }
-    list_info->signature=(~WizardSignature);
-    UnlockSemaphoreInfo(list_info->semaphore);
-    RelinquishSemaphoreInfo(&list_info->semaphore);
-    list_info=(LinkedListInfo *) RelinquishWizardMemory(list_info);
-  }
-  hashmap_info->map=(LinkedListInfo **) RelinquishWizardMemory(hashmap_info->map);
+  (void) memset(control,EmptyHashmapSlot,capacity*sizeof(*control));
+  MigrateHashmap(hashmap_info,hashmap_info->previous_capacity);
+  hashmap_info->previous_control=hashmap_info->control;
+  hashmap_info->previous_map=hashmap_info->map;
+  hashmap_info->previous_capacity=hashmap_info->capacity;
+  hashmap_info->previous_entries=hashmap_info->entries;
+  hashmap_info->migrate=0;
+  hashmap_info->control=control;
   hashmap_info->map=map;
   hashmap_info->capacity=capacity;
+  hashmap_info->deletions=0;
   return(WizardTrue);
 }
 
@@ -1494,75 +2125,71 @@ WizardExport WizardBooleanType PutEntryInHashmap(HashmapInfo *hashmap_info,
   const void *key,const void *value)
 {
   EntryInfo
-    *entry,
-    *next;
+    *entry;
 
-  LinkedListInfo
-    *list_info;
+  size_t
+    hash,
+    slot;
 
-  register size_t
-    i;
+  unsigned char
+    code;
 
   assert(hashmap_info != (HashmapInfo *) NULL);
   assert(hashmap_info->signature == WizardSignature);
   if ((key == (void *) NULL) || (value == (void *) NULL))
     return(WizardFalse);
-  next=(EntryInfo *) AcquireWizardMemory(sizeof(*next));
-  if (next == (EntryInfo *) NULL)
-    return(WizardFalse);
-  LockSemaphoreInfo(hashmap_info->semaphore);
-  next->hash=hashmap_info->hash(key);
-  next->key=(void *) key;
-  next->value=(void *) value;
-  list_info=hashmap_info->map[next->hash % hashmap_info->capacity];
-  if (list_info == (LinkedListInfo *) NULL)
-    {
-      list_info=NewLinkedList(0);
-      hashmap_info->map[next->hash % hashmap_info->capacity]=list_info;
-    }
-  else
+  hash=hashmap_info->hash(key);
+  hashmap_info=GetHashmapStripe(hashmap_info,hash);
+  LockHashmap(hashmap_info);
+  MigrateHashmap(hashmap_info,HashmapMigrateGroups);
+  entry=GetHashmapEntry(hashmap_info,key,hash);
+  if (entry != (EntryInfo *) NULL)
     {
-      list_info->next=list_info->head;
-      entry=(EntryInfo *) GetNextValueInLinkedList(list_info);
-      for (i=0; entry != (EntryInfo *) NULL; i++)
-      {
-        if (entry->hash == next->hash)
-          {
-            WizardBooleanType
-              compare;
-
-            compare=WizardTrue;
-            if (hashmap_info->compare !=
-                (WizardBooleanType (*)(const void *,const void *)) NULL)
-              compare=hashmap_info->compare(key,entry->key);
-            if (compare == WizardTrue)
-              {
-                (void) RemoveElementFromLinkedList(list_info,i);
-                if (hashmap_info->relinquish_key != (void *(*)(void *)) NULL)
-                  entry->key=hashmap_info->relinquish_key(entry->key);
-                if (hashmap_info->relinquish_value != (void *(*)(void *)) NULL)
-                  entry->value=hashmap_info->relinquish_value(entry->value);
-                entry=(EntryInfo *) RelinquishWizardMemory(entry);
-                break;
-              }
-          }
-        entry=(EntryInfo *) GetNextValueInLinkedList(list_info);
-      }
+      /*
+        Replace the existing entry.
+      */
+      if ((hashmap_info->relinquish_key != (void *(*)(void *)) NULL) &&
+          (entry->key != key))
+        entry->key=hashmap_info->relinquish_key(entry->key);
+      if ((hashmap_info->relinquish_value != (void *(*)(void *)) NULL) &&
+          (entry->value != value))
+        entry->value=hashmap_info->relinquish_value(entry->value);
+      entry->key=(void *) key;
+      entry->value=(void *) value;
+      UnlockHashmap(hashmap_info);
+      return(WizardTrue);
     }
-  if (InsertValueInLinkedList(list_info,0,next) == WizardFalse)
+  if ((hashmap_info->entries-hashmap_info->previous_entries+
+       hashmap_info->deletions+1) >
+      (hashmap_info->capacity-hashmap_info->capacity/8))
     {
-      next=(EntryInfo *) RelinquishWizardMemory(next);
-      UnlockSemaphoreInfo(hashmap_info->semaphore);
-      return(WizardFalse);
+      size_t
+        capacity;
+
+      /*
+        Double the capacity, or just sweep the deleted slots if the map is
+        less than half full.  Migrating two groups per operation drains the
+        previous table long before the new one reaches this load again.
+      */
+      capacity=hashmap_info->capacity;
+      if ((2*(hashmap_info->entries+1)) > capacity)
+        capacity<<=1;
+      if ((capacity < hashmap_info->capacity) ||
+          (GrowHashmap(hashmap_info,capacity) == WizardFalse))
+        {
+          UnlockHashmap(hashmap_info);
+          return(WizardFalse);
+        }
     }
-  if (list_info->elements >= (hashmap_info->capacity-1))
-    if (IncreaseHashmapCapacity(hashmap_info) == WizardFalse)
-      {
-        UnlockSemaphoreInfo(hashmap_info->semaphore);
-        return(WizardFalse);
-      }
+  slot=FindHashmapSlot(hashmap_info->control,hashmap_info->capacity,hash,
+    &code);
+  if (hashmap_info->control[slot] == DeletedHashmapSlot)
+    hashmap_info->deletions--;
+  hashmap_info->control[slot]=code;
+  hashmap_info->map[slot].key=(void *) key;
+  hashmap_info->map[slot].value=(void *) value;
   hashmap_info->entries++;
-  UnlockSemaphoreInfo(hashmap_info->semaphore);
+  UnlockHashmap(hashmap_info);
   return(WizardTrue);
 }
 
@@ -1740,17 +2367,19 @@ WizardExport void *RemoveEntryFromHashmap(HashmapInfo *hashmap_info,
   const void *key)
 {
   EntryInfo
-    *entry;
-
-  LinkedListInfo
-    *list_info;
-
-  register size_t
-    i;
+    *entry,
+    *map;
 
   size_t
+    group,
     hash;
 
+  ssize_t
+    slot;
+
+  unsigned char
+    *control;
+
   void
     *value;
 
@@ -1758,46 +2387,49 @@ WizardExport void *RemoveEntryFromHashmap(HashmapInfo *hashmap_info,
   assert(hashmap_info->signature == WizardSignature);
   if (key == NULL)
     return((void *) NULL);
-  LockSemaphoreInfo(hashmap_info->semaphore);
   hash=hashmap_info->hash(key);
-  list_info=hashmap_info->map[hash % hashmap_info->capacity];
-  if (list_info != (LinkedListInfo *) NULL)
+  hashmap_info=GetHashmapStripe(hashmap_info,hash);
+  LockHashmap(hashmap_info);
+  MigrateHashmap(hashmap_info,HashmapMigrateGroups);
+  control=hashmap_info->control;
+  map=hashmap_info->map;
+  slot=FindHashmapEntry(hashmap_info,control,map,hashmap_info->capacity,key,
+    hash);
+  if ((slot < 0) && (hashmap_info->previous_control != (unsigned char *) NULL))
     {
-      list_info->next=list_info->head;
-      entry=(EntryInfo *) GetNextValueInLinkedList(list_info);
-      for (i=0; entry != (EntryInfo *) NULL; i++)
-      {
-        if (entry->hash == hash)
-          {
-            WizardBooleanType
-              compare;
-
-            compare=WizardTrue;
-            if (hashmap_info->compare !=
-                (WizardBooleanType (*)(const void *,const void *)) NULL)
-              compare=hashmap_info->compare(key,entry->key);
-            if (compare == WizardTrue)
-              {
-                entry=(EntryInfo *) RemoveElementFromLinkedList(list_info,i);
-                if (entry == (EntryInfo *) NULL)
-                  {
-                    UnlockSemaphoreInfo(hashmap_info->semaphore);
-                    return((void *) NULL);
-                  }
-                if (hashmap_info->relinquish_key != (void *(*)(void *)) NULL)
-                  entry->key=hashmap_info->relinquish_key(entry->key);
-                value=entry->value;
-                entry=(EntryInfo *) RelinquishWizardMemory(entry);
-                hashmap_info->entries--;
-                UnlockSemaphoreInfo(hashmap_info->semaphore);
-                return(value);
-              }
-          }
-        entry=(EntryInfo *) GetNextValueInLinkedList(list_info);
-      }
+      control=hashmap_info->previous_control;
+      map=hashmap_info->previous_map;
+      slot=FindHashmapEntry(hashmap_info,control,map,
+        hashmap_info->previous_capacity,key,hash);
     }
-  UnlockSemaphoreInfo(hashmap_info->semaphore);
-  return((void *) NULL);
+  if (slot < 0)
+    {
+      UnlockHashmap(hashmap_info);
+      return((void *) NULL);
+    }
+  entry=map+slot;
+  if (hashmap_info->relinquish_key != (void *(*)(void *)) NULL)
+    entry->key=hashmap_info->relinquish_key(entry->key);
+  value=entry->value;
+  /*
+    A probe stops at the first group with an empty slot, so no entry was
+    placed past a group that still has one: the slot can be emptied.
+    Otherwise leave a deleted marker to keep the probe sequences intact.
+  */
+  group=((size_t) slot/HashmapGroupSize)*HashmapGroupSize;
+  if (MatchHashmapGroup(control+group,EmptyHashmapSlot) != 0)
+    control[slot]=EmptyHashmapSlot;
+  else
+    {
+      control[slot]=DeletedHashmapSlot;
+      if (control == hashmap_info->control)
+        hashmap_info->deletions++;
+    }
+  if (control != hashmap_info->control)
+    hashmap_info->previous_entries--;
+  hashmap_info->entries--;
+  UnlockHashmap(hashmap_info);
+  return(value);
 }
 
 /*
@@ -1864,6 +2496,79 @@ WizardExport void *RemoveLastElementFromLinkedList(LinkedListInfo *list_info)
 %                                                                             %
 %                                                                             %
 %                                                                             %
+%   R e s e r v e H a s h m a p C a p a c i t y                               %
+%                                                                             %
+%                                                                             %
+%                                                                             %
+%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%
+%
+%  ReserveHashmapCapacity() sizes the hash-map to hold the given number of
+%  entries without growing, so a caller that knows its size up front pays
+%  for the rehash once, here, rather than while it fills the map.
+%
+%  The format of the ReserveHashmapCapacity method is:
+%
+%      WizardBooleanType ReserveHashmapCapacity(HashmapInfo *hashmap_info,
+%        const size_t entries)
+%
+%  A description of each parameter follows:
+%
+%    o hashmap_info: The hashmap info.
+%
+%    o entries: The number of entries.
+%
+*/
+WizardExport WizardBooleanType ReserveHashmapCapacity(
+  HashmapInfo *hashmap_info,const size_t entries)
+{
+  size_t
+    capacity,
+    extent;
+
+  WizardBooleanType
+    status;
+
+  assert(hashmap_info != (HashmapInfo *) NULL);
+  assert(hashmap_info->signature == WizardSignature);
+  if (hashmap_info->stripes != (HashmapInfo **) NULL)
+    {
+      register ssize_t
+        i;
+
+      status=WizardTrue;
+      extent=(entries+hashmap_info->number_stripes-1)/
+        hashmap_info->number_stripes;
+      for (i=0; i < (ssize_t) hashmap_info->number_stripes; i++)
+        if (ReserveHashmapCapacity(hashmap_info->stripes[i],extent) ==
+            WizardFalse)
+          status=WizardFalse;
+      return(status);
+    }
+  LockHashmap(hashmap_info);
+  extent=Max(entries,hashmap_info->entries)+1;
+  capacity=hashmap_info->capacity;
+  while ((capacity-capacity/8) < extent)
+  {
+    if (capacity > ((~(size_t) 0) >> 2))
+      {
+        UnlockHashmap(hashmap_info);
+        return(WizardFalse);
+      }
+    capacity<<=1;
+  }
+  status=WizardTrue;
+  if (capacity > hashmap_info->capacity)
+    status=GrowHashmap(hashmap_info,capacity);
+  MigrateHashmap(hashmap_info,hashmap_info->previous_capacity);
+  UnlockHashmap(hashmap_info);
+  return(status);
+}
+
+/*
+%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%
+%                                                                             %
+%                                                                             %
+%                                                                             %
 %   R e s e t H a s h m a p I t e r a t o r                                   %
 %                                                                             %
 %                                                                             %
@@ -1886,10 +2591,17 @@ WizardExport void ResetHashmapIterator(HashmapInfo *hashmap_info)
 {
   assert(hashmap_info != (HashmapInfo *) NULL);
   assert(hashmap_info->signature == WizardSignature);
-  LockSemaphoreInfo(hashmap_info->semaphore);
+  LockHashmap(hashmap_info);
   hashmap_info->next=0;
-  hashmap_info->head_of_list=WizardFalse;
-  UnlockSemaphoreInfo(hashmap_info->semaphore);
+  if (hashmap_info->stripes != (HashmapInfo **) NULL)
+    {
+      register ssize_t
+        i;
+
+      for (i=0; i < (ssize_t) hashmap_info->number_stripes; i++)
+        ResetHashmapIterator(hashmap_info->stripes[i]);
+    }
+  UnlockHashmap(hashmap_info);
 }
 
 /*
@@ -35,6 +35,9 @@ typedef struct _LinkedListInfo
 
 extern WizardExport HashmapInfo
   *DestroyHashmap(HashmapInfo *),
+  *NewConcurrentHashmap(const size_t,const size_t,size_t (*)(const void *),
+    WizardBooleanType (*)(const void *,const void *),void *(*)(void *),
+    void *(*)(void *)),
   *NewHashmap(const size_t,size_t (*)(const void *),
     WizardBooleanType (*)(const void *,const void *),void *(*)(void *),
     void *(*)(void *));
@@ -47,13 +50,15 @@ extern WizardExport WizardBooleanType
   AppendValueToLinkedList(LinkedListInfo *,const void *),
   CompareHashmapString(const void *,const void *),
   CompareHashmapStringInfo(const void *,const void *),
+  HashmapComponentGenesis(void),
   InsertValueInLinkedList(LinkedListInfo *,const size_t,const void *),
   InsertValueInSortedLinkedList(LinkedListInfo *,
     int (*)(const void *,const void *),void **,const void *),
   IsHashmapEmpty(const HashmapInfo *),
   IsLinkedListEmpty(const LinkedListInfo *),
   LinkedListToArray(LinkedListInfo *,void **),
-  PutEntryInHashmap(HashmapInfo *,const void *,const void *);
+  PutEntryInHashmap(HashmapInfo *,const void *,const void *),
+  ReserveHashmapCapacity(HashmapInfo *,const size_t);
 
 extern WizardExport size_t
   HashPointerType(const void *),
@@ -44,11 +44,14 @@
 #include "wizard/exception.h"
 #include "wizard/exception-private.h"
 #include "wizard/file.h"
+#include "wizard/hashmap.h"
 #include "wizard/keyring.h"
 #include "wizard/magick.h"
 #include "wizard/memory_.h"
 #include "wizard/nt-base.h"
+#include "wizard/semaphore.h"
 #include "wizard/utility.h"
+#include "wizard/utility-private.h"
 #include "wizard/xml-tree.h"
 
 /*
@@ -56,12 +59,60 @@
 */
 #define KeyringFilename  "keyring.xdm"
 #define KeyringFiletype  "keyring"
+#define KeyringGenerationFlag  0x02
+#define KeyringIndexEntryExtent  16
+#define KeyringIndexExtension  "idx"
+#define KeyringIndexFiletype  "keyring-index"
+#define KeyringIndexHeaderExtent  100
+#define KeyringIndexMajorVersion  1
+#define KeyringIndexMinorVersion  0
+#define KeyringIndexTail  256
 #define KeyringProtocolMajorVersion  1
 #define KeyringProtocolMinorVersion  1
+#define KeyringTombstoneFlag  0x01
 
 /*
   Typedef declarations.
 */
+typedef struct _KeyringIndex
+{
+  unsigned char
+    *map;
+
+  const unsigned char
+    *entries;
+
+  size_t
+    length,
+    number_entries;
+
+  WizardSizeType
+    extent;
+} KeyringIndex;
+
+typedef struct _KeyringIndexEntry
+{
+  WizardSizeType
+    hash,
+    offset;
+} KeyringIndexEntry;
+
+typedef struct _KeyringCache
+{
+  char
+    *path;
+
+  HashmapInfo
+    *records;
+
+  WizardSizeType
+    device,
+    inode,
+    extent,
+    modify_time,
+    offset;
+} KeyringCache;
+
 struct _KeyringInfo
 {
   char
@@ -80,8 +131,39 @@ struct _KeyringInfo
     timestamp;
 
   size_t
+    flags,
     signature;
 };
+
+/*
+  Global declarations.
+*/
+static HashmapInfo
+  *keyring_caches = (HashmapInfo *) NULL;
+
+static SemaphoreInfo
+  *keyring_semaphore = (SemaphoreInfo *) NULL;
+
+static WizardBooleanType
+  keyring_caching = WizardFalse;
+
+/*
+  Forward declarations.
+*/
+static KeyringInfo
+  **ReadKeyringRecords(FileInfo *,const char *,size_t *,WizardSizeType *);
+
+static void
+  AppendKeyringIndexEntry(KeyringIndexEntry **,size_t *,size_t *,
+    const StringInfo *,const WizardSizeType),
+  WriteKeyringIndex(const char *,const struct stat *,const KeyringIndex *,
+    KeyringIndexEntry *,const size_t,const WizardSizeType);
+
+static WizardBooleanType
+  IsKeyringIndexWritable(const FileInfo *),
+  ReadKeyringHeader(FileInfo *,WizardSizeType *),
+  WriteKeyringHeader(FileInfo *,WizardSizeType *),
+  WriteKeyringRecord(FileInfo *,const KeyringInfo *,WizardSizeType *);
 
 /*
 %%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%
@@ -123,6 +205,7 @@ WizardExport KeyringInfo *AcquireKeyringInfo(const char *path)
   keyring_info->protocol_major=KeyringProtocolMajorVersion;
   keyring_info->protocol_minor=KeyringProtocolMinorVersion;
   keyring_info->timestamp=time((time_t *) NULL);
+  keyring_info->flags=0;
   keyring_info->signature=WizardSignature;
   return(keyring_info);
 }
@@ -132,262 +215,316 @@ WizardExport KeyringInfo *AcquireKeyringInfo(const char *path)
 %                                                                             %
 %                                                                             %
 %                                                                             %
-%   D e s t r o y K e y r i n g I n f o                                       %
-%                                                                             %
-%                                                                             %
-%                                                                             %
-%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%
-%
-%  DestroyKeyringInfo() zeros memory associated with the KeyringInfo structure.
-%
-%  The format of the DestroyKeyringInfo method is:
-%
-%      KeyringInfo *DestroyKeyringInfo(KeyringInfo *keyring_info)
-%
-%  A description of each parameter follows:
-%
-%    o keyring_info: The ring info.
-%
-*/
-WizardExport KeyringInfo *DestroyKeyringInfo(KeyringInfo *keyring_info)
-{
-  (void) LogWizardEvent(TraceEvent,GetWizardModule(),"...");
-  WizardAssert(KeymapDomain,keyring_info != (KeyringInfo *) NULL);
-  WizardAssert(KeymapDomain,keyring_info->signature == WizardSignature);
-  if (keyring_info->nonce != (StringInfo *) NULL)
-    keyring_info->nonce=DestroyStringInfo(keyring_info->nonce);
-  if (keyring_info->key != (StringInfo *) NULL)
-    keyring_info->key=DestroyStringInfo(keyring_info->key);
-  if (keyring_info->id != (StringInfo *) NULL)
-    keyring_info->id=DestroyStringInfo(keyring_info->id);
-  if (keyring_info->path != (char *) NULL)
-    keyring_info->path=DestroyString(keyring_info->path);
-  keyring_info->signature=(~WizardSignature);
-  keyring_info=(KeyringInfo *) RelinquishWizardMemory(keyring_info);
-  return(keyring_info);
-}
-
-/*
-%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%
-%                                                                             %
-%                                                                             %
-%                                                                             %
-%   E x p o r t K e y r i n g K e y                                           %
+%   C o m p a c t K e y r i n g                                               %
 %                                                                             %
 %                                                                             %
 %                                                                             %
 %%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%
 %
-%  ExportKeyringKey() exports a key from the keyring.
+%  CompactKeyring() rewrites the keyring without its deleted and replaced
+%  records, sorted by id, and bumps its generation number.  The compacted
+%  keyring is written to a temporary file that then replaces the keyring, so
+%  readers never see a partial keyring.
 %
-%  The format of the ExportKeyringKey method is:
+%  The format of the CompactKeyring method is:
 %
-%      WizardBooleanType ExportKeyringKey(KeyringInfo *keyring_info,
+%      WizardBooleanType CompactKeyring(const char *path,
 %        ExceptionInfo *exception)
 %
 %  A description of each parameter follows:
 %
-%    o keyring_info: The ring info.
+%    o path: The keyring path.
 %
 %    o exception: Return any errors or warnings in this structure.
 %
 */
-WizardExport WizardBooleanType ExportKeyringKey(KeyringInfo *keyring_info,
+WizardExport WizardBooleanType CompactKeyring(const char *path,
   ExceptionInfo *exception)
 {
+  char
+    extension[WizardPathExtent],
+    root[WizardPathExtent],
+    target[WizardPathExtent];
+
   FileInfo
+    *compact_info,
     *file_info;
 
-  WizardStatusType
-    status;
+  KeyringIndexEntry
+    *entries;
 
-  StringInfo
-    *filetype,
-    *id,
-    *key,
-    *magick,
-    *nonce,
-    *target;
+  KeyringInfo
+    *generation_info,
+    **keyring_info;
+
+  register ssize_t
+    i;
 
   size_t
-    length,
-    signature;
+    extent_entries,
+    number_entries,
+    number_keys;
+
+  struct stat
+    properties;
+
+  unsigned char
+    *datum;
 
   WizardSizeType
-    timestamp;
+    extent,
+    generation,
+    offset;
+
+  WizardStatusType
+    status;
 
   (void) LogWizardEvent(TraceEvent,GetWizardModule(),"...");
-  WizardAssert(KeymapDomain,keyring_info != (KeyringInfo *) NULL);
-  WizardAssert(KeymapDomain,keyring_info->signature == WizardSignature);
   WizardAssert(KeymapDomain,exception != (ExceptionInfo *) NULL);
-  file_info=AcquireFileInfo(keyring_info->path,KeyringFilename,ReadFileMode,
-    exception);
+  file_info=AcquireFileInfo(path,KeyringFilename,WriteFileMode,exception);
   if (file_info == (FileInfo *) NULL)
     return(WizardFalse);
-  magick=GetWizardMagick(WizardMagick,sizeof(WizardMagick));
-  target=CloneStringInfo(magick);
-  status=ReadFileChunk(file_info,GetStringInfoDatum(target),
-    GetStringInfoLength(target));
-  if ((status == WizardFalse) || (CompareStringInfo(target,magick) != 0))
+  if (GetFileProperties(file_info)->st_size == 0)
     {
+      /*
+        Opening the keyring for writing created it, there is nothing to do.
+      */
+      (void) remove_utf8(GetFilePath(file_info));
+      (void) ThrowWizardException(exception,GetWizardModule(),KeyringError,
+        "unable to open key ring file `%s'",GetFilePath(file_info));
       file_info=DestroyFileInfo(file_info,exception);
+      return(WizardFalse);
+    }
+  keyring_info=(KeyringInfo **) NULL;
+  if (ReadKeyringHeader(file_info,&offset) != WizardFalse)
+    keyring_info=ReadKeyringRecords(file_info,path,&number_keys,&generation);
+  if (keyring_info == (KeyringInfo **) NULL)
+    {
       (void) ThrowWizardException(exception,GetWizardModule(),KeyringError,
         "corrupt key ring file `%s'",GetFilePath(file_info));
+      file_info=DestroyFileInfo(file_info,exception);
       return(WizardFalse);
     }
-  magick=DestroyStringInfo(magick);
-  target=DestroyStringInfo(target);
-  filetype=GetWizardMagick((unsigned char *) KeyringFiletype,
-    strlen(KeyringFiletype));
-  target=CloneStringInfo(filetype);
-  status&=ReadFileChunk(file_info,GetStringInfoDatum(target),
-    GetStringInfoLength(target));
-  if ((status == WizardFalse) || (CompareStringInfo(target,filetype) != 0))
+  /*
+    Write the live keys to a temporary keyring, led by a generation record.
+  */
+  GetPathComponent(GetFilePath(file_info),RootPath,root);
+  GetPathComponent(GetFilePath(file_info),ExtensionPath,extension);
+  (void) FormatLocaleString(target,WizardPathExtent,"%s~%s%s",root,
+    *extension != '\0' ? "." : "",extension);
+  (void) remove_utf8(target);
+  compact_info=AcquireFileInfo(target,KeyringFilename,WriteFileMode,exception);
+  if (compact_info == (FileInfo *) NULL)
     {
+      for (i=0; i < (ssize_t) number_keys; i++)
+        keyring_info[i]=DestroyKeyringInfo(keyring_info[i]);
+      keyring_info=(KeyringInfo **) RelinquishWizardMemory(keyring_info);
       file_info=DestroyFileInfo(file_info,exception);
-      (void) ThrowWizardException(exception,GetWizardModule(),KeyringError,
-        "corrupt key ring file `%s'",GetFilePath(file_info));
       return(WizardFalse);
     }
-  filetype=DestroyStringInfo(filetype);
-  target=DestroyStringInfo(target);
-  signature=0;
-  length=0;
-  while (ReadFile32Bits(file_info,&signature) != 0)
+  extent_entries=KeyringIndexTail;
+  number_entries=0;
+  entries=(KeyringIndexEntry *) NULL;
+  if (IsKeyringIndexWritable(file_info) != WizardFalse)
+    entries=(KeyringIndexEntry *) AcquireQuantumMemory(extent_entries,
+      sizeof(*entries));
+  status=WriteKeyringHeader(compact_info,&offset);
+  generation_info=AcquireKeyringInfo(path);
+  generation_info->id=AcquireStringInfo(0);
+  generation_info->key=AcquireStringInfo(8);
+  datum=GetStringInfoDatum(generation_info->key);
+  for (i=0; i < 8; i++)
+    datum[i]=(unsigned char) ((generation+1) >> (8*i));
+  generation_info->nonce=AcquireStringInfo(0);
+  generation_info->flags=KeyringGenerationFlag;
+  status&=WriteKeyringRecord(compact_info,generation_info,&extent);
+  AppendKeyringIndexEntry(&entries,&number_entries,&extent_entries,
+    generation_info->id,offset);
+  offset+=extent;
+  generation_info=DestroyKeyringInfo(generation_info);
+  for (i=0; i < (ssize_t) number_keys; i++)
   {
-    if (signature != WizardSignature)
-      {
-        file_info=DestroyFileInfo(file_info,exception);
-        (void) ThrowWizardException(exception,GetWizardModule(),KeyringError,
-          "corrupt key ring file `%s'",GetFilePath(file_info));
-        return(WizardFalse);
-      }
-    keyring_info->signature=signature;
-    status&=ReadFile32Bits(file_info,&length);
-    status&=ReadFile16Bits(file_info,&keyring_info->protocol_major);
-    status&=ReadFile16Bits(file_info,&keyring_info->protocol_minor);
-    if ((keyring_info->protocol_major == 1) &&
-        (keyring_info->protocol_minor == 0))
-      timestamp=(time_t) length;
-    else
-      status&=ReadFile64Bits(file_info,&timestamp);
-    keyring_info->timestamp=(time_t) timestamp;
-    status&=ReadFile32Bits(file_info,&length);
-    if (status == WizardFalse)
-      {
-        file_info=DestroyFileInfo(file_info,exception);
-        (void) ThrowWizardException(exception,GetWizardModule(),KeyringError,
-          "corrupt key ring file `%s'",GetFilePath(file_info));
-        return(WizardFalse);
-      }
-    id=AcquireStringInfo(length);
-    status&=ReadFileChunk(file_info,GetStringInfoDatum(id),
-      GetStringInfoLength(id));
-    status&=ReadFile32Bits(file_info,&length);
-    if (status == WizardFalse)
-      {
-        file_info=DestroyFileInfo(file_info,exception);
-        (void) ThrowWizardException(exception,GetWizardModule(),KeyringError,
-          "corrupt key ring file `%s'",GetFilePath(file_info));
-        return(WizardFalse);
-      }
-    key=AcquireStringInfo(length);
-    status&=ReadFileChunk(file_info,GetStringInfoDatum(key),
-      GetStringInfoLength(key));
-    status&=ReadFile32Bits(file_info,&length);
-    if (status == WizardFalse)
-      {
-        file_info=DestroyFileInfo(file_info,exception);
-        (void) ThrowWizardException(exception,GetWizardModule(),KeyringError,
-          "corrupt key ring file `%s'",GetFilePath(file_info));
-        return(WizardFalse);
-      }
-    nonce=AcquireStringInfo(length);
-    status&=ReadFileChunk(file_info,GetStringInfoDatum(nonce),
-      GetStringInfoLength(nonce));
-    if (CompareStringInfo(keyring_info->id,id) == 0)
-      {
-        SetKeyringKey(keyring_info,key);
-        SetKeyringNonce(keyring_info,nonce);
-        nonce=DestroyStringInfo(nonce);
-        key=DestroyStringInfo(key);
-        id=DestroyStringInfo(id);
-        file_info=DestroyFileInfo(file_info,exception);
-        return(WizardTrue);
-      }
-    nonce=DestroyStringInfo(nonce);
-    key=DestroyStringInfo(key);
-    id=DestroyStringInfo(id);
-    if (status == WizardFalse)
-      {
-        file_info=DestroyFileInfo(file_info,exception);
-        (void) ThrowWizardException(exception,GetWizardModule(),KeyringError,
-          "corrupt key ring file `%s'",GetFilePath(file_info));
-        return(WizardFalse);
-      }
+    status&=WriteKeyringRecord(compact_info,keyring_info[i],&extent);
+    AppendKeyringIndexEntry(&entries,&number_entries,&extent_entries,
+      keyring_info[i]->id,offset);
+    offset+=extent;
+    keyring_info[i]=DestroyKeyringInfo(keyring_info[i]);
   }
+  keyring_info=(KeyringInfo **) RelinquishWizardMemory(keyring_info);
+  status&=FlushFile(compact_info);
+#if defined(WIZARDSTOOLKIT_HAVE_FDATASYNC)
+  if (fdatasync(GetFileDescriptor(compact_info)) != 0)
+    status=WizardFalse;
+#elif defined(WIZARDSTOOLKIT_HAVE_FSYNC)
+  if (fsync(GetFileDescriptor(compact_info)) != 0)
+    status=WizardFalse;
+#endif
+  properties=(*GetFileProperties(compact_info));
+  compact_info=DestroyFileInfo(compact_info,exception);
+  /*
+    Replace the keyring and its index.
+  */
+  if (status != WizardFalse)
+    {
+#if defined(WIZARDSTOOLKIT_WINDOWS_SUPPORT)
+      (void) remove_utf8(GetFilePath(file_info));
+#endif
+      if (rename_utf8(target,GetFilePath(file_info)) == -1)
+        status=WizardFalse;
+    }
+  if (status == WizardFalse)
+    {
+      (void) ThrowWizardException(exception,GetWizardModule(),KeyringError,
+        "unable to compact keyring `%s': %s",GetFilePath(file_info),
+        strerror(errno));
+      (void) remove_utf8(target);
+    }
+  else
+    if (entries != (KeyringIndexEntry *) NULL)
+      WriteKeyringIndex(GetFilePath(file_info),&properties,
+        (const KeyringIndex *) NULL,entries,number_entries,offset);
+  if (entries != (KeyringIndexEntry *) NULL)
+    entries=(KeyringIndexEntry *) RelinquishWizardMemory(entries);
   file_info=DestroyFileInfo(file_info,exception);
-  return(WizardFalse);
+  return(status != WizardFalse ? WizardTrue : WizardFalse);
 }
-
+
 /*
 %%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%
 %                                                                             %
 %                                                                             %
 %                                                                             %
-%   G e t K e y r i n g K e y                                                 %
+%   D e l e t e K e y r i n g K e y                                           %
 %                                                                             %
 %                                                                             %
 %                                                                             %
 %%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%
 %
-%  GetKeyringKey() returns the keyring key.
+%  DeleteKeyringKey() deletes a key from the keyring by appending a tombstone
+%  for its id.  The space is reclaimed when the keyring is compacted.
 %
-%  The format of the GetKeyringKey method is:
+%  The format of the DeleteKeyringKey method is:
 %
-%      const StringInfo *GetKeyringKey(const KeyringInfo *keyring_info)
+%      WizardBooleanType DeleteKeyringKey(KeyringInfo *keyring_info,
+%        ExceptionInfo *exception)
 %
 %  A description of each parameter follows:
 %
-%    o keyring_info: The keyring info.
+%    o keyring_info: The ring info.
+%
+%    o exception: Return any errors or warnings in this structure.
 %
 */
-WizardExport const StringInfo *GetKeyringKey(const KeyringInfo *keyring_info)
+WizardExport WizardBooleanType DeleteKeyringKey(KeyringInfo *keyring_info,
+  ExceptionInfo *exception)
 {
+  FileInfo
+    *file_info;
+
+  KeyringInfo
+    *delete_info;
+
+  WizardSizeType
+    extent;
+
+  WizardStatusType
+    status;
+
   (void) LogWizardEvent(TraceEvent,GetWizardModule(),"...");
-  WizardAssert(KeyringDomain,keyring_info != (KeyringInfo *) NULL);
-  WizardAssert(KeyringDomain,keyring_info->signature == WizardSignature);
-  return(keyring_info->key);
+  WizardAssert(KeymapDomain,keyring_info != (KeyringInfo *) NULL);
+  WizardAssert(KeymapDomain,keyring_info->signature == WizardSignature);
+  WizardAssert(KeymapDomain,exception != (ExceptionInfo *) NULL);
+  delete_info=AcquireKeyringInfo(keyring_info->path);
+  SetKeyringId(delete_info,keyring_info->id);
+  if (ExportKeyringKey(delete_info,exception) == WizardFalse)
+    {
+      char
+        *id;
+
+      id=StringInfoToHexString(keyring_info->id);
+      (void) ThrowWizardException(exception,GetWizardModule(),KeyringError,
+        "unable to delete key `%s' (its not in the keyring): %s",id,
+        keyring_info->path);
+      id=DestroyString(id);
+      delete_info=DestroyKeyringInfo(delete_info);
+      return(WizardFalse);
+    }
+  file_info=AcquireFileInfo(keyring_info->path,KeyringFilename,WriteFileMode,
+    exception);
+  if (file_info == (FileInfo *) NULL)
+    {
+      delete_info=DestroyKeyringInfo(delete_info);
+      return(WizardFalse);
+    }
+  if (SeekFile(file_info,0,SEEK_END) == -1)
+    {
+      (void) ThrowWizardException(exception,GetWizardModule(),KeyringError,
+        "unable to seek keyring `%s': %s",GetFilePath(file_info),
+        strerror(errno));
+      delete_info=DestroyKeyringInfo(delete_info);
+      file_info=DestroyFileInfo(file_info,exception);
+      return(WizardFalse);
+    }
+  /*
+    A tombstone is a record of the id with no key or nonce.
+  */
+  delete_info->key=DestroyStringInfo(delete_info->key);
+  delete_info->key=AcquireStringInfo(0);
+  delete_info->nonce=DestroyStringInfo(delete_info->nonce);
+  delete_info->nonce=AcquireStringInfo(0);
+  delete_info->protocol_major=KeyringProtocolMajorVersion;
+  delete_info->protocol_minor=KeyringProtocolMinorVersion;
+  delete_info->timestamp=time((time_t *) NULL);
+  delete_info->flags=KeyringTombstoneFlag;
+  status=WriteKeyringRecord(file_info,delete_info,&extent);
+  status&=FlushFile(file_info);
+  if (status == WizardFalse)
+    (void) ThrowWizardException(exception,GetWizardModule(),KeyringError,
+      "unable to write keyring `%s': %s",GetFilePath(file_info),
+      strerror(errno));
+  delete_info=DestroyKeyringInfo(delete_info);
+  file_info=DestroyFileInfo(file_info,exception);
+  return(status != WizardFalse ? WizardTrue : WizardFalse);
 }
-
+
 /*
 %%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%
 %                                                                             %
 %                                                                             %
 %                                                                             %
-%   G e t K e y r i n g N o n c e                                             %
+%   D e s t r o y K e y r i n g I n f o                                       %
 %                                                                             %
 %                                                                             %
 %                                                                             %
 %%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%
 %
-%  GetKeyringNonce() returns the keyring nonce.
+%  DestroyKeyringInfo() zeros memory associated with the KeyringInfo structure.
 %
-%  The format of the GetKeyringNonce method is:
+%  The format of the DestroyKeyringInfo method is:
 %
-%      const StringInfo *GetKeyringNonce(const KeyringInfo *keyring_info)
+%      KeyringInfo *DestroyKeyringInfo(KeyringInfo *keyring_info)
 %
 %  A description of each parameter follows:
 %
-%    o keyring_info: The keyring info.
+%    o keyring_info: The ring info.
 %
 */
-WizardExport const StringInfo *GetKeyringNonce(const KeyringInfo *keyring_info)
+WizardExport KeyringInfo *DestroyKeyringInfo(KeyringInfo *keyring_info)
 {
   (void) LogWizardEvent(TraceEvent,GetWizardModule(),"...");
-  WizardAssert(KeyringDomain,keyring_info != (KeyringInfo *) NULL);
-  WizardAssert(KeyringDomain,keyring_info->signature == WizardSignature);
-  return(keyring_info->nonce);
+  WizardAssert(KeymapDomain,keyring_info != (KeyringInfo *) NULL);
+  WizardAssert(KeymapDomain,keyring_info->signature == WizardSignature);
+  if (keyring_info->nonce != (StringInfo *) NULL)
+    keyring_info->nonce=DestroyStringInfo(keyring_info->nonce);
+  if (keyring_info->key != (StringInfo *) NULL)
+    keyring_info->key=DestroyStringInfo(keyring_info->key);
+  if (keyring_info->id != (StringInfo *) NULL)
+    keyring_info->id=DestroyStringInfo(keyring_info->id);
+  if (keyring_info->path != (char *) NULL)
+    keyring_info->path=DestroyString(keyring_info->path);
+  keyring_info->signature=(~WizardSignature);
+  keyring_info=(KeyringInfo *) RelinquishWizardMemory(keyring_info);
+  return(keyring_info);
 }
 
 /*
@@ -395,17 +532,30 @@ WizardExport const StringInfo *GetKeyringNonce(const KeyringInfo *keyring_info)
 %                                                                             %
 %                                                                             %
 %                                                                             %
-%   I m p o r t K e y r i n g K e y                                           %
+%   E x p o r t K e y r i n g K e y                                           %
 %                                                                             %
 %                                                                             %
 %                                                                             %
 %%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%
 %
-%  ImportKeyringKey() imports a key to the keyring.
+%  ExportKeyringKey() exports a key from the keyring.
 %
-%  The format of the ImportKeyringKey method is:
+%  Keys are located with a sorted index of id hashes and record offsets kept
+%  in a sidecar file next to the keyring (e.g. keyring.idx), so a lookup is a
+%  binary search of the mapped index followed by a read of the one matching
+%  record.  Records appended after the index was written are scanned
+%  sequentially.  If the index is missing or no longer matches the keyring,
+%  the keyring is scanned in full and the index is rebuilt; this migrates
+%  existing keyrings transparently.  The keyring format is unchanged.
 %
-%      WizardBooleanType ImportKeyringKey(KeyringInfo *keyring_info,
+%  If the keyring cache is enabled with SetKeyringCache(), the keys are
+%  instead looked up in a process-wide hashmap.  It is revalidated with one
+%  stat(2) of the keyring per lookup and reloads only the records appended
+%  since it was last loaded.
+%
+%  The format of the ExportKeyringKey method is:
+%
+%      WizardBooleanType ExportKeyringKey(KeyringInfo *keyring_info,
 %        ExceptionInfo *exception)
 %
 %  A description of each parameter follows:
@@ -415,28 +565,1214 @@ WizardExport const StringInfo *GetKeyringNonce(const KeyringInfo *keyring_info)
 %    o exception: Return any errors or warnings in this structure.
 %
 */
-WizardExport WizardBooleanType ImportKeyringKey(KeyringInfo *keyring_info,
-  ExceptionInfo *exception)
+
+static int KeyringIndexCompare(const void *x,const void *y)
+{
+  register const KeyringIndexEntry
+    *p,
+    *q;
+
+  p=(const KeyringIndexEntry *) x;
+  q=(const KeyringIndexEntry *) y;
+  if (p->hash != q->hash)
+    return(p->hash < q->hash ? -1 : 1);
+  if (p->offset != q->offset)
+    return(p->offset < q->offset ? -1 : 1);
+  return(0);
+}
+
+static inline WizardSizeType GetKeyringIndex64Bits(const unsigned char *p)
+{
+  register ssize_t
+    i;
+
+  WizardSizeType
+    value;
+
+  value=0;
+  for (i=7; i >= 0; i--)
+    value=(value << 8) | p[i];
+  return(value);
+}
+
+static char *GetKeyringIndexPath(const char *keyring)
+{
+  char
+    *path;
+
+  path=AcquireString(keyring);
+  AppendFileExtension(KeyringIndexExtension,path);
+  return(path);
+}
+
+static inline WizardSizeType HashKeyringId(const StringInfo *id)
+{
+  register const unsigned char
+    *p;
+
+  register size_t
+    i;
+
+  WizardSizeType
+    hash;
+
+  /*
+    FNV-1a, so the index does not depend on the word size of the host.
+  */
+  hash=WizardULLConstant(14695981039346656037);
+  p=GetStringInfoDatum(id);
+  for (i=0; i < GetStringInfoLength(id); i++)
+  {
+    hash^=p[i];
+    hash*=WizardULLConstant(1099511628211);
+  }
+  return(hash);
+}
+
+static inline unsigned char *SetKeyringIndex64Bits(unsigned char *p,
+  const WizardSizeType value)
+{
+  register ssize_t
+    i;
+
+  for (i=0; i < 8; i++)
+    *p++=(unsigned char) (value >> (8*i));
+  return(p);
+}
+
+static WizardBooleanType IsKeyringIndexWritable(const FileInfo *file_info)
+{
+  char
+    directory[WizardPathExtent],
+    *path;
+
+  path=GetKeyringIndexPath(GetFilePath(file_info));
+  GetPathComponent(path,HeadPath,directory);
+  path=DestroyString(path);
+  if (*directory == '\0')
+    (void) CopyWizardString(directory,".",WizardPathExtent);
+  return(access_utf8(directory,W_OK) == 0 ? WizardTrue : WizardFalse);
+}
+
+static KeyringIndex *RelinquishKeyringIndex(KeyringIndex *index)
+{
+  if (index->map != (unsigned char *) NULL)
+    (void) UnmapBlob(index->map,index->length);
+  index=(KeyringIndex *) RelinquishWizardMemory(index);
+  return(index);
+}
+
+static KeyringIndex *AcquireKeyringIndex(FileInfo *file_info)
+{
+  char
+    *path;
+
+  const struct stat
+    *properties;
+
+  int
+    file;
+
+  KeyringIndex
+    *index;
+
+  register const unsigned char
+    *p;
+
+  StringInfo
+    *filetype,
+    *magick;
+
+  struct stat
+    attributes;
+
+  WizardBooleanType
+    status;
+
+  /*
+    Map the keyring index, if it exists and matches the keyring.
+  */
+  path=GetKeyringIndexPath(GetFilePath(file_info));
+  file=open_utf8(path,O_RDONLY | O_BINARY,0);
+  path=DestroyString(path);
+  if (file == -1)
+    return((KeyringIndex *) NULL);
+  if ((fstat(file,&attributes) != 0) ||
+      (attributes.st_size < (WizardOffsetType) KeyringIndexHeaderExtent))
+    {
+      (void) close(file);
+      return((KeyringIndex *) NULL);
+    }
+  index=(KeyringIndex *) AcquireWizardMemory(sizeof(*index));
+  if (index == (KeyringIndex *) NULL)
+    {
+      (void) close(file);
+      return((KeyringIndex *) NULL);
+    }
+  (void) ResetWizardMemory(index,0,sizeof(*index));
+  index->length=(size_t) attributes.st_size;
+  index->map=(unsigned char *) MapBlob(file,ReadMode,0,index->length);
+  (void) close(file);
+  if (index->map == (unsigned char *) NULL)
+    return(RelinquishKeyringIndex(index));
+  p=index->map;
+  magick=GetWizardMagick(WizardMagick,sizeof(WizardMagick));
+  status=memcmp(p,GetStringInfoDatum(magick),GetStringInfoLength(magick)) ==
+    0 ? WizardTrue : WizardFalse;
+  p+=GetStringInfoLength(magick);
+  magick=DestroyStringInfo(magick);
+  filetype=GetWizardMagick((unsigned char *) KeyringIndexFiletype,
+    strlen(KeyringIndexFiletype));
+  if (memcmp(p,GetStringInfoDatum(filetype),GetStringInfoLength(filetype)) != 0)
+    status=WizardFalse;
+  p+=GetStringInfoLength(filetype);
+  filetype=DestroyStringInfo(filetype);
+  if (((size_t) p[0] | ((size_t) p[1] << 8)) != KeyringIndexMajorVersion)
+    status=WizardFalse;
+  p+=4;
+  properties=GetFileProperties(file_info);
+  if ((GetKeyringIndex64Bits(p) != (WizardSizeType) properties->st_dev) ||
+      (GetKeyringIndex64Bits(p+8) != (WizardSizeType) properties->st_ino))
+    status=WizardFalse;
+  index->extent=GetKeyringIndex64Bits(p+16);
+  index->number_entries=(size_t) GetKeyringIndex64Bits(p+24);
+  index->entries=p+32;
+  if ((index->extent > (WizardSizeType) properties->st_size) ||
+      (index->number_entries != ((index->length-KeyringIndexHeaderExtent)/
+       KeyringIndexEntryExtent)) || (((index->length-KeyringIndexHeaderExtent) %
+       KeyringIndexEntryExtent) != 0))
+    status=WizardFalse;
+  if (status == WizardFalse)
+    return(RelinquishKeyringIndex(index));
+  return(index);
+}
+
+static void AppendKeyringIndexEntry(KeyringIndexEntry **entries,
+  size_t *number_entries,size_t *extent_entries,const StringInfo *id,
+  const WizardSizeType offset)
+{
+  if (*entries == (KeyringIndexEntry *) NULL)
+    return;
+  if (*number_entries == *extent_entries)
+    {
+      KeyringIndexEntry
+        *extent;
+
+      *extent_entries<<=1;
+      extent=(KeyringIndexEntry *) ResizeQuantumMemory(*entries,
+        *extent_entries,sizeof(**entries));
+      if (extent == (KeyringIndexEntry *) NULL)
+        {
+          *entries=(KeyringIndexEntry *) RelinquishWizardMemory(*entries);
+          return;
+        }
+      *entries=extent;
+    }
+  (*entries)[*number_entries].hash=HashKeyringId(id);
+  (*entries)[*number_entries].offset=offset;
+  (*number_entries)++;
+}
+
+static WizardBooleanType ReadKeyringHeader(FileInfo *file_info,
+  WizardSizeType *offset)
+{
+  StringInfo
+    *filetype,
+    *magick,
+    *target;
+
+  WizardStatusType
+    status;
+
+  /*
+    Verify the keyring magick and file type.
+  */
+  magick=GetWizardMagick(WizardMagick,sizeof(WizardMagick));
+  target=CloneStringInfo(magick);
+  status=ReadFileChunk(file_info,GetStringInfoDatum(target),
+    GetStringInfoLength(target));
+  if (CompareStringInfo(target,magick) != 0)
+    status=WizardFalse;
+  *offset=(WizardSizeType) GetStringInfoLength(magick);
+  magick=DestroyStringInfo(magick);
+  target=DestroyStringInfo(target);
+  filetype=GetWizardMagick((unsigned char *) KeyringFiletype,
+    strlen(KeyringFiletype));
+  target=CloneStringInfo(filetype);
+  status&=ReadFileChunk(file_info,GetStringInfoDatum(target),
+    GetStringInfoLength(target));
+  if (CompareStringInfo(target,filetype) != 0)
+    status=WizardFalse;
+  *offset+=(WizardSizeType) GetStringInfoLength(filetype);
+  filetype=DestroyStringInfo(filetype);
+  target=DestroyStringInfo(target);
+  return(status != WizardFalse ? WizardTrue : WizardFalse);
+}
+
+static WizardBooleanType ReadKeyringRecord(FileInfo *file_info,
+  KeyringInfo *record,WizardSizeType *extent)
+{
+  size_t
+    length;
+
+  WizardSizeType
+    timestamp;
+
+  WizardStatusType
+    status;
+
+  /*
+    Read the keyring record that follows the signature.  Version 1.0 keeps the
+    timestamp where later versions keep the record flags.
+  */
+  length=0;
+  status=ReadFile32Bits(file_info,&length);
+  status&=ReadFile16Bits(file_info,&record->protocol_major);
+  status&=ReadFile16Bits(file_info,&record->protocol_minor);
+  *extent+=12;
+  record->flags=0;
+  if ((record->protocol_major == 1) && (record->protocol_minor == 0))
+    timestamp=(time_t) length;
+  else
+    {
+      record->flags=length;
+      status&=ReadFile64Bits(file_info,&timestamp);
+      *extent+=8;
+    }
+  record->timestamp=(time_t) timestamp;
+  status&=ReadFile32Bits(file_info,&length);
+  if (status == WizardFalse)
+    return(WizardFalse);
+  record->id=AcquireStringInfo(length);
+  status&=ReadFileChunk(file_info,GetStringInfoDatum(record->id),length);
+  status&=ReadFile32Bits(file_info,&length);
+  *extent+=GetStringInfoLength(record->id)+4;
+  if (status == WizardFalse)
+    return(WizardFalse);
+  record->key=AcquireStringInfo(length);
+  status&=ReadFileChunk(file_info,GetStringInfoDatum(record->key),length);
+  status&=ReadFile32Bits(file_info,&length);
+  *extent+=GetStringInfoLength(record->key)+4;
+  if (status == WizardFalse)
+    return(WizardFalse);
+  record->nonce=AcquireStringInfo(length);
+  status&=ReadFileChunk(file_info,GetStringInfoDatum(record->nonce),length);
+  *extent+=GetStringInfoLength(record->nonce);
+  return(status != WizardFalse ? WizardTrue : WizardFalse);
+}
+
+static void ResetKeyringRecord(KeyringInfo *record)
+{
+  if (record->nonce != (StringInfo *) NULL)
+    record->nonce=DestroyStringInfo(record->nonce);
+  if (record->key != (StringInfo *) NULL)
+    record->key=DestroyStringInfo(record->key);
+  if (record->id != (StringInfo *) NULL)
+    record->id=DestroyStringInfo(record->id);
+}
+
+static void SetKeyringRecord(KeyringInfo *keyring_info,
+  const KeyringInfo *record,WizardBooleanType *found)
+{
+  /*
+    The last record of an id wins: a tombstone deletes the key, a later
+    record restores it.
+  */
+  if (((record->flags & KeyringGenerationFlag) != 0) ||
+      (CompareStringInfo(keyring_info->id,record->id) != 0))
+    return;
+  *found=WizardFalse;
+  if ((record->flags & KeyringTombstoneFlag) != 0)
+    return;
+  SetKeyringKey(keyring_info,record->key);
+  SetKeyringNonce(keyring_info,record->nonce);
+  keyring_info->protocol_major=record->protocol_major;
+  keyring_info->protocol_minor=record->protocol_minor;
+  keyring_info->timestamp=record->timestamp;
+  *found=WizardTrue;
+}
+
+static WizardBooleanType SearchKeyringIndex(KeyringInfo *keyring_info,
+  const KeyringIndex *index,FileInfo *file_info,WizardBooleanType *found)
+{
+  KeyringInfo
+    record;
+
+  size_t
+    signature;
+
+  ssize_t
+    first,
+    last,
+    middle;
+
+  WizardBooleanType
+    status;
+
+  WizardSizeType
+    extent,
+    hash;
+
+  /*
+    Binary search for the first entry with this id hash, then verify the
+    record of each entry that shares it in keyring order.
+  */
+  *found=WizardFalse;
+  hash=HashKeyringId(keyring_info->id);
+  first=0;
+  last=(ssize_t) index->number_entries;
+  while (first < last)
+  {
+    middle=first+(last-first)/2;
+    if (GetKeyringIndex64Bits(index->entries+middle*KeyringIndexEntryExtent) <
+        hash)
+      first=middle+1;
+    else
+      last=middle;
+  }
+  (void) ResetWizardMemory(&record,0,sizeof(record));
+  for ( ; first < (ssize_t) index->number_entries; first++)
+  {
+    register const unsigned char
+      *p;
+
+    p=index->entries+first*KeyringIndexEntryExtent;
+    if (GetKeyringIndex64Bits(p) != hash)
+      break;
+    if (SeekFile(file_info,(WizardOffsetType) GetKeyringIndex64Bits(p+8),
+        SEEK_SET) == -1)
+      return(WizardFalse);
+    signature=0;
+    extent=0;
+    status=ReadFile32Bits(file_info,&signature);
+    if ((status == WizardFalse) || (signature != WizardSignature))
+      return(WizardFalse);
+    status=ReadKeyringRecord(file_info,&record,&extent);
+    if ((status != WizardFalse) && ((record.id == (StringInfo *) NULL) ||
+        (HashKeyringId(record.id) != hash)))
+      {
+        /*
+          The keyring was rewritten in place, the entry is not this record.
+        */
+        status=WizardFalse;
+      }
+    if (status != WizardFalse)
+      SetKeyringRecord(keyring_info,&record,found);
+    ResetKeyringRecord(&record);
+    if (status == WizardFalse)
+      return(WizardFalse);
+  }
+  return(WizardTrue);
+}
+
+static void WriteKeyringIndex(const char *keyring,
+  const struct stat *properties,const KeyringIndex *index,
+  KeyringIndexEntry *entries,const size_t number_entries,
+  const WizardSizeType extent)
+{
+  char
+    *path,
+    *target;
+
+  int
+    file;
+
+  register ssize_t
+    i,
+    j;
+
+  register unsigned char
+    *q;
+
+  size_t
+    length,
+    number_indexes;
+
+  ssize_t
+    count,
+    offset;
+
+  StringInfo
+    *filetype,
+    *magick;
+
+  unsigned char
+    *buffer;
+
+  /*
+    Merge the indexed and the new entries and write them to a temporary file
+    that replaces the index, so readers never see a partial index.
+  */
+  qsort(entries,number_entries,sizeof(*entries),KeyringIndexCompare);
+  number_indexes=0;
+  if (index != (const KeyringIndex *) NULL)
+    number_indexes=index->number_entries;
+  length=KeyringIndexHeaderExtent+(number_indexes+number_entries)*
+    KeyringIndexEntryExtent;
+  buffer=(unsigned char *) AcquireQuantumMemory(length,sizeof(*buffer));
+  if (buffer == (unsigned char *) NULL)
+    return;
+  q=buffer;
+  magick=GetWizardMagick(WizardMagick,sizeof(WizardMagick));
+  (void) memcpy(q,GetStringInfoDatum(magick),GetStringInfoLength(magick));
+  q+=GetStringInfoLength(magick);
+  magick=DestroyStringInfo(magick);
+  filetype=GetWizardMagick((unsigned char *) KeyringIndexFiletype,
+    strlen(KeyringIndexFiletype));
+  (void) memcpy(q,GetStringInfoDatum(filetype),GetStringInfoLength(filetype));
+  q+=GetStringInfoLength(filetype);
+  filetype=DestroyStringInfo(filetype);
+  *q++=(unsigned char) KeyringIndexMajorVersion;
+  *q++=(unsigned char) (KeyringIndexMajorVersion >> 8);
+  *q++=(unsigned char) KeyringIndexMinorVersion;
+  *q++=(unsigned char) (KeyringIndexMinorVersion >> 8);
+  q=SetKeyringIndex64Bits(q,(WizardSizeType) properties->st_dev);
+  q=SetKeyringIndex64Bits(q,(WizardSizeType) properties->st_ino);
+  q=SetKeyringIndex64Bits(q,extent);
+  q=SetKeyringIndex64Bits(q,(WizardSizeType) (number_indexes+number_entries));
+  i=0;
+  j=0;
+  while ((i < (ssize_t) number_indexes) || (j < (ssize_t) number_entries))
+  {
+    KeyringIndexEntry
+      entry;
+
+    if (i < (ssize_t) number_indexes)
+      {
+        entry.hash=GetKeyringIndex64Bits(index->entries+i*
+          KeyringIndexEntryExtent);
+        entry.offset=GetKeyringIndex64Bits(index->entries+i*
+          KeyringIndexEntryExtent+8);
+        if ((j >= (ssize_t) number_entries) ||
+            (KeyringIndexCompare(&entry,entries+j) <= 0))
+          i++;
+        else
+          entry=entries[j++];
+      }
+    else
+      entry=entries[j++];
+    q=SetKeyringIndex64Bits(q,entry.hash);
+    q=SetKeyringIndex64Bits(q,entry.offset);
+  }
+  /*
+    Readers share the keyring lock and may rewrite the index concurrently, so
+    each writes its own temporary file.
+  */
+  path=GetKeyringIndexPath(keyring);
+  target=AcquireString(path);
+#if defined(WIZARDSTOOLKIT_HAVE_MKSTEMP)
+  (void) ConcatenateString(&target,"~XXXXXX");
+  file=mkstemp(target);
+#else
+  {
+    char
+      suffix[WizardPathExtent];
+
+    (void) FormatLocaleString(suffix,WizardPathExtent,"~%.20g",(double)
+      getpid());
+    (void) ConcatenateString(&target,suffix);
+  }
+  file=open_utf8(target,O_WRONLY | O_CREAT | O_EXCL | O_BINARY,S_MODE);
+#endif
+  if (file != -1)
+    {
+      for (offset=0; offset < (ssize_t) length; offset+=count)
+      {
+        count=write(file,buffer+offset,length-offset);
+        if (count <= 0)
+          {
+            count=0;
+            if (errno != EINTR)
+              break;
+          }
+      }
+      if ((close(file) == -1) || (offset < (ssize_t) length))
+        (void) remove_utf8(target);
+      else
+        {
+#if defined(WIZARDSTOOLKIT_WINDOWS_SUPPORT)
+          (void) remove_utf8(path);
+#endif
+          if (rename_utf8(target,path) == -1)
+            (void) remove_utf8(target);
+        }
+    }
+  target=DestroyString(target);
+  path=DestroyString(path);
+  buffer=(unsigned char *) RelinquishWizardMemory(buffer);
+}
+
+static size_t HashKeyringCacheId(const void *id)
+{
+  return((size_t) HashKeyringId((const StringInfo *) id));
+}
+
+static void *DestroyKeyringCacheRecord(void *record)
+{
+  return((void *) DestroyKeyringInfo((KeyringInfo *) record));
+}
+
+static void *DestroyKeyringCache(void *cache_info)
+{
+  KeyringCache
+    *cache;
+
+  cache=(KeyringCache *) cache_info;
+  if (cache->records != (HashmapInfo *) NULL)
+    cache->records=DestroyHashmap(cache->records);
+  if (cache->path != (char *) NULL)
+    cache->path=DestroyString(cache->path);
+  cache=(KeyringCache *) RelinquishWizardMemory(cache);
+  return((void *) NULL);
+}
+
+static void UpdateKeyringRecords(HashmapInfo *records,KeyringInfo *record,
+  WizardSizeType *generation)
+{
+  KeyringInfo
+    *keyring_info;
+
+  /*
+    Apply a record to a map of the live keys, indexed by id: the last record
+    of an id wins and a tombstone removes it.
+  */
+  if ((record->flags & KeyringGenerationFlag) != 0)
+    {
+      if ((generation != (WizardSizeType *) NULL) &&
+          (GetStringInfoLength(record->key) == 8))
+        *generation=GetKeyringIndex64Bits(GetStringInfoDatum(record->key));
+      record=DestroyKeyringInfo(record);
+      return;
+    }
+  if ((record->flags & KeyringTombstoneFlag) != 0)
+    {
+      keyring_info=(KeyringInfo *) RemoveEntryFromHashmap(records,record->id);
+      if (keyring_info != (KeyringInfo *) NULL)
+        keyring_info=DestroyKeyringInfo(keyring_info);
+      record=DestroyKeyringInfo(record);
+      return;
+    }
+  if (PutEntryInHashmap(records,record->id,record) == WizardFalse)
+    record=DestroyKeyringInfo(record);
+}
+
+static inline WizardSizeType GetKeyringModifyTime(
+  const struct stat *properties)
+{
+  WizardSizeType
+    modify_time;
+
+  modify_time=1000000000*(WizardSizeType) properties->st_mtime;
+#if defined(st_mtime) && !defined(__APPLE__)
+  modify_time+=(WizardSizeType) properties->st_mtim.tv_nsec;
+#endif
+  return(modify_time);
+}
+
+static WizardBooleanType IsKeyringCacheCurrent(const KeyringCache *cache,
+  const struct stat *properties)
+{
+  if ((cache->device != (WizardSizeType) properties->st_dev) ||
+      (cache->inode != (WizardSizeType) properties->st_ino) ||
+      (cache->extent != (WizardSizeType) properties->st_size) ||
+      (cache->modify_time != GetKeyringModifyTime(properties)))
+    return(WizardFalse);
+  return(WizardTrue);
+}
+
+static WizardBooleanType LoadKeyringCache(KeyringCache *cache,
+  const char *path,ExceptionInfo *exception)
+{
+  const struct stat
+    *properties;
+
+  FileInfo
+    *file_info;
+
+  KeyringInfo
+    *record;
+
+  size_t
+    signature;
+
+  WizardSizeType
+    offset;
+
+  WizardStatusType
+    status;
+
+  /*
+    Read the records appended since the cache was loaded, or all of them if
+    the keyring was replaced or rewritten.
+  */
+  file_info=AcquireFileInfo(path,KeyringFilename,ReadFileMode,exception);
+  if (file_info == (FileInfo *) NULL)
+    return(WizardFalse);
+  properties=GetFileProperties(file_info);
+  if ((cache->records == (HashmapInfo *) NULL) ||
+      (cache->device != (WizardSizeType) properties->st_dev) ||
+      (cache->inode != (WizardSizeType) properties->st_ino) ||
+      (cache->extent > (WizardSizeType) properties->st_size) ||
+      ((cache->extent == (WizardSizeType) properties->st_size) &&
+       (cache->modify_time != GetKeyringModifyTime(properties))))
+    {
+      if (cache->records != (HashmapInfo *) NULL)
+        cache->records=DestroyHashmap(cache->records);
+      cache->records=NewHashmap(LargeHashmapSize,HashKeyringCacheId,
+        CompareHashmapStringInfo,(void *(*)(void *)) NULL,
+        DestroyKeyringCacheRecord);
+      cache->offset=0;
+    }
+  status=ReadKeyringHeader(file_info,&offset);
+  if (cache->offset > offset)
+    {
+      offset=cache->offset;
+      if (SeekFile(file_info,(WizardOffsetType) offset,SEEK_SET) == -1)
+        status=WizardFalse;
+    }
+  signature=0;
+  while ((status != WizardFalse) &&
+         (ReadFile32Bits(file_info,&signature) != WizardFalse))
+  {
+    WizardSizeType
+      extent;
+
+    if (signature != WizardSignature)
+      {
+        status=WizardFalse;
+        break;
+      }
+    extent=4;
+    record=AcquireKeyringInfo((const char *) NULL);
+    status=ReadKeyringRecord(file_info,record,&extent);
+    if (status == WizardFalse)
+      {
+        record=DestroyKeyringInfo(record);
+        break;
+      }
+    UpdateKeyringRecords(cache->records,record,(WizardSizeType *) NULL);
+    offset+=extent;
+  }
+  if (status == WizardFalse)
+    {
+      (void) ThrowWizardException(exception,GetWizardModule(),KeyringError,
+        "corrupt key ring file `%s'",GetFilePath(file_info));
+      cache->records=DestroyHashmap(cache->records);
+      file_info=DestroyFileInfo(file_info,exception);
+      return(WizardFalse);
+    }
+  cache->device=(WizardSizeType) properties->st_dev;
+  cache->inode=(WizardSizeType) properties->st_ino;
+  cache->extent=(WizardSizeType) properties->st_size;
+  cache->modify_time=GetKeyringModifyTime(properties);
+  cache->offset=offset;
+  if (cache->path == (char *) NULL)
+    cache->path=ConstantString(GetFilePath(file_info));
+  file_info=DestroyFileInfo(file_info,exception);
+  return(WizardTrue);
+}
+
+static WizardBooleanType GetKeyringCacheRecord(KeyringInfo *keyring_info,
+  ExceptionInfo *exception)
+{
+  const char
+    *path;
+
+  const KeyringInfo
+    *record;
+
+  KeyringCache
+    *cache;
+
+  struct stat
+    attributes;
+
+  WizardBooleanType
+    found;
+
+  /*
+    Look up the key in the keyring cache, revalidated with one stat(2).
+  */
+  path=keyring_info->path != (char *) NULL ? keyring_info->path : "";
+  if (keyring_semaphore == (SemaphoreInfo *) NULL)
+    ActivateSemaphoreInfo(&keyring_semaphore);
+  LockSemaphoreInfo(keyring_semaphore);
+  if (keyring_caches == (HashmapInfo *) NULL)
+    keyring_caches=NewHashmap(SmallHashmapSize,HashStringType,
+      CompareHashmapString,RelinquishWizardMemory,DestroyKeyringCache);
+  cache=(KeyringCache *) GetValueFromHashmap(keyring_caches,path);
+  if (cache == (KeyringCache *) NULL)
+    {
+      cache=(KeyringCache *) AcquireWizardMemory(sizeof(*cache));
+      if (cache == (KeyringCache *) NULL)
+        {
+          UnlockSemaphoreInfo(keyring_semaphore);
+          ThrowWizardFatalError(KeyringDomain,MemoryError);
+        }
+      (void) ResetWizardMemory(cache,0,sizeof(*cache));
+      (void) PutEntryInHashmap(keyring_caches,ConstantString(path),cache);
+    }
+  if ((cache->records == (HashmapInfo *) NULL) ||
+      (stat_utf8(cache->path,&attributes) != 0) ||
+      (IsKeyringCacheCurrent(cache,&attributes) == WizardFalse))
+    if (LoadKeyringCache(cache,keyring_info->path,exception) == WizardFalse)
+      {
+        UnlockSemaphoreInfo(keyring_semaphore);
+        return(WizardFalse);
+      }
+  found=WizardFalse;
+  record=(const KeyringInfo *) GetValueFromHashmap(cache->records,
+    keyring_info->id);
+  if (record != (const KeyringInfo *) NULL)
+    SetKeyringRecord(keyring_info,record,&found);
+  UnlockSemaphoreInfo(keyring_semaphore);
+  return(found);
+}
+
+WizardExport WizardBooleanType ExportKeyringKey(KeyringInfo *keyring_info,
+  ExceptionInfo *exception)
 {
   FileInfo
     *file_info;
 
+  KeyringIndex
+    *index;
+
+  KeyringIndexEntry
+    *entries;
+
   KeyringInfo
-    *import_info;
+    record;
+
+  size_t
+    extent_entries,
+    number_entries,
+    signature;
+
+  WizardBooleanType
+    found;
+
+  WizardSizeType
+    offset;
 
   WizardStatusType
     status;
 
+  (void) LogWizardEvent(TraceEvent,GetWizardModule(),"...");
+  WizardAssert(KeymapDomain,keyring_info != (KeyringInfo *) NULL);
+  WizardAssert(KeymapDomain,keyring_info->signature == WizardSignature);
+  WizardAssert(KeymapDomain,exception != (ExceptionInfo *) NULL);
+  if (keyring_caching != WizardFalse)
+    return(GetKeyringCacheRecord(keyring_info,exception));
+  file_info=AcquireFileInfo(keyring_info->path,KeyringFilename,ReadFileMode,
+    exception);
+  if (file_info == (FileInfo *) NULL)
+    return(WizardFalse);
+  status=ReadKeyringHeader(file_info,&offset);
+  if (status == WizardFalse)
+    {
+      (void) ThrowWizardException(exception,GetWizardModule(),KeyringError,
+        "corrupt key ring file `%s'",GetFilePath(file_info));
+      file_info=DestroyFileInfo(file_info,exception);
+      return(WizardFalse);
+    }
+  found=WizardFalse;
+  index=AcquireKeyringIndex(file_info);
+  if (index != (KeyringIndex *) NULL)
+    {
+      /*
+        Look up the key in the index, then scan any records appended since.
+      */
+      status=SearchKeyringIndex(keyring_info,index,file_info,&found);
+      if ((status != WizardFalse) &&
+          (SeekFile(file_info,(WizardOffsetType) index->extent,SEEK_SET) ==
+           -1))
+        status=WizardFalse;
+      if (status == WizardFalse)
+        {
+          /*
+            The index is stale, rebuild it from the keyring.
+          */
+          index=RelinquishKeyringIndex(index);
+          found=WizardFalse;
+          status=SeekFile(file_info,(WizardOffsetType) offset,SEEK_SET) !=
+            -1 ? WizardTrue : WizardFalse;
+        }
+      else
+        offset=index->extent;
+    }
+  /*
+    Scan the keyring sequentially to its end, since a later record of the id
+    may delete or replace the key, and collect the index entries of the
+    records read, unless the index cannot be written anyway.
+  */
+  extent_entries=KeyringIndexTail;
+  number_entries=0;
+  entries=(KeyringIndexEntry *) NULL;
+  if ((index != (KeyringIndex *) NULL) ||
+      (IsKeyringIndexWritable(file_info) != WizardFalse))
+    entries=(KeyringIndexEntry *) AcquireQuantumMemory(extent_entries,
+      sizeof(*entries));
+  (void) ResetWizardMemory(&record,0,sizeof(record));
+  signature=0;
+  while ((status != WizardFalse) &&
+         (ReadFile32Bits(file_info,&signature) != WizardFalse))
+  {
+    WizardSizeType
+      extent;
+
+    if (signature != WizardSignature)
+      {
+        status=WizardFalse;
+        break;
+      }
+    extent=4;
+    status=ReadKeyringRecord(file_info,&record,&extent);
+    if (status == WizardFalse)
+      break;
+    SetKeyringRecord(keyring_info,&record,&found);
+    AppendKeyringIndexEntry(&entries,&number_entries,&extent_entries,
+      record.id,offset);
+    ResetKeyringRecord(&record);
+    offset+=extent;
+  }
+  ResetKeyringRecord(&record);
+  if (status == WizardFalse)
+    (void) ThrowWizardException(exception,GetWizardModule(),KeyringError,
+      "corrupt key ring file `%s'",GetFilePath(file_info));
+  else
+    if ((entries != (KeyringIndexEntry *) NULL) &&
+        ((index == (KeyringIndex *) NULL) ||
+         (number_entries >= KeyringIndexTail)))
+      WriteKeyringIndex(GetFilePath(file_info),GetFileProperties(file_info),
+        index,entries,number_entries,offset);
+  if (entries != (KeyringIndexEntry *) NULL)
+    entries=(KeyringIndexEntry *) RelinquishWizardMemory(entries);
+  if (index != (KeyringIndex *) NULL)
+    index=RelinquishKeyringIndex(index);
+  file_info=DestroyFileInfo(file_info,exception);
+  if (status == WizardFalse)
+    return(WizardFalse);
+  return(found);
+}
+
+/*
+%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%
+%                                                                             %
+%                                                                             %
+%                                                                             %
+%   E x p o r t K e y r i n g K e y s                                         %
+%                                                                             %
+%                                                                             %
+%                                                                             %
+%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%
+%
+%  ExportKeyringKeys() exports every key from the keyring in a single pass
+%  under one lock.  Deleted keys are left out and the rest are returned
+%  sorted by id.  Free each key with DestroyKeyringInfo() and the list with
+%  RelinquishWizardMemory().
+%
+%  The format of the ExportKeyringKeys method is:
+%
+%      KeyringInfo **ExportKeyringKeys(const char *path,size_t *number_keys,
+%        ExceptionInfo *exception)
+%
+%  A description of each parameter follows:
+%
+%    o path: The keyring path.
+%
+%    o number_keys: Returns the number of keys exported.
+%
+%    o exception: Return any errors or warnings in this structure.
+%
+*/
+static int KeyringIdCompare(const void *x,const void *y)
+{
+  const KeyringInfo
+    **p,
+    **q;
+
+  p=(const KeyringInfo **) x;
+  q=(const KeyringInfo **) y;
+  return(CompareStringInfo((*p)->id,(*q)->id));
+}
+
+static KeyringInfo **ReadKeyringRecords(FileInfo *file_info,const char *path,
+  size_t *number_keys,WizardSizeType *generation)
+{
+  HashmapInfo
+    *records;
+
+  KeyringInfo
+    **keyring_info,
+    *record;
+
+  register ssize_t
+    i;
+
   size_t
-    length;
+    signature;
+
+  WizardSizeType
+    extent;
+
+  WizardStatusType
+    status;
+
+  /*
+    Read the records that follow the keyring header and resolve them to the
+    live keys, sorted by id.
+  */
+  *number_keys=0;
+  *generation=0;
+  records=NewHashmap(LargeHashmapSize,HashKeyringCacheId,
+    CompareHashmapStringInfo,(void *(*)(void *)) NULL,
+    DestroyKeyringCacheRecord);
+  status=WizardTrue;
+  signature=0;
+  while (ReadFile32Bits(file_info,&signature) != WizardFalse)
+  {
+    if (signature != WizardSignature)
+      {
+        status=WizardFalse;
+        break;
+      }
+    extent=4;
+    record=AcquireKeyringInfo(path);
+    status=ReadKeyringRecord(file_info,record,&extent);
+    if (status == WizardFalse)
+      {
+        record=DestroyKeyringInfo(record);
+        break;
+      }
+    UpdateKeyringRecords(records,record,generation);
+  }
+  if (status == WizardFalse)
+    {
+      records=DestroyHashmap(records);
+      return((KeyringInfo **) NULL);
+    }
+  keyring_info=(KeyringInfo **) AcquireQuantumMemory(
+    GetNumberOfEntriesInHashmap(records)+1,sizeof(*keyring_info));
+  if (keyring_info == (KeyringInfo **) NULL)
+    ThrowWizardFatalError(KeyringDomain,MemoryError);
+  ResetHashmapIterator(records);
+  record=(KeyringInfo *) GetNextValueInHashmap(records);
+  while (record != (KeyringInfo *) NULL)
+  {
+    keyring_info[(*number_keys)++]=record;
+    record=(KeyringInfo *) GetNextValueInHashmap(records);
+  }
+  for (i=0; i < (ssize_t) *number_keys; i++)
+    (void) RemoveEntryFromHashmap(records,keyring_info[i]->id);
+  records=DestroyHashmap(records);
+  qsort(keyring_info,*number_keys,sizeof(*keyring_info),KeyringIdCompare);
+  return(keyring_info);
+}
+
+WizardExport KeyringInfo **ExportKeyringKeys(const char *path,
+  size_t *number_keys,ExceptionInfo *exception)
+{
+  FileInfo
+    *file_info;
+
+  KeyringInfo
+    **keyring_info;
+
+  WizardSizeType
+    generation,
+    offset;
+
+  (void) LogWizardEvent(TraceEvent,GetWizardModule(),"...");
+  WizardAssert(KeymapDomain,number_keys != (size_t *) NULL);
+  WizardAssert(KeymapDomain,exception != (ExceptionInfo *) NULL);
+  *number_keys=0;
+  file_info=AcquireFileInfo(path,KeyringFilename,ReadFileMode,exception);
+  if (file_info == (FileInfo *) NULL)
+    return((KeyringInfo **) NULL);
+  keyring_info=(KeyringInfo **) NULL;
+  if (ReadKeyringHeader(file_info,&offset) != WizardFalse)
+    keyring_info=ReadKeyringRecords(file_info,path,number_keys,&generation);
+  if (keyring_info == (KeyringInfo **) NULL)
+    (void) ThrowWizardException(exception,GetWizardModule(),KeyringError,
+      "corrupt key ring file `%s'",GetFilePath(file_info));
+  file_info=DestroyFileInfo(file_info,exception);
+  return(keyring_info);
+}
 
+/*
+%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%
+%                                                                             %
+%                                                                             %
+%                                                                             %
+%   G e t K e y r i n g K e y                                                 %
+%                                                                             %
+%                                                                             %
+%                                                                             %
+%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%
+%
+%  GetKeyringKey() returns the keyring key.
+%
+%  The format of the GetKeyringKey method is:
+%
+%      const StringInfo *GetKeyringKey(const KeyringInfo *keyring_info)
+%
+%  A description of each parameter follows:
+%
+%    o keyring_info: The keyring info.
+%
+*/
+WizardExport const StringInfo *GetKeyringKey(const KeyringInfo *keyring_info)
+{
+  (void) LogWizardEvent(TraceEvent,GetWizardModule(),"...");
+  WizardAssert(KeyringDomain,keyring_info != (KeyringInfo *) NULL);
+  WizardAssert(KeyringDomain,keyring_info->signature == WizardSignature);
+  return(keyring_info->key);
+}
+
+/*
+%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%
+%                                                                             %
+%                                                                             %
+%                                                                             %
+%   G e t K e y r i n g N o n c e                                             %
+%                                                                             %
+%                                                                             %
+%                                                                             %
+%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%
+%
+%  GetKeyringNonce() returns the keyring nonce.
+%
+%  The format of the GetKeyringNonce method is:
+%
+%      const StringInfo *GetKeyringNonce(const KeyringInfo *keyring_info)
+%
+%  A description of each parameter follows:
+%
+%    o keyring_info: The keyring info.
+%
+*/
+WizardExport const StringInfo *GetKeyringNonce(const KeyringInfo *keyring_info)
+{
+  (void) LogWizardEvent(TraceEvent,GetWizardModule(),"...");
+  WizardAssert(KeyringDomain,keyring_info != (KeyringInfo *) NULL);
+  WizardAssert(KeyringDomain,keyring_info->signature == WizardSignature);
+  return(keyring_info->nonce);
+}
+
+/*
+%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%
+%                                                                             %
+%                                                                             %
+%                                                                             %
+%   I m p o r t K e y r i n g K e y                                           %
+%                                                                             %
+%                                                                             %
+%                                                                             %
+%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%
+%
+%  ImportKeyringKey() imports a key to the keyring.
+%
+%  The format of the ImportKeyringKey method is:
+%
+%      WizardBooleanType ImportKeyringKey(KeyringInfo *keyring_info,
+%        ExceptionInfo *exception)
+%
+%  A description of each parameter follows:
+%
+%    o keyring_info: The ring info.
+%
+%    o exception: Return any errors or warnings in this structure.
+%
+*/
+static WizardBooleanType WriteKeyringHeader(FileInfo *file_info,
+  WizardSizeType *offset)
+{
   StringInfo
     *filetype,
     *magick;
 
+  WizardStatusType
+    status;
+
+  magick=GetWizardMagick(WizardMagick,sizeof(WizardMagick));
+  status=WriteFileChunk(file_info,GetStringInfoDatum(magick),
+    GetStringInfoLength(magick));
+  *offset=(WizardSizeType) GetStringInfoLength(magick);
+  magick=DestroyStringInfo(magick);
+  filetype=GetWizardMagick((unsigned char *) KeyringFiletype,
+    strlen(KeyringFiletype));
+  status&=WriteFileChunk(file_info,GetStringInfoDatum(filetype),
+    GetStringInfoLength(filetype));
+  *offset+=(WizardSizeType) GetStringInfoLength(filetype);
+  filetype=DestroyStringInfo(filetype);
+  return(status != WizardFalse ? WizardTrue : WizardFalse);
+}
+
+static WizardBooleanType WriteKeyringRecord(FileInfo *file_info,
+  const KeyringInfo *keyring_info,WizardSizeType *extent)
+{
+  size_t
+    length;
+
+  WizardStatusType
+    status;
+
+  /*
+    Write a keyring record in the layout of its protocol: version 1.0 keeps
+    the timestamp where later versions keep the record flags.
+  */
+  status=WriteFile32Bits(file_info,WizardSignature);
+  if ((keyring_info->protocol_major == 1) &&
+      (keyring_info->protocol_minor == 0))
+    status&=WriteFile32Bits(file_info,(size_t) keyring_info->timestamp);
+  else
+    status&=WriteFile32Bits(file_info,keyring_info->flags);
+  status&=WriteFile16Bits(file_info,keyring_info->protocol_major);
+  status&=WriteFile16Bits(file_info,keyring_info->protocol_minor);
+  *extent=12;
+  if ((keyring_info->protocol_major != 1) ||
+      (keyring_info->protocol_minor != 0))
+    {
+      status&=WriteFile64Bits(file_info,(WizardSizeType)
+        keyring_info->timestamp);
+      *extent+=8;
+    }
+  length=GetStringInfoLength(keyring_info->id);
+  status&=WriteFile32Bits(file_info,(size_t) length);
+  status&=WriteFileChunk(file_info,GetStringInfoDatum(keyring_info->id),length);
+  *extent+=length+4;
+  length=GetStringInfoLength(keyring_info->key);
+  status&=WriteFile32Bits(file_info,(size_t) length);
+  status&=WriteFileChunk(file_info,GetStringInfoDatum(keyring_info->key),
+    length);
+  *extent+=length+4;
+  length=GetStringInfoLength(keyring_info->nonce);
+  status&=WriteFile32Bits(file_info,(size_t) length);
+  status&=WriteFileChunk(file_info,GetStringInfoDatum(keyring_info->nonce),
+    length);
+  *extent+=length+4;
+  return(status != WizardFalse ? WizardTrue : WizardFalse);
+}
+
+WizardExport WizardBooleanType ImportKeyringKey(KeyringInfo *keyring_info,
+  ExceptionInfo *exception)
+{
+  FileInfo
+    *file_info;
+
+  KeyringInfo
+    *import_info;
+
   WizardOffsetType
     offset;
 
+  WizardSizeType
+    extent;
+
+  WizardStatusType
+    status;
+
   (void) LogWizardEvent(TraceEvent,GetWizardModule(),"...");
   WizardAssert(KeymapDomain,keyring_info != (KeyringInfo *) NULL);
   WizardAssert(KeymapDomain,keyring_info->signature == WizardSignature);
@@ -464,48 +1800,285 @@ WizardExport WizardBooleanType ImportKeyringKey(KeyringInfo *keyring_info,
     exception);
   if (file_info == (FileInfo *) NULL)
     return(WizardFalse);
-  magick=GetWizardMagick(WizardMagick,sizeof(WizardMagick));
-  status=WriteFileChunk(file_info,GetStringInfoDatum(magick),
-    GetStringInfoLength(magick));
-  magick=DestroyStringInfo(magick);
-  filetype=GetWizardMagick((unsigned char *) KeyringFiletype,
-    strlen(KeyringFiletype));
-  status&=WriteFileChunk(file_info,GetStringInfoDatum(filetype),
-    GetStringInfoLength(filetype));
-  filetype=DestroyStringInfo(filetype);
-  offset=lseek(GetFileDescriptor(file_info),0,SEEK_END);
+  status=WriteKeyringHeader(file_info,&extent);
+  offset=SeekFile(file_info,0,SEEK_END);
   if (offset == -1)
     {
+      (void) ThrowWizardException(exception,GetWizardModule(),KeyringError,
+        "unable to seek keyring `%s': %s",GetFilePath(file_info),
+        strerror(errno));
+      file_info=DestroyFileInfo(file_info,exception);
+      return(WizardFalse);
+    }
+  status&=WriteKeyringRecord(file_info,keyring_info,&extent);
+  status&=FlushFile(file_info);
+  if (status == WizardFalse)
+    (void) ThrowWizardException(exception,GetWizardModule(),KeyringError,
+      "unable to write keyring `%s': %s",GetFilePath(file_info),
+      strerror(errno));
+  file_info=DestroyFileInfo(file_info,exception);
+  return(status != WizardFalse ? WizardTrue : WizardFalse);
+}
+
+/*
+%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%
+%                                                                             %
+%                                                                             %
+%                                                                             %
+%   I m p o r t K e y r i n g K e y s                                         %
+%                                                                             %
+%                                                                             %
+%                                                                             %
+%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%
+%
+%  ImportKeyringKeys() imports a list of keys to the keyring under one lock.
+%  The ids already in the keyring are collected in a single pass and the new
+%  keys are appended together; keys whose id is already in the keyring are
+%  skipped with a warning.
+%
+%  The format of the ImportKeyringKeys method is:
+%
+%      WizardBooleanType ImportKeyringKeys(const char *path,
+%        KeyringInfo **keyring_info,const size_t number_keys,
+%        ExceptionInfo *exception)
+%
+%  A description of each parameter follows:
+%
+%    o path: The keyring path.
+%
+%    o keyring_info: The keys.
+%
+%    o number_keys: The number of keys.
+%
+%    o exception: Return any errors or warnings in this structure.
+%
+*/
+
+static void *DestroyKeyringId(void *id)
+{
+  return((void *) DestroyStringInfo((StringInfo *) id));
+}
+
+WizardExport WizardBooleanType ImportKeyringKeys(const char *path,
+  KeyringInfo **keyring_info,const size_t number_keys,ExceptionInfo *exception)
+{
+  FileInfo
+    *file_info;
+
+  HashmapInfo
+    *ids;
+
+  KeyringIndexEntry
+    *entries;
+
+  KeyringInfo
+    record;
+
+  register ssize_t
+    i;
+
+  size_t
+    extent_entries,
+    number_entries,
+    number_skipped,
+    signature;
+
+  WizardSizeType
+    extent,
+    offset;
+
+  WizardStatusType
+    status;
+
+  (void) LogWizardEvent(TraceEvent,GetWizardModule(),"...");
+  WizardAssert(KeymapDomain,(keyring_info != (KeyringInfo **) NULL) ||
+    (number_keys == 0));
+  WizardAssert(KeymapDomain,exception != (ExceptionInfo *) NULL);
+  file_info=AcquireFileInfo(path,KeyringFilename,WriteFileMode,exception);
+  if (file_info == (FileInfo *) NULL)
+    return(WizardFalse);
+  if (GetFileProperties(file_info)->st_size == 0)
+    status=WriteKeyringHeader(file_info,&offset);
+  else
+    status=ReadKeyringHeader(file_info,&offset);
+  if (status == WizardFalse)
+    {
+      (void) ThrowWizardException(exception,GetWizardModule(),KeyringError,
+        "corrupt key ring file `%s'",GetFilePath(file_info));
+      file_info=DestroyFileInfo(file_info,exception);
+      return(WizardFalse);
+    }
+  /*
+    Collect the ids in the keyring, and the index entries of their records,
+    in one pass.
+  */
+  ids=NewHashmap(LargeHashmapSize,HashKeyringCacheId,CompareHashmapStringInfo,
+    (void *(*)(void *)) NULL,DestroyKeyringId);
+  extent_entries=KeyringIndexTail;
+  number_entries=0;
+  entries=(KeyringIndexEntry *) NULL;
+  if (IsKeyringIndexWritable(file_info) != WizardFalse)
+    entries=(KeyringIndexEntry *) AcquireQuantumMemory(extent_entries,
+      sizeof(*entries));
+  (void) ResetWizardMemory(&record,0,sizeof(record));
+  signature=0;
+  while ((status != WizardFalse) &&
+         (ReadFile32Bits(file_info,&signature) != WizardFalse))
+  {
+    if (signature != WizardSignature)
+      {
+        status=WizardFalse;
+        break;
+      }
+    extent=4;
+    status=ReadKeyringRecord(file_info,&record,&extent);
+    if (status == WizardFalse)
+      break;
+    AppendKeyringIndexEntry(&entries,&number_entries,&extent_entries,
+      record.id,offset);
+    if ((record.flags & KeyringTombstoneFlag) != 0)
+      {
+        StringInfo
+          *id;
+
+        id=(StringInfo *) RemoveEntryFromHashmap(ids,record.id);
+        if (id != (StringInfo *) NULL)
+          id=DestroyStringInfo(id);
+      }
+    else
+      if (((record.flags & KeyringGenerationFlag) == 0) &&
+          (GetValueFromHashmap(ids,record.id) == (void *) NULL) &&
+          (PutEntryInHashmap(ids,record.id,record.id) != WizardFalse))
+        record.id=(StringInfo *) NULL;
+    ResetKeyringRecord(&record);
+    offset+=extent;
+  }
+  ResetKeyringRecord(&record);
+  if (status == WizardFalse)
+    {
+      (void) ThrowWizardException(exception,GetWizardModule(),KeyringError,
+        "corrupt key ring file `%s'",GetFilePath(file_info));
+      if (entries != (KeyringIndexEntry *) NULL)
+        entries=(KeyringIndexEntry *) RelinquishWizardMemory(entries);
+      ids=DestroyHashmap(ids);
       file_info=DestroyFileInfo(file_info,exception);
+      return(WizardFalse);
+    }
+  /*
+    Append the new keys.
+  */
+  if (SeekFile(file_info,(WizardOffsetType) offset,SEEK_SET) == -1)
+    {
       (void) ThrowWizardException(exception,GetWizardModule(),KeyringError,
         "unable to seek keyring `%s': %s",GetFilePath(file_info),
         strerror(errno));
+      if (entries != (KeyringIndexEntry *) NULL)
+        entries=(KeyringIndexEntry *) RelinquishWizardMemory(entries);
+      ids=DestroyHashmap(ids);
+      file_info=DestroyFileInfo(file_info,exception);
       return(WizardFalse);
     }
-  status&=WriteFile32Bits(file_info,keyring_info->signature);
-  status&=WriteFile32Bits(file_info,0U);
-  status&=WriteFile16Bits(file_info,keyring_info->protocol_major);
-  status&=WriteFile16Bits(file_info,keyring_info->protocol_minor);
-  status&=WriteFile64Bits(file_info,(WizardSizeType) keyring_info->timestamp);
-  length=GetStringInfoLength(keyring_info->id);
-  status&=WriteFile32Bits(file_info,(size_t) length);
-  status&=WriteFileChunk(file_info,GetStringInfoDatum(keyring_info->id),length);
-  length=GetStringInfoLength(keyring_info->key);
-  status&=WriteFile32Bits(file_info,(size_t) length);
-  status&=WriteFileChunk(file_info,GetStringInfoDatum(keyring_info->key),
-    length);
-  length=GetStringInfoLength(keyring_info->nonce);
-  status&=WriteFile32Bits(file_info,(size_t) length);
-  status&=WriteFileChunk(file_info,GetStringInfoDatum(keyring_info->nonce),
-    length);
+  number_skipped=0;
+  for (i=0; i < (ssize_t) number_keys; i++)
+  {
+    StringInfo
+      *id;
+
+    WizardAssert(KeymapDomain,keyring_info[i]->signature == WizardSignature);
+    if (GetValueFromHashmap(ids,keyring_info[i]->id) != (void *) NULL)
+      {
+        number_skipped++;
+        continue;
+      }
+    status=WriteKeyringRecord(file_info,keyring_info[i],&extent);
+    if (status == WizardFalse)
+      break;
+    AppendKeyringIndexEntry(&entries,&number_entries,&extent_entries,
+      keyring_info[i]->id,offset);
+    id=CloneStringInfo(keyring_info[i]->id);
+    if (PutEntryInHashmap(ids,id,id) == WizardFalse)
+      id=DestroyStringInfo(id);
+    offset+=extent;
+  }
+  ids=DestroyHashmap(ids);
+  if (status != WizardFalse)
+    status=FlushFile(file_info);
   if (status == WizardFalse)
     (void) ThrowWizardException(exception,GetWizardModule(),KeyringError,
       "unable to write keyring `%s': %s",GetFilePath(file_info),
       strerror(errno));
+  else
+    {
+      if ((entries != (KeyringIndexEntry *) NULL) &&
+          (number_skipped < number_keys))
+        WriteKeyringIndex(GetFilePath(file_info),GetFileProperties(file_info),
+          (const KeyringIndex *) NULL,entries,number_entries,offset);
+      if (number_skipped != 0)
+        (void) ThrowWizardException(exception,GetWizardModule(),
+          KeyringWarning,"unable to import %.20g of %.20g keys (they are "
+          "already in the keyring): `%s'",(double) number_skipped,(double)
+          number_keys,GetFilePath(file_info));
+    }
+  if (entries != (KeyringIndexEntry *) NULL)
+    entries=(KeyringIndexEntry *) RelinquishWizardMemory(entries);
   file_info=DestroyFileInfo(file_info,exception);
+  return(status != WizardFalse ? WizardTrue : WizardFalse);
+}
+
+/*
+%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%
+%                                                                             %
+%                                                                             %
+%                                                                             %
++   K e y r i n g C o m p o n e n t G e n e s i s                             %
+%                                                                             %
+%                                                                             %
+%                                                                             %
+%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%
+%
+%  KeyringComponentGenesis() instantiates the keyring component.
+%
+%  The format of the KeyringComponentGenesis method is:
+%
+%      KeyringComponentGenesis(void)
+%
+*/
+WizardExport WizardBooleanType KeyringComponentGenesis(void)
+{
+  if (keyring_semaphore == (SemaphoreInfo *) NULL)
+    keyring_semaphore=AcquireSemaphoreInfo();
   return(WizardTrue);
 }
-
+
+/*
+%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%
+%                                                                             %
+%                                                                             %
+%                                                                             %
++   K e y r i n g C o m p o n e n t T e r m i n u s                           %
+%                                                                             %
+%                                                                             %
+%                                                                             %
+%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%
+%
+%  KeyringComponentTerminus() destroys the keyring component.
+%
+%  The format of the KeyringComponentTerminus method is:
+%
+%      KeyringComponentTerminus(void)
+%
+*/
+WizardExport void KeyringComponentTerminus(void)
+{
+  if (keyring_semaphore == (SemaphoreInfo *) NULL)
+    ActivateSemaphoreInfo(&keyring_semaphore);
+  LockSemaphoreInfo(keyring_semaphore);
+  if (keyring_caches != (HashmapInfo *) NULL)
+    keyring_caches=DestroyHashmap(keyring_caches);
+  UnlockSemaphoreInfo(keyring_semaphore);
+  RelinquishSemaphoreInfo(&keyring_semaphore);
+}
+
 /*
 %%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%
 %                                                                             %
@@ -550,33 +2123,37 @@ WizardExport WizardBooleanType PrintKeyringProperties(const char *path,
     *file_info;
 
   KeyringInfo
-    keyring_info;
-
-  ssize_t
-    count;
+    **keyring_info;
 
-  StringInfo
-    *filetype,
-    *id,
-    *key,
-    *magick,
-    *nonce,
-    *target;
+  register ssize_t
+    i;
 
   size_t
-    length;
+    length,
+    number_keys;
 
-  WizardSizeType
-    timestamp;
+  ssize_t
+    count;
 
-  WizardStatusType
-    status;
+  WizardSizeType
+    generation,
+    offset;
 
   (void) LogWizardEvent(TraceEvent,GetWizardModule(),"...");
   WizardAssert(KeymapDomain,exception != (ExceptionInfo *) NULL);
   file_info=AcquireFileInfo(path,KeyringFilename,ReadFileMode,exception);
   if (file_info == (FileInfo *) NULL)
     return(WizardTrue);
+  keyring_info=(KeyringInfo **) NULL;
+  if (ReadKeyringHeader(file_info,&offset) != WizardFalse)
+    keyring_info=ReadKeyringRecords(file_info,path,&number_keys,&generation);
+  if (keyring_info == (KeyringInfo **) NULL)
+    {
+      (void) ThrowWizardException(exception,GetWizardModule(),KeyringError,
+        "corrupt key ring file `%s'",GetFilePath(file_info));
+      file_info=DestroyFileInfo(file_info,exception);
+      return(WizardFalse);
+    }
   keyring_rdf=AcquireString("  <keyring:Keyring rdf:about=\"");
   canonical_path=CanonicalXMLContent(GetFilePath(file_info),WizardFalse);
   (void) ConcatenateString(&keyring_rdf,canonical_path);
@@ -594,94 +2171,21 @@ WizardExport WizardBooleanType PrintKeyringProperties(const char *path,
   (void) FormatWizardTime(time((time_t *) NULL),WizardPathExtent,message);
   (void) ConcatenateString(&keyring_rdf,message);
   (void) ConcatenateString(&keyring_rdf,"</keyring:timestamp>\n");
+  (void) ConcatenateString(&keyring_rdf,"    <keyring:generation>");
+  (void) FormatLocaleString(message,WizardPathExtent,"%.20g",(double)
+    generation);
+  (void) ConcatenateString(&keyring_rdf,message);
+  (void) ConcatenateString(&keyring_rdf,"</keyring:generation>\n");
   (void) ConcatenateString(&keyring_rdf,"  </keyring:Keyring>\n");
   length=strlen(keyring_rdf);
   count=WriteBlob(keyring_blob,length,(unsigned char *) keyring_rdf);
   keyring_rdf=DestroyString(keyring_rdf);
   if (count != (ssize_t) length)
     ThrowFileException(exception,FileError,GetFilePath(file_info));
-  magick=GetWizardMagick(WizardMagick,sizeof(WizardMagick));
-  target=CloneStringInfo(magick);
-  status=ReadFileChunk(file_info,GetStringInfoDatum(target),
-    GetStringInfoLength(target));
-  if ((status == WizardFalse) || (CompareStringInfo(target,magick) != 0))
-    {
-      file_info=DestroyFileInfo(file_info,exception);
-      (void) ThrowWizardException(exception,GetWizardModule(),KeyringError,
-        "corrupt key ring file `%s'",GetFilePath(file_info));
-      return(WizardFalse);
-    }
-  magick=DestroyStringInfo(magick);
-  target=DestroyStringInfo(target);
-  filetype=GetWizardMagick((unsigned char *) KeyringFiletype,
-    strlen(KeyringFiletype));
-  target=CloneStringInfo(filetype);
-  status&=ReadFileChunk(file_info,GetStringInfoDatum(target),
-    GetStringInfoLength(target));
-  if ((status == WizardFalse) || (CompareStringInfo(target,filetype) != 0))
-    {
-      file_info=DestroyFileInfo(file_info,exception);
-      (void) ThrowWizardException(exception,GetWizardModule(),KeyringError,
-        "corrupt key ring file `%s'",GetFilePath(file_info));
-      return(WizardFalse);
-    }
-  filetype=DestroyStringInfo(filetype);
-  target=DestroyStringInfo(target);
-  length=0;
-  (void) ResetWizardMemory(&keyring_info,0,sizeof(keyring_info));
-  while (ReadFile32Bits(file_info,&keyring_info.signature) != 0)
+  for (i=0; i < (ssize_t) number_keys; i++)
   {
-    if (keyring_info.signature != WizardSignature)
-      {
-        file_info=DestroyFileInfo(file_info,exception);
-        (void) ThrowWizardException(exception,GetWizardModule(),KeyringError,
-          "corrupt key ring file `%s'",GetFilePath(file_info));
-        return(WizardFalse);
-      }
-    status&=ReadFile32Bits(file_info,&length);
-    status&=ReadFile16Bits(file_info,&keyring_info.protocol_major);
-    status&=ReadFile16Bits(file_info,&keyring_info.protocol_minor);
-    if ((keyring_info.protocol_major == 1) &&
-        (keyring_info.protocol_minor == 0))
-      timestamp=(time_t) length;
-    else
-      status&=ReadFile64Bits(file_info,&timestamp);
-    keyring_info.timestamp=(time_t) timestamp;
-    status&=ReadFile32Bits(file_info,&length);
-    if (status == WizardFalse)
-      {
-        file_info=DestroyFileInfo(file_info,exception);
-        (void) ThrowWizardException(exception,GetWizardModule(),KeyringError,
-          "corrupt key ring file `%s'",GetFilePath(file_info));
-        return(WizardFalse);
-      }
-    id=AcquireStringInfo(length);
-    status&=ReadFileChunk(file_info,GetStringInfoDatum(id),
-      GetStringInfoLength(id));
-    status&=ReadFile32Bits(file_info,&length);
-    if (status == WizardFalse)
-      {
-        file_info=DestroyFileInfo(file_info,exception);
-        (void) ThrowWizardException(exception,GetWizardModule(),KeyringError,
-          "corrupt key ring file `%s'",GetFilePath(file_info));
-        return(WizardFalse);
-      }
-    key=AcquireStringInfo(length);
-    status&=ReadFileChunk(file_info,GetStringInfoDatum(key),
-      GetStringInfoLength(key));
-    status&=ReadFile32Bits(file_info,&length);
-    if (status == WizardFalse)
-      {
-        file_info=DestroyFileInfo(file_info,exception);
-        (void) ThrowWizardException(exception,GetWizardModule(),KeyringError,
-          "corrupt key ring file `%s'",GetFilePath(file_info));
-        return(WizardFalse);
-      }
-    nonce=AcquireStringInfo(length);
-    status&=ReadFileChunk(file_info,GetStringInfoDatum(nonce),
-      GetStringInfoLength(nonce));
     keyring_rdf=AcquireString("  <keyring:Key rdf:about=\"");
-    hex=StringInfoToHexString(id);
+    hex=StringInfoToHexString(keyring_info[i]->id);
     (void) ConcatenateString(&keyring_rdf,hex);
     hex=DestroyString(hex);
     (void) ConcatenateString(&keyring_rdf,"\">\n");
@@ -690,17 +2194,19 @@ WizardExport WizardBooleanType PrintKeyringProperties(const char *path,
     (void) ConcatenateString(&keyring_rdf,canonical_path);
     (void) ConcatenateString(&keyring_rdf,"\"/>\n");
     (void) ConcatenateString(&keyring_rdf,"    <keyring:nonce>");
-    hex=StringInfoToHexString(nonce);
+    hex=StringInfoToHexString(keyring_info[i]->nonce);
     (void) ConcatenateString(&keyring_rdf,hex);
     hex=DestroyString(hex);
     (void) ConcatenateString(&keyring_rdf,"</keyring:nonce>\n");
     (void) ConcatenateString(&keyring_rdf,"    <keyring:timestamp>");
-    (void) FormatWizardTime(keyring_info.timestamp,WizardPathExtent,message);
+    (void) FormatWizardTime(keyring_info[i]->timestamp,WizardPathExtent,
+      message);
     (void) ConcatenateString(&keyring_rdf,message);
     (void) ConcatenateString(&keyring_rdf,"</keyring:timestamp>\n");
     (void) ConcatenateString(&keyring_rdf,"    <keyring:protocol>");
     (void) FormatLocaleString(message,WizardPathExtent,"%u.%u",
-      keyring_info.protocol_major,(unsigned int) keyring_info.protocol_minor);
+      keyring_info[i]->protocol_major,(unsigned int)
+      keyring_info[i]->protocol_minor);
     (void) ConcatenateString(&keyring_rdf,message);
     (void) ConcatenateString(&keyring_rdf,"</keyring:protocol>\n");
     (void) ConcatenateString(&keyring_rdf,"  </keyring:Key>\n");
@@ -709,22 +2215,50 @@ WizardExport WizardBooleanType PrintKeyringProperties(const char *path,
     keyring_rdf=DestroyString(keyring_rdf);
     if (count != (ssize_t) length)
       ThrowFileException(exception,FileError,GetFilePath(file_info));
-    nonce=DestroyStringInfo(nonce);
-    key=DestroyStringInfo(key);
-    id=DestroyStringInfo(id);
-    if (status == WizardFalse)
-      {
-        file_info=DestroyFileInfo(file_info,exception);
-        (void) ThrowWizardException(exception,GetWizardModule(),KeyringError,
-          "corrupt key ring file `%s'",GetFilePath(file_info));
-        return(WizardFalse);
-      }
+    keyring_info[i]=DestroyKeyringInfo(keyring_info[i]);
   }
+  keyring_info=(KeyringInfo **) RelinquishWizardMemory(keyring_info);
   canonical_path=DestroyString(canonical_path);
   file_info=DestroyFileInfo(file_info,exception);
   return(WizardTrue);
 }
-
+
+/*
+%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%
+%                                                                             %
+%                                                                             %
+%                                                                             %
+%   S e t K e y r i n g C a c h e                                             %
+%                                                                             %
+%                                                                             %
+%                                                                             %
+%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%
+%
+%  SetKeyringCache() enables or disables the process-wide keyring cache used
+%  by ExportKeyringKey().  The cache holds every key of each keyring in memory,
+%  so it suits long-running services that look up many keys, not commands
+%  that look up one.  Disabling the cache releases it.
+%
+%  The format of the SetKeyringCache method is:
+%
+%      void SetKeyringCache(const WizardBooleanType cache)
+%
+%  A description of each parameter follows:
+%
+%    o cache: enable or disable the keyring cache.
+%
+*/
+WizardExport void SetKeyringCache(const WizardBooleanType cache)
+{
+  if (keyring_semaphore == (SemaphoreInfo *) NULL)
+    ActivateSemaphoreInfo(&keyring_semaphore);
+  LockSemaphoreInfo(keyring_semaphore);
+  keyring_caching=cache;
+  if ((cache == WizardFalse) && (keyring_caches != (HashmapInfo *) NULL))
+    keyring_caches=DestroyHashmap(keyring_caches);
+  UnlockSemaphoreInfo(keyring_semaphore);
+}
+
 /*
 %%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%
 %                                                                             %
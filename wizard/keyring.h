@@ -35,17 +35,24 @@ extern WizardExport const StringInfo
 
 extern WizardExport KeyringInfo
   *AcquireKeyringInfo(const char *),
-  *DestroyKeyringInfo(KeyringInfo *);
+  *DestroyKeyringInfo(KeyringInfo *),
+  **ExportKeyringKeys(const char *,size_t *,ExceptionInfo *);
 
 extern WizardExport void
+  KeyringComponentTerminus(void),
+  SetKeyringCache(const WizardBooleanType),
   SetKeyringId(KeyringInfo *,const StringInfo *),
   SetKeyringKey(KeyringInfo *,const StringInfo *),
   SetKeyringNonce(KeyringInfo *,const StringInfo *),
   SetKeyringPath(KeyringInfo *,const char *);
 
 extern WizardExport WizardBooleanType
+  CompactKeyring(const char *,ExceptionInfo *),
+  DeleteKeyringKey(KeyringInfo *,ExceptionInfo *),
   ExportKeyringKey(KeyringInfo *,ExceptionInfo *),
   ImportKeyringKey(KeyringInfo *,ExceptionInfo *),
+  ImportKeyringKeys(const char *,KeyringInfo **,const size_t,ExceptionInfo *),
+  KeyringComponentGenesis(void),
   PrintKeyringProperties(const char *,BlobInfo *,ExceptionInfo *);
 
 #if defined(__cplusplus) || defined(c_plusplus)
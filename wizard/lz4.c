@@ -0,0 +1,343 @@
+/*
+%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%
+%                                                                             %
+%                                                                             %
+%                             L      ZZZZZ  4   4                             %
+%                             L         ZZ  4   4                             %
+%                             L       ZZZ   44444                             %
+%                             L      ZZ         4                             %
+%                             LLLLL  ZZZZZ      4                             %
+%                                                                             %
+%                                                                             %
+%                     Wizard's Toolkit LZ4 Entropy Methods                    %
+%                                                                             %
+%                             Software Design                                 %
+%                                 Cristy                                      %
+%                              October 2026                                   %
+%                                                                             %
+%                                                                             %
+%  Copyright 1999-2020 ImageMagick Studio LLC, a non-profit organization      %
+%  dedicated to making software imaging solutions freely available.           %
+%                                                                             %
+%  You may not use this file except in compliance with the License.  You may  %
+%  obtain a copy of the License at                                            %
+%                                                                             %
+%    https://imagemagick.org/script/license.php                               %
+%                                                                             %
+%  Unless required by applicable law or agreed to in writing, software        %
+%  distributed under the License is distributed on an "AS IS" BASIS,          %
+%  WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.   %
+%  See the License for the specific language governing permissions and        %
+%  limitations under the License.                                             %
+%                                                                             %
+%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%
+%
+%  An LZ4 block does not record its own extent, so the chaos is prefixed with
+%  the compressed length as a 4-byte MSB-first word.  This permits the
+%  compressed message to be followed by padding.
+%
+*/
+
+/*
+  Include declarations.
+*/
+#include "wizard/studio.h"
+#include "wizard/exception.h"
+#include "wizard/exception-private.h"
+#include "wizard/memory_.h"
+#include "wizard/lz4.h"
+#if defined(WIZARDSTOOLKIT_LZ4_DELEGATE)
+#include <lz4.h>
+#include <lz4hc.h>
+#endif
+
+/*
+  Define declarations.
+*/
+#define LZ4Extent  4
+
+/*
+  Typedef declarations.
+*/
+struct _LZ4Info
+{
+  StringInfo
+    *chaos;
+
+  size_t
+    level;
+
+  ssize_t
+    timestamp;
+
+  size_t
+    signature;
+};
+
+/*
+%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%
+%                                                                             %
+%                                                                             %
+%                                                                             %
+%   A c q u i r e L Z 4 I n f o                                               %
+%                                                                             %
+%                                                                             %
+%                                                                             %
+%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%
+%
+%  AcquireLZ4Info() allocates the LZ4Info structure.
+%
+%  The format of the AcquireLZ4Info method is:
+%
+%      LZ4Info *AcquireLZ4Info(const size_t level)
+%
+%  A description of each parameter follows:
+%
+%    o level: entropy level: 1 is best speed, 9 is more entropy.  Levels
+%      below 3 use the fast LZ4 compressor, higher levels use LZ4 HC.
+%
+*/
+WizardExport LZ4Info *AcquireLZ4Info(const size_t level)
+{
+  LZ4Info
+    *lz4_info;
+
+  lz4_info=(LZ4Info *) AcquireWizardMemory(sizeof(*lz4_info));
+  if (lz4_info == (LZ4Info *) NULL)
+    ThrowWizardFatalError(EntropyError,MemoryError);
+  (void) ResetWizardMemory(lz4_info,0,sizeof(*lz4_info));
+  lz4_info->chaos=AcquireStringInfo(1);
+  lz4_info->level=level;
+  lz4_info->timestamp=(ssize_t) (time((time_t *) NULL)-WizardEpoch);
+  lz4_info->signature=WizardSignature;
+  return(lz4_info);
+}
+
+/*
+%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%
+%                                                                             %
+%                                                                             %
+%                                                                             %
+%   D e s t r o y L Z 4 I n f o                                               %
+%                                                                             %
+%                                                                             %
+%                                                                             %
+%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%
+%
+%  DestroyLZ4Info() zeros memory associated with the LZ4Info structure.
+%
+%  The format of the DestroyLZ4Info method is:
+%
+%      LZ4Info *DestroyLZ4Info(LZ4Info *lz4_info)
+%
+%  A description of each parameter follows:
+%
+%    o lz4_info: The lz4 info.
+%
+*/
+WizardExport LZ4Info *DestroyLZ4Info(LZ4Info *lz4_info)
+{
+  (void) LogWizardEvent(TraceEvent,GetWizardModule(),"...");
+  WizardAssert(EntropyDomain,lz4_info != (LZ4Info *) NULL);
+  WizardAssert(EntropyDomain,lz4_info->signature == WizardSignature);
+  if (lz4_info->chaos != (StringInfo *) NULL)
+    lz4_info->chaos=DestroyStringInfo(lz4_info->chaos);
+  lz4_info->signature=(~WizardSignature);
+  lz4_info=(LZ4Info *) RelinquishWizardMemory(lz4_info);
+  return(lz4_info);
+}
+
+/*
+%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%
+%                                                                             %
+%                                                                             %
+%                                                                             %
+%   G e t L Z 4 C h a o s                                                     %
+%                                                                             %
+%                                                                             %
+%                                                                             %
+%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%
+%
+%  GetLZ4Chaos() returns LZ4 chaos.
+%
+%  The format of the GetLZ4Chaos method is:
+%
+%      const StringInfo *GetLZ4Chaos(const LZ4Info *lz4_info)
+%
+%  A description of each parameter follows:
+%
+%    o lz4_info: The lz4 info.
+%
+*/
+WizardExport const StringInfo *GetLZ4Chaos(const LZ4Info *lz4_info)
+{
+  (void) LogWizardEvent(TraceEvent,GetWizardModule(),"...");
+  WizardAssert(EntropyDomain,lz4_info != (LZ4Info *) NULL);
+  WizardAssert(EntropyDomain,lz4_info->signature == WizardSignature);
+  return(lz4_info->chaos);
+}
+
+/*
+%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%
+%                                                                             %
+%                                                                             %
+%                                                                             %
+%   I n c r e a s e L Z 4                                                     %
+%                                                                             %
+%                                                                             %
+%                                                                             %
+%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%
+%
+%  IncreaseLZ4() compresses the message to increase its entropy.
+%
+%  The format of the IncreaseLZ4 method is:
+%
+%      WizardBooleanType IncreaseLZ4(LZ4Info *lz4_info,
+%        const StringInfo *message,ExceptionInfo *exception)
+%
+%  A description of each parameter follows:
+%
+%    o lz4_info: The address of a structure of type LZ4Info.
+%
+%    o message: The message.
+%
+%    o exception: Return any errors or warnings in this structure.
+%
+*/
+WizardExport WizardBooleanType IncreaseLZ4(LZ4Info *lz4_info,
+  const StringInfo *message,ExceptionInfo *exception)
+{
+#if defined(WIZARDSTOOLKIT_LZ4_DELEGATE)
+  int
+    extent,
+    status;
+
+  unsigned char
+    *p;
+
+  /*
+    Increase the message entropy.
+  */
+  (void) LogWizardEvent(TraceEvent,GetWizardModule(),"...");
+  WizardAssert(EntropyDomain,lz4_info != (LZ4Info *) NULL);
+  WizardAssert(EntropyDomain,lz4_info->signature == WizardSignature);
+  WizardAssert(EntropyDomain,message != (const StringInfo *) NULL);
+  extent=LZ4_compressBound((int) GetStringInfoLength(message));
+  if ((extent <= 0) && (GetStringInfoLength(message) != 0))
+    {
+      (void) ThrowWizardException(exception,GetWizardModule(),EntropyError,
+        "unable to increase entropy `%s'","message too large");
+      return(WizardFalse);
+    }
+  SetStringInfoLength(lz4_info->chaos,(size_t) extent+LZ4Extent);
+  p=GetStringInfoDatum(lz4_info->chaos);
+  if (lz4_info->level < LZ4HC_CLEVEL_MIN)
+    status=LZ4_compress_default((const char *) GetStringInfoDatum(message),
+      (char *) p+LZ4Extent,(int) GetStringInfoLength(message),extent);
+  else
+    status=LZ4_compress_HC((const char *) GetStringInfoDatum(message),
+      (char *) p+LZ4Extent,(int) GetStringInfoLength(message),extent,(int)
+      lz4_info->level);
+  if ((status <= 0) && (GetStringInfoLength(message) != 0))
+    {
+      (void) ThrowWizardException(exception,GetWizardModule(),EntropyError,
+        "unable to increase entropy `%s'",strerror(errno));
+      return(WizardFalse);
+    }
+  *p++=(unsigned char) ((unsigned int) status >> 24);
+  *p++=(unsigned char) ((unsigned int) status >> 16);
+  *p++=(unsigned char) ((unsigned int) status >> 8);
+  *p++=(unsigned char) status;
+  SetStringInfoLength(lz4_info->chaos,(size_t) status+LZ4Extent);
+  return(WizardTrue);
+#else
+  (void) ThrowWizardException(exception,GetWizardModule(),EntropyError,
+    "unable to increase entropy `%s'","LZ4 delegate support not builtin");
+  return(WizardFalse);
+#endif
+}
+
+/*
+%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%
+%                                                                             %
+%                                                                             %
+%                                                                             %
+%   R e s t o r e L Z 4                                                       %
+%                                                                             %
+%                                                                             %
+%                                                                             %
+%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%
+%
+%  RestoreLZ4() uncompresses the message to restore its original entropy.
+%
+%  The format of the RestoreLZ4 method is:
+%
+%      WizardBooleanType RestoreLZ4(LZ4Info *lz4_info,const size_t length,
+%        const StringInfo *message,ExceptionInfo *exception)
+%
+%  A description of each parameter follows:
+%
+%    o lz4_info: The address of a structure of type LZ4Info.
+%
+%    o length: The total size of the destination buffer, which must be large
+%      enough to hold the entire uncompressed data.
+%
+%    o message: The message.
+%
+%    o exception: Return any errors or warnings in this structure.
+%
+*/
+WizardExport WizardBooleanType RestoreLZ4(LZ4Info *lz4_info,
+  const size_t length,const StringInfo *message,ExceptionInfo *exception)
+{
+#if defined(WIZARDSTOOLKIT_LZ4_DELEGATE)
+  int
+    status;
+
+  size_t
+    extent;
+
+  unsigned char
+    *p;
+
+  /*
+    Restore the message entropy.
+  */
+  WizardAssert(EntropyDomain,lz4_info != (LZ4Info *) NULL);
+  (void) LogWizardEvent(TraceEvent,GetWizardModule(),"...");
+  WizardAssert(EntropyDomain,lz4_info->signature == WizardSignature);
+  WizardAssert(EntropyDomain,message != (const StringInfo *) NULL);
+  if (GetStringInfoLength(message) < LZ4Extent)
+    {
+      (void) ThrowWizardException(exception,GetWizardModule(),EntropyError,
+        "unable to restore entropy `%s'","truncated message");
+      return(WizardFalse);
+    }
+  p=GetStringInfoDatum(message);
+  extent=(size_t) p[0] << 24;
+  extent|=(size_t) p[1] << 16;
+  extent|=(size_t) p[2] << 8;
+  extent|=(size_t) p[3];
+  if (extent > (GetStringInfoLength(message)-LZ4Extent))
+    {
+      (void) ThrowWizardException(exception,GetWizardModule(),EntropyError,
+        "unable to restore entropy `%s'","corrupt message");
+      return(WizardFalse);
+    }
+  SetStringInfoLength(lz4_info->chaos,length);
+  status=LZ4_decompress_safe((const char *) p+LZ4Extent,(char *)
+    GetStringInfoDatum(lz4_info->chaos),(int) extent,(int) length);
+  if (status < 0)
+    {
+      (void) ThrowWizardException(exception,GetWizardModule(),EntropyError,
+        "unable to restore entropy `%s'","corrupt message");
+      return(WizardFalse);
+    }
+  SetStringInfoLength(lz4_info->chaos,(size_t) status);
+  return(WizardTrue);
+#else
+  (void) ThrowWizardException(exception,GetWizardModule(),EntropyError,
+    "unable to restore entropy `%s'","LZ4 delegate support not builtin");
+  return(WizardFalse);
+#endif
+}
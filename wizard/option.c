@@ -40,6 +40,7 @@
 */
 #include "wizard/studio.h"
 #include "wizard/authenticate.h"
+#include "wizard/blob.h"
 #include "wizard/cipher.h"
 #include "wizard/entropy.h"
 #include "wizard/exception-private.h"
@@ -74,42 +75,48 @@ static const OptionInfo
   },
   CommandOptions[] =
   {
-    { "+authenticate", 1L },
-    { "-authenticate", 1L },
+    { "+authenticate", 0L },
+    { "-authenticate", 0L },
     { "+chunksize", 1L },
     { "-chunksize", 1L },
     { "+decipher", 0L },
     { "-decipher", 0L },
     { "+debug", 1L },
     { "-debug", 1L },
-    { "+entropy", 1L },
+    { "+entropy", 0L },
     { "-entropy", 1L },
-    { "+hash", 1L },
+    { "+exclude", 0L },
+    { "-exclude", 1L },
+    { "+hash", 0L },
     { "-hash", 1L },
     { "+help", 0L },
     { "-help", 0L },
-    { "+key", 1L },
+    { "+include", 0L },
+    { "-include", 1L },
+    { "+key", 0L },
     { "-key", 1L },
-    { "+key-length", 1L },
+    { "+key-length", 0L },
     { "-key-length", 1L },
     { "+mac", 1L },
     { "-mac", 1L },
     { "+level", 1L },
     { "-level", 1L },
-    { "+list", 1L },
+    { "+list", 0L },
     { "-list", 1L },
-    { "+log", 1L },
+    { "+log", 0L },
     { "-log", 1L },
-    { "+mode", 1L },
+    { "+mode", 0L },
     { "-mode", 1L },
-    { "+properties", 1L },
+    { "+properties", 0L },
     { "-properties", 1L },
     { "+random", 1L },
     { "-random", 1L },
+    { "+sync", 0L },
+    { "-sync", 1L },
     { "+verbose", 0L },
     { "-verbose", 0L },
-    { "+version", 1L },
-    { "-version", 1L },
+    { "+version", 0L },
+    { "-version", 0L },
     { (char *) NULL, 0L }
   },
   DataTypeOptions[] =
@@ -147,8 +154,10 @@ static const OptionInfo
     { "Undefined", (ssize_t) UndefinedEntropy },
     { "None", (ssize_t) NoEntropy },
     { "BZip", (ssize_t) BZIPEntropy },
+    { "LZ4", (ssize_t) LZ4Entropy },
     { "LZMA", (ssize_t) LZMAEntropy },
     { "Zip", (ssize_t) ZIPEntropy },
+    { "Zstd", (ssize_t) ZSTDEntropy },
     { (char *) NULL, UndefinedEntropy }
   },
   KeyLengthOptions[] =
@@ -196,6 +205,7 @@ static const OptionInfo
     { "KeyLength", (ssize_t) WizardKeyLengthOptions },
     { "List", (ssize_t) WizardListOptions },
     { "Mode", (ssize_t) WizardModeOptions },
+    { "Sync", (ssize_t) WizardSyncOptions },
     { (char *) NULL, (ssize_t) WizardUndefinedOptions }
   },
   LogWizardEventOptions[] =
@@ -232,6 +242,14 @@ static const OptionInfo
     { "Map", (ssize_t) MapResource },
     { "Memory", (ssize_t) MemoryResource },
     { (char *) NULL, (ssize_t) UndefinedResource }
+  },
+  SyncOptions[] =
+  {
+    { "Undefined", (ssize_t) UndefinedSync },
+    { "Chunk", (ssize_t) ChunkSync },
+    { "End", (ssize_t) EndSync },
+    { "Never", (ssize_t) NoSync },
+    { (char *) NULL, (ssize_t) UndefinedSync }
   };
 
 /*
@@ -275,6 +293,7 @@ static const OptionInfo *GetOptionInfo(const WizardOption option)
     case WizardLogEventOptions: return(LogWizardEventOptions);
     case WizardModeOptions: return(ModeOptions);
     case WizardResourceOptions: return(ResourceOptions);
+    case WizardSyncOptions: return(SyncOptions);
     default: break;
   }
   return((const OptionInfo *) NULL);
@@ -402,7 +421,8 @@ WizardExport WizardBooleanType ListWizardOptions(FILE *file,
 %%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%
 %
 %  ParseWizardOption() parses an option string and returns an enumerated option
-%  type(s).
+%  type(s).  A leading - or + is ignored, except for the command options
+%  whose table lists both forms.
 %
 %  The format of the ParseWizardOption method is:
 %
@@ -452,7 +472,7 @@ WizardExport ssize_t ParseWizardOption(const WizardOption option,
     while (((isspace((int) ((unsigned char) *p)) != 0) || (*p == ',')) &&
            (*p != '\0'))
       p++;
-    if ((*p == '-') || (*p == '+'))
+    if (((*p == '-') || (*p == '+')) && (option != WizardCommandOptions))
       p++;
     negate=(*p == '!') ? WizardTrue : WizardFalse;
     if (negate != WizardFalse)
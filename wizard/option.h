@@ -50,7 +50,8 @@ typedef enum
   WizardListOptions,
   WizardModeOptions,
   WizardLogEventOptions,
-  WizardResourceOptions
+  WizardResourceOptions,
+  WizardSyncOptions
 } WizardOption;
 
 extern WizardExport char
@@ -894,7 +894,7 @@ WizardExport WizardBooleanType ResourceComponentGenesis(void)
     pages,
     pagesize;
 
-  size_t
+  WizardSizeType
     memory;
 
   /*
@@ -912,9 +912,9 @@ WizardExport WizardBooleanType ResourceComponentGenesis(void)
 #if defined(WIZARDSTOOLKIT_HAVE_SYSCONF) && defined(_SC_PHYS_PAGES)
   pages=sysconf(_SC_PHYS_PAGES);
 #endif
-  memory=(size_t) ((pages+512)/1024)*((pagesize+512)/1024);
+  memory=(WizardSizeType) pages*pagesize;
   if ((pagesize <= 0) || (pages <= 0))
-    memory=2048UL;
+    memory=WizardULLConstant(2048)*1024*1024;
 #if defined(PixelCacheThreshold)
   memory=PixelCacheThreshold;
 #endif
@@ -129,6 +129,11 @@
 #define WIZARDSTOOLKIT_HAVE_FCHMOD 1
 #endif
 
+/* Define to 1 if you have the `fdatasync' function. */
+#ifndef WIZARDSTOOLKIT_HAVE_FDATASYNC
+#define WIZARDSTOOLKIT_HAVE_FDATASYNC 1
+#endif
+
 /* Define to 1 if you have the <fcntl.h> header file. */
 #ifndef WIZARDSTOOLKIT_HAVE_FCNTL_H
 #define WIZARDSTOOLKIT_HAVE_FCNTL_H 1
@@ -142,6 +147,11 @@
 #define WIZARDSTOOLKIT_HAVE_FSEEKO 1
 #endif
 
+/* Define to 1 if you have the `fsync' function. */
+#ifndef WIZARDSTOOLKIT_HAVE_FSYNC
+#define WIZARDSTOOLKIT_HAVE_FSYNC 1
+#endif
+
 /* Define to 1 if you have the `ftime' function. */
 #ifndef WIZARDSTOOLKIT_HAVE_FTIME
 #define WIZARDSTOOLKIT_HAVE_FTIME 1
@@ -750,6 +760,9 @@
 #define WIZARDSTOOLKIT_LT_OBJDIR ".libs/"
 #endif
 
+/* Define if you have LZ4 library */
+/* #undef LZ4_DELEGATE */
+
 /* Define if you have LZMA library */
 #ifndef WIZARDSTOOLKIT_LZMA_DELEGATE
 #define WIZARDSTOOLKIT_LZMA_DELEGATE 1
@@ -962,6 +975,9 @@
 #define WIZARDSTOOLKIT_ZLIB_DELEGATE 1
 #endif
 
+/* Define if you have ZSTD library */
+/* #undef ZSTD_DELEGATE */
+
 /* Enable large inode numbers on Mac OS X 10.5.  */
 #ifndef _DARWIN_USE_64_BIT_INODE
 # define _DARWIN_USE_64_BIT_INODE 1
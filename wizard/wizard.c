@@ -42,6 +42,7 @@
 #include "wizard/client.h"
 #include "wizard/configure.h"
 #include "wizard/hash.h"
+#include "wizard/keyring.h"
 #include "wizard/log.h"
 #include "wizard/magick.h"
 #include "wizard/memory_.h"
@@ -226,6 +227,8 @@ WizardExport void WizardsToolkitGenesis(const char *path)
   (void) SemaphoreComponentGenesis();
   (void) LogComponentGenesis();
   (void) RandomComponentGenesis();
+  (void) HashmapComponentGenesis();
+  (void) KeyringComponentGenesis();
   events=GetEnvironmentValue("WIZARD_DEBUG");
   if (events != (char *) NULL)
     {
@@ -342,6 +345,7 @@ WizardExport void WizardsToolkitTerminus(void)
     }
   MimeComponentTerminus();
   ResourceComponentTerminus();
+  KeyringComponentTerminus();
   RandomComponentTerminus();
   LogComponentTerminus();
   instantiate_wizardstoolkit=WizardFalse;
@@ -0,0 +1,340 @@
+/*
+%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%
+%                                                                             %
+%                                                                             %
+%                          ZZZZZ  SSSSS  TTTTT  DDDD                          %
+%                             ZZ  SS       T    D   D                         %
+%                            ZZZ   SSS     T    D   D                         %
+%                           ZZ       SS    T    D   D                         %
+%                          ZZZZZ  SSSSS    T    DDDD                          %
+%                                                                             %
+%                                                                             %
+%                  Wizard's Toolkit Zstandard Entropy Methods                 %
+%                                                                             %
+%                             Software Design                                 %
+%                                 Cristy                                      %
+%                              October 2026                                   %
+%                                                                             %
+%                                                                             %
+%  Copyright 1999-2020 ImageMagick Studio LLC, a non-profit organization      %
+%  dedicated to making software imaging solutions freely available.           %
+%                                                                             %
+%  You may not use this file except in compliance with the License.  You may  %
+%  obtain a copy of the License at                                            %
+%                                                                             %
+%    https://imagemagick.org/script/license.php                               %
+%                                                                             %
+%  Unless required by applicable law or agreed to in writing, software        %
+%  distributed under the License is distributed on an "AS IS" BASIS,          %
+%  WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.   %
+%  See the License for the specific language governing permissions and        %
+%  limitations under the License.                                             %
+%                                                                             %
+%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%
+%
+%
+*/
+
+/*
+  Include declarations.
+*/
+#include "wizard/studio.h"
+#include "wizard/exception.h"
+#include "wizard/exception-private.h"
+#include "wizard/memory_.h"
+#include "wizard/zstd.h"
+#if defined(WIZARDSTOOLKIT_ZSTD_DELEGATE)
+#include <zstd.h>
+#endif
+
+/*
+  Typedef declarations.
+*/
+struct _ZSTDInfo
+{
+#if defined(WIZARDSTOOLKIT_ZSTD_DELEGATE)
+  ZSTD_CCtx
+    *compress;
+
+  ZSTD_DCtx
+    *decompress;
+#endif
+
+  StringInfo
+    *chaos;
+
+  size_t
+    level;
+
+  ssize_t
+    timestamp;
+
+  size_t
+    signature;
+};
+
+/*
+%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%
+%                                                                             %
+%                                                                             %
+%                                                                             %
+%   A c q u i r e Z S T D I n f o                                             %
+%                                                                             %
+%                                                                             %
+%                                                                             %
+%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%
+%
+%  AcquireZSTDInfo() allocates the ZSTDInfo structure.
+%
+%  The format of the AcquireZSTDInfo method is:
+%
+%      ZSTDInfo *AcquireZSTDInfo(const size_t level)
+%
+%  A description of each parameter follows:
+%
+%    o level: entropy level: 1 is best speed, 9 is more entropy.  The level
+%      maps directly to the Zstandard compression level; 0 selects the
+%      Zstandard default (currently 3).
+%
+*/
+WizardExport ZSTDInfo *AcquireZSTDInfo(const size_t level)
+{
+  ZSTDInfo
+    *zstd_info;
+
+  zstd_info=(ZSTDInfo *) AcquireWizardMemory(sizeof(*zstd_info));
+  if (zstd_info == (ZSTDInfo *) NULL)
+    ThrowWizardFatalError(EntropyError,MemoryError);
+  (void) ResetWizardMemory(zstd_info,0,sizeof(*zstd_info));
+  zstd_info->chaos=AcquireStringInfo(1);
+  zstd_info->level=level;
+  zstd_info->timestamp=(ssize_t) (time((time_t *) NULL)-WizardEpoch);
+  zstd_info->signature=WizardSignature;
+  return(zstd_info);
+}
+
+/*
+%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%
+%                                                                             %
+%                                                                             %
+%                                                                             %
+%   D e s t r o y Z S T D I n f o                                             %
+%                                                                             %
+%                                                                             %
+%                                                                             %
+%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%
+%
+%  DestroyZSTDInfo() zeros memory associated with the ZSTDInfo structure.
+%
+%  The format of the DestroyZSTDInfo method is:
+%
+%      ZSTDInfo *DestroyZSTDInfo(ZSTDInfo *zstd_info)
+%
+%  A description of each parameter follows:
+%
+%    o zstd_info: The zstd info.
+%
+*/
+WizardExport ZSTDInfo *DestroyZSTDInfo(ZSTDInfo *zstd_info)
+{
+  (void) LogWizardEvent(TraceEvent,GetWizardModule(),"...");
+  WizardAssert(EntropyDomain,zstd_info != (ZSTDInfo *) NULL);
+  WizardAssert(EntropyDomain,zstd_info->signature == WizardSignature);
+#if defined(WIZARDSTOOLKIT_ZSTD_DELEGATE)
+  if (zstd_info->compress != (ZSTD_CCtx *) NULL)
+    (void) ZSTD_freeCCtx(zstd_info->compress);
+  if (zstd_info->decompress != (ZSTD_DCtx *) NULL)
+    (void) ZSTD_freeDCtx(zstd_info->decompress);
+#endif
+  if (zstd_info->chaos != (StringInfo *) NULL)
+    zstd_info->chaos=DestroyStringInfo(zstd_info->chaos);
+  zstd_info->signature=(~WizardSignature);
+  zstd_info=(ZSTDInfo *) RelinquishWizardMemory(zstd_info);
+  return(zstd_info);
+}
+
+/*
+%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%
+%                                                                             %
+%                                                                             %
+%                                                                             %
+%   G e t Z S T D C h a o s                                                   %
+%                                                                             %
+%                                                                             %
+%                                                                             %
+%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%
+%
+%  GetZSTDChaos() returns Zstandard chaos.
+%
+%  The format of the GetZSTDChaos method is:
+%
+%      const StringInfo *GetZSTDChaos(const ZSTDInfo *zstd_info)
+%
+%  A description of each parameter follows:
+%
+%    o zstd_info: The zstd info.
+%
+*/
+WizardExport const StringInfo *GetZSTDChaos(const ZSTDInfo *zstd_info)
+{
+  (void) LogWizardEvent(TraceEvent,GetWizardModule(),"...");
+  WizardAssert(EntropyDomain,zstd_info != (ZSTDInfo *) NULL);
+  WizardAssert(EntropyDomain,zstd_info->signature == WizardSignature);
+  return(zstd_info->chaos);
+}
+
+/*
+%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%
+%                                                                             %
+%                                                                             %
+%                                                                             %
+%   I n c r e a s e Z S T D                                                   %
+%                                                                             %
+%                                                                             %
+%                                                                             %
+%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%
+%
+%  IncreaseZSTD() compresses the message to increase its entropy.
+%
+%  The format of the IncreaseZSTD method is:
+%
+%      WizardBooleanType IncreaseZSTD(ZSTDInfo *zstd_info,
+%        const StringInfo *message,ExceptionInfo *exception)
+%
+%  A description of each parameter follows:
+%
+%    o zstd_info: The address of a structure of type ZSTDInfo.
+%
+%    o message: The message.
+%
+%    o exception: Return any errors or warnings in this structure.
+%
+*/
+WizardExport WizardBooleanType IncreaseZSTD(ZSTDInfo *zstd_info,
+  const StringInfo *message,ExceptionInfo *exception)
+{
+#if defined(WIZARDSTOOLKIT_ZSTD_DELEGATE)
+  size_t
+    status;
+
+  /*
+    Increase the message entropy.
+  */
+  (void) LogWizardEvent(TraceEvent,GetWizardModule(),"...");
+  WizardAssert(EntropyDomain,zstd_info != (ZSTDInfo *) NULL);
+  WizardAssert(EntropyDomain,zstd_info->signature == WizardSignature);
+  WizardAssert(EntropyDomain,message != (const StringInfo *) NULL);
+  if (zstd_info->compress == (ZSTD_CCtx *) NULL)
+    {
+      zstd_info->compress=ZSTD_createCCtx();
+      if (zstd_info->compress == (ZSTD_CCtx *) NULL)
+        {
+          (void) ThrowWizardException(exception,GetWizardModule(),EntropyError,
+            "unable to increase entropy `%s'",strerror(errno));
+          return(WizardFalse);
+        }
+    }
+  SetStringInfoLength(zstd_info->chaos,ZSTD_compressBound(
+    GetStringInfoLength(message)));
+  status=ZSTD_compressCCtx(zstd_info->compress,GetStringInfoDatum(
+    zstd_info->chaos),GetStringInfoLength(zstd_info->chaos),
+    GetStringInfoDatum(message),GetStringInfoLength(message),(int)
+    zstd_info->level);
+  if (ZSTD_isError(status) != 0)
+    {
+      (void) ThrowWizardException(exception,GetWizardModule(),EntropyError,
+        "unable to increase entropy `%s'",ZSTD_getErrorName(status));
+      return(WizardFalse);
+    }
+  SetStringInfoLength(zstd_info->chaos,status);
+  return(WizardTrue);
+#else
+  (void) ThrowWizardException(exception,GetWizardModule(),EntropyError,
+    "unable to increase entropy `%s'","ZSTD delegate support not builtin");
+  return(WizardFalse);
+#endif
+}
+
+/*
+%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%
+%                                                                             %
+%                                                                             %
+%                                                                             %
+%   R e s t o r e Z S T D                                                     %
+%                                                                             %
+%                                                                             %
+%                                                                             %
+%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%
+%
+%  RestoreZSTD() uncompresses the message to restore its original entropy.
+%  Any bytes that follow the Zstandard frame (e.g. random padding) are
+%  ignored.
+%
+%  The format of the RestoreZSTD method is:
+%
+%      WizardBooleanType RestoreZSTD(ZSTDInfo *zstd_info,const size_t length,
+%        const StringInfo *message,ExceptionInfo *exception)
+%
+%  A description of each parameter follows:
+%
+%    o zstd_info: The address of a structure of type ZSTDInfo.
+%
+%    o length: The total size of the destination buffer, which must be large
+%      enough to hold the entire uncompressed data.
+%
+%    o message: The message.
+%
+%    o exception: Return any errors or warnings in this structure.
+%
+*/
+WizardExport WizardBooleanType RestoreZSTD(ZSTDInfo *zstd_info,
+  const size_t length,const StringInfo *message,ExceptionInfo *exception)
+{
+#if defined(WIZARDSTOOLKIT_ZSTD_DELEGATE)
+  size_t
+    extent,
+    status;
+
+  /*
+    Restore the message entropy.
+  */
+  WizardAssert(EntropyDomain,zstd_info != (ZSTDInfo *) NULL);
+  (void) LogWizardEvent(TraceEvent,GetWizardModule(),"...");
+  WizardAssert(EntropyDomain,zstd_info->signature == WizardSignature);
+  WizardAssert(EntropyDomain,message != (const StringInfo *) NULL);
+  if (zstd_info->decompress == (ZSTD_DCtx *) NULL)
+    {
+      zstd_info->decompress=ZSTD_createDCtx();
+      if (zstd_info->decompress == (ZSTD_DCtx *) NULL)
+        {
+          (void) ThrowWizardException(exception,GetWizardModule(),EntropyError,
+            "unable to restore entropy `%s'",strerror(errno));
+          return(WizardFalse);
+        }
+    }
+  extent=ZSTD_findFrameCompressedSize(GetStringInfoDatum(message),
+    GetStringInfoLength(message));
+  if (ZSTD_isError(extent) != 0)
+    {
+      (void) ThrowWizardException(exception,GetWizardModule(),EntropyError,
+        "unable to restore entropy `%s'",ZSTD_getErrorName(extent));
+      return(WizardFalse);
+    }
+  SetStringInfoLength(zstd_info->chaos,length);
+  status=ZSTD_decompressDCtx(zstd_info->decompress,GetStringInfoDatum(
+    zstd_info->chaos),GetStringInfoLength(zstd_info->chaos),
+    GetStringInfoDatum(message),extent);
+  if (ZSTD_isError(status) != 0)
+    {
+      (void) ThrowWizardException(exception,GetWizardModule(),EntropyError,
+        "unable to restore entropy `%s'",ZSTD_getErrorName(status));
+      return(WizardFalse);
+    }
+  SetStringInfoLength(zstd_info->chaos,status);
+  return(WizardTrue);
+#else
+  (void) ThrowWizardException(exception,GetWizardModule(),EntropyError,
+    "unable to restore entropy `%s'","ZSTD delegate support not builtin");
+  return(WizardFalse);
+#endif
+}
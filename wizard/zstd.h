@@ -0,0 +1,43 @@
+/*
+  Copyright 1999-2020 ImageMagick Studio LLC, a non-profit organization
+  dedicated to making software imaging solutions freely available.
+
+  You may not use this file except in compliance with the License.
+  obtain a copy of the License at
+
+    https://imagemagick.org/script/license.php
+
+  Unless required by applicable law or agreed to in writing, software
+  distributed under the License is distributed on an "AS IS" BASIS,
+  WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+  See the License for the specific language governing permissions and
+  limitations under the License.
+
+  Wizard's Toolkit Zstandard entropy methods.
+*/
+#ifndef _WIZARDSTOOLKIT_ZSTD_H_
+#define _WIZARDSTOOLKIT_ZSTD_H_
+
+#if defined(__cplusplus) || defined(c_plusplus)
+extern "C" {
+#endif
+
+typedef struct _ZSTDInfo
+  ZSTDInfo;
+
+extern WizardExport const StringInfo
+  *GetZSTDChaos(const ZSTDInfo *);
+
+extern WizardExport WizardBooleanType
+  IncreaseZSTD(ZSTDInfo *,const StringInfo *,ExceptionInfo *),
+  RestoreZSTD(ZSTDInfo *,const size_t,const StringInfo *,ExceptionInfo *);
+
+extern WizardExport ZSTDInfo
+  *AcquireZSTDInfo(const size_t),
+  *DestroyZSTDInfo(ZSTDInfo *);
+
+#if defined(__cplusplus) || defined(c_plusplus)
+}
+#endif
+
+#endif